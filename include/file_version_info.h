@@ -93,14 +93,14 @@ namespace pe_bliss
 
 		//Returns file version string
 		template<typename T>
-		const std::basic_string<T> get_file_version_string() const
+		std::basic_string<T> get_file_version_string() const
 		{
 			return get_version_string<T>(file_version_ms_, file_version_ls_);
 		}
 
 		//Returns product version string
 		template<typename T>
-		const std::basic_string<T> get_product_version_string() const
+		std::basic_string<T> get_product_version_string() const
 		{
 			return get_version_string<T>(product_version_ms_, product_version_ls_);
 		}
@@ -151,7 +151,7 @@ namespace pe_bliss
 	private:
 		//Helper to convert version DWORDs to string
 		template<typename T>
-		static const std::basic_string<T> get_version_string(uint32_t ms, uint32_t ls)
+		static std::basic_string<T> get_version_string(uint32_t ms, uint32_t ls)
 		{
 			std::basic_stringstream<T> ss;
 			ss << (ms >> 16) << static_cast<T>(L'.')
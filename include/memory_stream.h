@@ -0,0 +1,37 @@
+#pragma once
+#include <istream>
+#include <streambuf>
+#include <string_view>
+
+namespace pe_bliss
+{
+	//Read-only stream buffer over existing memory block (data is not copied)
+	//Memory block must stay alive while buffer is used
+	class memory_streambuf : public std::streambuf
+	{
+	public:
+		//Constructor from data
+		memory_streambuf(const char* data, std::size_t size);
+
+	protected:
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override;
+		pos_type seekpos(pos_type pos, std::ios_base::openmode which = std::ios_base::in) override;
+
+	private:
+		memory_streambuf(const memory_streambuf&);
+		memory_streambuf& operator=(const memory_streambuf&);
+	};
+
+	//Read-only istream over existing memory block (data is not copied)
+	//Can be passed to pe_factory::create_pe to load image from memory
+	class memory_istream : public std::istream
+	{
+	public:
+		//Constructors from data
+		memory_istream(const char* data, std::size_t size);
+		explicit memory_istream(std::string_view data);
+
+	private:
+		memory_streambuf buf_;
+	};
+}
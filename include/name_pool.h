@@ -0,0 +1,118 @@
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "stdint_defs.h"
+
+namespace pe_bliss
+{
+	//Thread-safe pool of interned names (DLL, imported and exported function names)
+	//Each distinct name is stored once and gets 32-bit ID, so names from different images can be compared as integers
+	//Interned names are null-terminated and are not moved or freed until pool is destroyed
+	class name_pool
+	{
+	public:
+		//ID of name, which is not interned
+		static const uint32_t no_id = 0xFFFFFFFF;
+
+	public:
+		//Default constructor
+		name_pool();
+
+		//Interns name, returns view of pooled copy and sets its ID
+		std::string_view intern(std::string_view name, uint32_t& id);
+		//Interns name and returns its ID
+		uint32_t intern(std::string_view name);
+
+		//Returns ID of name or no_id, if name was not interned
+		uint32_t find(std::string_view name) const;
+		//Returns interned name by ID, throws an exception if ID is incorrect
+		std::string_view get_name(uint32_t id) const;
+
+		//Returns number of interned names
+		std::size_t size() const;
+		//Returns number of bytes allocated for names storage
+		std::size_t get_storage_size() const;
+
+	private:
+		//Pool is split to several independently locked shards to reduce contention
+		//Low bits of ID hold shard index, high bits - index of name inside shard
+		static const uint32_t shard_bits = 4;
+		static const uint32_t shard_count = 1 << shard_bits;
+		//Minimum and maximum size of names storage block
+		static const std::size_t min_block_size = 0x400;
+		static const std::size_t block_size = 0x10000;
+
+		struct shard
+		{
+			mutable std::shared_mutex lock;
+			std::unordered_map<std::string_view, uint32_t> ids;
+			std::vector<std::string_view> names;
+			std::vector<std::unique_ptr<char[]> > blocks;
+			char* block_pos;
+			std::size_t block_free;
+			std::size_t storage_size;
+
+			shard();
+		};
+
+		//Returns index of shard for name
+		static uint32_t get_shard_index(std::string_view name);
+
+		shard shards_[shard_count];
+
+		name_pool(const name_pool&);
+		name_pool& operator=(const name_pool&);
+	};
+
+	//Class representing name, which is either stored in memory resource of allocator
+	//or interned in name_pool (only view to pooled copy and its ID are held then)
+	//Name is always null-terminated
+	class pooled_name
+	{
+	public:
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+	public:
+		//Default constructor
+		pooled_name() noexcept;
+		//Constructor with allocator
+		explicit pooled_name(const allocator_type& allocator) noexcept;
+		//Copy constructors
+		pooled_name(const pooled_name& other);
+		pooled_name(const pooled_name& other, const allocator_type& allocator);
+		//Move constructors (name is copied, if it is not interned and allocators are not equal)
+		pooled_name(pooled_name&& other) noexcept;
+		pooled_name(pooled_name&& other, const allocator_type& allocator);
+		//Assignment operators
+		pooled_name& operator=(const pooled_name& other);
+		pooled_name& operator=(pooled_name&& other);
+		//Destructor
+		~pooled_name();
+
+		//Returns name
+		std::string_view get() const noexcept;
+		//Returns ID of name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_id() const noexcept;
+
+		//Sets name, its copy is stored in memory resource of allocator
+		void set(std::string_view name);
+		//Sets name interned in pool, nothing is allocated
+		void set(std::string_view name, name_pool& pool);
+
+	private:
+		//Stores copy of name
+		void assign(std::string_view name);
+		//Frees stored copy of name
+		void release() noexcept;
+
+	private:
+		allocator_type allocator_;
+		const char* data_;
+		uint32_t size_;
+		uint32_t id_;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <istream>
 #include <ostream>
@@ -8,6 +9,7 @@
 #include "pe_structures.h"
 #include "utils.h"
 #include "pe_section.h"
+#include "shared_data.h"
 #include "pe_properties.h"
 
 //Please don't remove this information from header
@@ -16,11 +18,10 @@
 //Free to use for commertial and non-commertial purposes, modification and distribution
 
 // == more important ==
-//TODO: compact import rebuilder
 //TODO: remove sections in the middle
 //== less important ==
 //TODO: relocations that take more than one element (seems to be not possible in Windows PE, but anyway)
-//TODO: delay import directory
+//TODO: delay import directory rebuilder
 //TODO: write message tables
 //TODO: write string tables
 //TODO: read security information
@@ -33,13 +34,21 @@ namespace pe_bliss
 	{
 	public: //CONSTRUCTORS
 		//Constructor from stream
-		pe_base(std::istream& file, const pe_properties& props, bool read_debug_raw_data = true);
+		//If read_debug_raw_data is true, raw CodeView, MISC and COFF debug data will be read and held by image
+		//If read_overlay_data is true, data after the last section will be held by image and written back by rebuild_pe
+		pe_base(std::istream& file, const pe_properties& props, bool read_debug_raw_data = true, bool read_overlay_data = false);
 
 		//Constructor of empty PE-file
 		explicit pe_base(const pe_properties& props, uint32_t section_alignment = 0x1000, bool dll = false, uint16_t subsystem = pe_win::image_subsystem_windows_gui);
 
+		//Copy constructor and assignment operator
+		//Section data, headers data, overlay and debug data are shared between copies until they are changed (copy-on-write)
 		pe_base(const pe_base& pe);
 		pe_base& operator=(const pe_base& pe);
+		//Move constructor and assignment operator
+		//Moved-from image can only be destroyed or assigned to
+		pe_base(pe_base&& pe) noexcept;
+		pe_base& operator=(pe_base&& pe) noexcept;
 
 	public:
 		~pe_base();
@@ -51,6 +60,7 @@ namespace pe_bliss
 		void fill_stub_overlay(char c);
 		//Sets stub MSVS overlay
 		void set_stub_overlay(const std::string& data);
+		void set_stub_overlay(std::string&& data);
 		//Returns stub overlay contents
 		const std::string& get_stub_overlay() const noexcept;
 
@@ -242,9 +252,18 @@ namespace pe_bliss
 		//Returns data from the beginning of image
 		//Size = SizeOfHeaders
 		const std::string& get_full_headers_data() const;
+		//Returns data from the beginning of image as it was read from file (or written by commit_inplace)
+		//Header fields fixed by parser (number of data directories, sizes of raw data of sections) have fixed values
+		const std::string& get_original_headers_data() const;
+		//Sets data from the beginning of image, which is stored in file (used by commit_inplace)
+		void set_original_headers_data(const std::string& data);
+		//Places current DOS header, stub overlay, NT headers and section headers over data from the beginning of image
+		//NT headers are placed at nt_headers_offset, section headers follow optional header of size_of_optional_header bytes
+		//Returns false, if headers don't fit into data (used by commit_inplace)
+		bool place_headers(std::string& headers_data, uint32_t nt_headers_offset, uint16_t size_of_optional_header) const;
 
 		typedef std::multimap<uint32_t, std::string> debug_data_list;
-		//Returns raw list of debug data
+		//Returns raw list of debug data (empty, if image was read with read_debug_raw_data = false)
 		const debug_data_list& get_raw_debug_data_list() const;
 
 		//Reads and checks DOS header
@@ -361,6 +380,11 @@ namespace pe_bliss
 		//Returns corresponding section data pointer from VA inside section "s" for PE32 and PE64 respectively (checks bounds)
 		char* section_data_from_va(section& s, uint32_t va); //Always returns raw data
 		const char* section_data_from_va(const section& s, uint32_t va, section_data_type datatype = section_data_raw) const;
+
+		//Writes data to section raw data at RVA (data must fit into raw data of section)
+		//Only written bytes are marked changed, so commit_inplace writes them alone instead of the whole section
+		//If include_headers = true, data at RVA inside of headers is written to headers data
+		void patch_section_data(uint32_t rva, const char* data, uint32_t size, bool include_headers = false);
 		char* section_data_from_va(section& s, uint64_t va); //Always returns raw data
 		const char* section_data_from_va(const section& s, uint64_t va, section_data_type datatype = section_data_raw) const;
 
@@ -370,7 +394,10 @@ namespace pe_bliss
 		{
 			if (rva >= s.get_virtual_address() && rva < s.get_virtual_address() + s.get_aligned_virtual_size(get_section_alignment()) && pe_utils::is_sum_safe(rva, sizeof(T)))
 			{
-				const std::string& data = datatype == section_data_raw ? s.get_raw_data() : s.get_virtual_data(get_section_alignment());
+				if (datatype == section_data_virtual)
+					return section_virtual_data_from_rva<T>(s, rva);
+
+				const std::string& data = s.get_raw_data();
 				//Don't check for underflow here, comparsion is unsigned
 				if (data.size() < rva - s.get_virtual_address() + sizeof(T))
 					throw pe_exception("RVA and requested data size does not exist inside section", pe_exception::rva_not_exists);
@@ -387,11 +414,14 @@ namespace pe_bliss
 		T section_data_from_rva(uint32_t rva, section_data_type datatype = section_data_raw, bool include_headers = false) const
 		{
 			//if RVA is inside of headers and we're searching them too...
-			if (include_headers && pe_utils::is_sum_safe(rva, sizeof(T)) && (rva + sizeof(T) < full_headers_data_.length()))
-				return *reinterpret_cast<const T*>(&full_headers_data_[rva]);
+			if (include_headers && pe_utils::is_sum_safe(rva, sizeof(T)) && (rva + sizeof(T) < full_headers_data_.get().length()))
+				return *reinterpret_cast<const T*>(&full_headers_data_.get()[rva]);
 
 			const section& s = section_from_rva(rva);
-			const std::string& data = datatype == section_data_raw ? s.get_raw_data() : s.get_virtual_data(get_section_alignment());
+			if (datatype == section_data_virtual)
+				return section_virtual_data_from_rva<T>(s, rva);
+
+			const std::string& data = s.get_raw_data();
 			//Don't check for underflow here, comparsion is unsigned
 			if (data.size() < rva - s.get_virtual_address() + sizeof(T))
 				throw pe_exception("RVA and requested data size does not exist inside section", pe_exception::rva_not_exists);
@@ -427,7 +457,7 @@ namespace pe_bliss
 		}
 
 		//Returns section and offset (raw data only) from its start from RVA
-		const std::pair<uint32_t, const section*> section_and_offset_from_rva(uint32_t rva) const;
+		std::pair<uint32_t, const section*> section_and_offset_from_rva(uint32_t rva) const;
 
 		//Sets virtual size of section "s"
 		//Section must be free (not bound to any image)
@@ -466,6 +496,20 @@ namespace pe_bliss
 
 		//Returns true if image has overlay data at the end of file
 		bool has_overlay() const;
+		//Returns file offset of overlay data in the file image was read from (it is not changed by rebuild_pe)
+		uint32_t get_overlay_offset() const;
+		//Returns size of overlay data
+		uint64_t get_overlay_size() const;
+		//Returns overlay data, if it is held by image (image was read with read_overlay_data = true or overlay was set)
+		//Otherwise returns empty string, use get_overlay_offset and get_overlay_size to access it in the source file
+		const std::string& get_overlay_data() const;
+		//Returns overlay data view from the whole file data (memory mapped or read file), data is not copied
+		std::string_view get_overlay_data(std::string_view file_data) const;
+		//Sets overlay data, which will be written after the last section by rebuild_pe
+		void set_overlay_data(const std::string& data);
+		void set_overlay_data(std::string&& data);
+		//Strips overlay data
+		void strip_overlay();
 
 		//Realigns file (changes file alignment)
 		void realign_file(uint32_t new_file_alignment);
@@ -482,13 +526,18 @@ namespace pe_bliss
 		std::string rich_overlay_;
 		//List of image sections
 		section_list sections_;
-		//True if image has overlay
-		bool has_overlay_;
+		//File offset and size of overlay data
+		uint32_t overlay_offset_;
+		uint64_t overlay_size_;
+		//Overlay data (if held by image)
+		shared_data<std::string> overlay_data_;
 		//Raw SizeOfHeaders-sized data from the beginning of image
-		std::string full_headers_data_;
+		shared_data<std::string> full_headers_data_;
+		//Data from the beginning of image as it is stored in file (to find changed header bytes)
+		shared_data<std::string> original_headers_data_;
 		//Raw debug data for all directories
 		//PointerToRawData; Data
-		debug_data_list debug_data_;
+		shared_data<debug_data_list> debug_data_;
 		//PE or PE+ related properties
 		pe_properties* props_;
 
@@ -496,7 +545,7 @@ namespace pe_bliss
 		void read_dos_header(std::istream& file);
 
 		//Reads and checks PE headers and section headers, data
-		void read_pe(std::istream& file, bool read_debug_raw_data);
+		void read_pe(std::istream& file, bool read_debug_raw_data, bool read_overlay_data);
 
 		//Sets number of sections
 		void set_number_of_sections(uint16_t number);
@@ -517,5 +566,16 @@ namespace pe_bliss
 		//RAW file offset to section convertion helpers (4gb max)
 		section_list::const_iterator file_offset_to_section(uint32_t offset) const;
 		section_list::iterator file_offset_to_section(uint32_t offset);
+
+		//Reads value from mapped virtual data of section "s" (data after raw data is read as zeros, section data is not mapped)
+		template<typename T>
+		T section_virtual_data_from_rva(const section& s, uint32_t rva) const
+		{
+			T ret;
+			if (!s.read_virtual_data(get_section_alignment(), rva - s.get_virtual_address(), reinterpret_cast<char*>(&ret), sizeof(T)))
+				throw pe_exception("RVA and requested data size does not exist inside section", pe_exception::rva_not_exists);
+
+			return ret;
+		}
 	};
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "pe_base.h"
+#include "pe_data_cursor.h"
 #include "pe_rebuilder.h"
 #include "pe_factory.h"
 #include "pe_bound_import.h"
@@ -8,11 +9,17 @@
 #include "pe_exception_directory.h"
 #include "pe_exports.h"
 #include "pe_imports.h"
+#include "pe_delay_import.h"
+#include "pe_module_set.h"
 #include "pe_load_config.h"
 #include "pe_relocations.h"
+#include "pe_hash.h"
 #include "pe_resources.h"
 #include "pe_rich_data.h"
 #include "pe_tls.h"
 #include "pe_properties_generic.h"
 #include "pe_checksum.h"
 #include "entropy.h"
+#include "pe_embedded.h"
+#include "memory_stream.h"
+#include "name_pool.h"
@@ -1,34 +1,58 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory_resource>
 #include "pe_structures.h"
 #include "pe_base.h"
 #include "pe_directory.h"
+#include "pe_data_cursor.h"
+#include "name_pool.h"
 
 namespace pe_bliss
 {
 	//Class representing bound import reference
 	class bound_import_ref
 	{
+	public:
+		//Module name is allocated from memory resource of allocator (see get_bound_import_module_list)
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
 	public:
 		//Default constructor
 		bound_import_ref() noexcept;
+		//Constructor with allocator
+		explicit bound_import_ref(const allocator_type& allocator) noexcept;
 		//Constructor from data
-		bound_import_ref(const std::string& module_name, uint32_t timestamp);
+		bound_import_ref(std::string_view module_name, uint32_t timestamp, const allocator_type& allocator = allocator_type());
+		//Constructor from data (module name is interned in pool)
+		bound_import_ref(std::string_view module_name, uint32_t timestamp, name_pool& pool, const allocator_type& allocator = allocator_type());
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		bound_import_ref(const bound_import_ref& other, const allocator_type& allocator);
+		bound_import_ref(bound_import_ref&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		bound_import_ref(const bound_import_ref& other) = default;
+		bound_import_ref(bound_import_ref&& other) noexcept = default;
+		bound_import_ref& operator=(const bound_import_ref& other) = default;
+		bound_import_ref& operator=(bound_import_ref&& other) = default;
 
-		//Returns imported module name
-		const std::string& get_module_name() const noexcept;
+		//Returns imported module name (null-terminated)
+		std::string_view get_module_name() const noexcept;
+		//Returns ID of module name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_module_name_id() const noexcept;
 		//Returns bound import date and time stamp
 		uint32_t get_timestamp() const noexcept;
 
 	public: //Setters
 		//Sets module name
-		void set_module_name(const std::string& module_name) noexcept;
+		void set_module_name(std::string_view module_name);
+		//Sets module name interned in pool
+		void set_module_name(std::string_view module_name, name_pool& pool);
 		//Sets timestamp
 		void set_timestamp(uint32_t timestamp) noexcept;
 
 	private:
-		std::string module_name_; //Imported module name
+		pooled_name module_name_; //Imported module name
 		uint32_t timestamp_; //Bound import timestamp
 	};
 
@@ -36,16 +60,32 @@ namespace pe_bliss
 	class bound_import
 	{
 	public:
-		using ref_list = std::vector<bound_import_ref>;
+		using ref_list = std::pmr::vector<bound_import_ref>;
+		//Module name and references are allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
 
 	public:
 		//Default constructor
 		bound_import() noexcept;
+		//Constructor with allocator
+		explicit bound_import(const allocator_type& allocator) noexcept;
 		//Constructor from data
-		bound_import(const std::string& module_name, uint32_t timestamp);
+		bound_import(std::string_view module_name, uint32_t timestamp, const allocator_type& allocator = allocator_type());
+		//Constructor from data (module name is interned in pool)
+		bound_import(std::string_view module_name, uint32_t timestamp, name_pool& pool, const allocator_type& allocator = allocator_type());
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		bound_import(const bound_import& other, const allocator_type& allocator);
+		bound_import(bound_import&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		bound_import(const bound_import& other) = default;
+		bound_import(bound_import&& other) noexcept = default;
+		bound_import& operator=(const bound_import& other) = default;
+		bound_import& operator=(bound_import&& other) = default;
 
-		//Returns imported module name
-		const std::string& get_module_name() const noexcept;
+		//Returns imported module name (null-terminated)
+		std::string_view get_module_name() const noexcept;
+		//Returns ID of module name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_module_name_id() const noexcept;
 		//Returns bound import date and time stamp
 		uint32_t get_timestamp() const noexcept;
 
@@ -56,7 +96,9 @@ namespace pe_bliss
 
 	public: //Setters
 		//Sets module name
-		void set_module_name(const std::string& module_name) noexcept;
+		void set_module_name(std::string_view module_name);
+		//Sets module name interned in pool
+		void set_module_name(std::string_view module_name, name_pool& pool);
 		//Sets timestamp
 		void set_timestamp(uint32_t timestamp) noexcept;
 
@@ -68,20 +110,26 @@ namespace pe_bliss
 		ref_list& get_module_ref_list() noexcept;
 
 	private:
-		std::string module_name_; //Imported module name
+		pooled_name module_name_; //Imported module name
 		uint32_t timestamp_; //Bound import timestamp
 		ref_list refs_; //Module references list
 	};
 
-	using bound_import_module_list = std::vector<bound_import>;
+	using bound_import_module_list = std::pmr::vector<bound_import>;
 
 	//Returns bound import information
-	const bound_import_module_list get_bound_import_module_list(const pe_base& pe);//Export directory rebuilder
+	//All lists and names are allocated from "resource", so it must outlive returned list
+	//If "names" is not null, module names are interned in it instead (pool must outlive returned list)
+	bound_import_module_list get_bound_import_module_list(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
+
+	//Reads bound import information of image with "cursor" and appends it to "imports" (see get_all_imports)
+	//Checks are the same as in get_bound_import_module_list, names are allocated from memory resource of "imports" or interned in "names"
+	void read_bound_import_module_list(pe_data_cursor& cursor, bound_import_module_list& imports, name_pool* names = 0);
 
 	//imports - bound imported modules list
 	//imports_section - section where export directory will be placed (must be attached to PE image)
 	//offset_from_section_start - offset from imports_section raw data start
 	//save_to_pe_headers - if true, new bound import directory information will be saved to PE image headers
 	//auto_strip_last_section - if true and bound imports are placed in the last section, it will be automatically stripped
-	const image_directory rebuild_bound_imports(pe_base& pe, const bound_import_module_list& imports, section& imports_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
+	image_directory rebuild_bound_imports(pe_base& pe, const bound_import_module_list& imports, section& imports_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
 }
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstring>
+#include <string_view>
+#include "pe_base.h"
+#include "pe_exception.h"
+#include "utils.h"
+
+namespace pe_bliss
+{
+	//Class reading image data by RVA the same way as section_data_from_rva(rva, section_data_virtual, true) does,
+	//but section of the last read is remembered, so consecutive reads from one section do not search sections list
+	//Directories, which are placed together (for example, import, delay import and bound import data), are walked
+	//with one cursor without repeated lookups. Image must not be changed while cursor is used
+	class pe_data_cursor
+	{
+	public:
+		//Constructor from image
+		explicit pe_data_cursor(const pe_base& pe);
+
+		//Returns image
+		const pe_base& get_pe() const;
+
+		//Reads value from virtual data at RVA (data inside of headers is searched, too)
+		template<typename T>
+		T read(uint32_t rva)
+		{
+			T ret;
+			//if RVA is inside of headers...
+			if (pe_utils::is_sum_safe(rva, sizeof(T)) && rva + sizeof(T) < headers_.length())
+				memcpy(&ret, headers_.data() + rva, sizeof(T));
+			else
+				memcpy(&ret, get_section_data(rva, sizeof(T)), sizeof(T));
+
+			return ret;
+		}
+
+		//Returns null-terminated string from virtual data at RVA (data inside of headers is searched, too)
+		//If there is no null-terminated string of at least one character, pe_exception(error_message, error_id) is thrown
+		const char* read_string(uint32_t rva, const char* error_message, pe_exception::exception_id error_id);
+
+		//Returns raw data at RVA (data inside of headers is searched, too) and its remaining length
+		std::string_view read_raw_data(uint32_t rva);
+
+	private:
+		//Makes section containing RVA current one
+		void select_section(uint32_t rva);
+		//Returns pointer to "size" bytes of virtual data of section containing RVA
+		const char* get_section_data(uint32_t rva, uint32_t size);
+
+		const pe_base& pe_;
+		std::string_view headers_;
+
+		//Current section, its RVA, aligned virtual size and virtual data
+		const section* section_;
+		uint32_t section_rva_;
+		uint32_t section_size_;
+		std::string_view section_data_;
+	};
+}
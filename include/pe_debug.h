@@ -1,5 +1,9 @@
 #pragma once
 #include <vector>
+#include <iterator>
+#include <string_view>
+#include <istream>
+#include <memory_resource>
 #include "pe_structures.h"
 #include "pe_base.h"
 
@@ -15,7 +19,7 @@ namespace pe_bliss
 		explicit pdb_7_0_info(const pe_win::CV_INFO_PDB70* info);
 
 		//Returns debug PDB 7.0 structure GUID
-		const pe_win::guid get_guid() const;
+		pe_win::guid get_guid() const;
 		//Returns age of build
 		uint32_t get_age() const;
 		//Returns PDB file name / path
@@ -83,9 +87,23 @@ namespace pe_bliss
 		//Structure representing COFF symbol
 		struct coff_symbol
 		{
+		public:
+			//Name is allocated from memory resource of allocator (see get_debug_information)
+			typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
 		public:
 			//Default constructor
 			coff_symbol();
+			//Constructor with allocator
+			explicit coff_symbol(const allocator_type& allocator);
+			//Allocator-extended copy and move constructors (used by std::pmr containers)
+			coff_symbol(const coff_symbol& other, const allocator_type& allocator);
+			coff_symbol(coff_symbol&& other, const allocator_type& allocator);
+			//Copy and move constructors and assignment operators
+			coff_symbol(const coff_symbol& other) = default;
+			coff_symbol(coff_symbol&& other) noexcept = default;
+			coff_symbol& operator=(const coff_symbol& other) = default;
+			coff_symbol& operator=(coff_symbol&& other) = default;
 
 			//Returns storage class
 			uint32_t get_storage_class() const;
@@ -101,7 +119,7 @@ namespace pe_bliss
 			//Returns true if structure contains file name
 			bool is_file() const;
 			//Returns text data (symbol or file name)
-			const std::string& get_symbol() const;
+			const std::pmr::string& get_symbol() const;
 
 		public: //These functions do not change everything inside image, they are used by PE class
 			//Sets storage class
@@ -116,9 +134,9 @@ namespace pe_bliss
 			void set_type(uint16_t type);
 
 			//Sets file name
-			void set_file_name(const std::string& file_name);
+			void set_file_name(std::string_view file_name);
 			//Sets symbol name
-			void set_symbol_name(const std::string& symbol_name);
+			void set_symbol_name(std::string_view symbol_name);
 
 		private:
 			uint32_t storage_class_;
@@ -126,17 +144,19 @@ namespace pe_bliss
 			uint32_t section_number_, rva_;
 			uint16_t type_;
 			bool is_filename_;
-			std::string name_;
+			std::pmr::string name_;
 		};
 
 	public:
-		typedef std::vector<coff_symbol> coff_symbols_list;
+		typedef std::pmr::vector<coff_symbol> coff_symbols_list;
 
 	public:
 		//Default constructor
 		coff_debug_info();
 		//Constructor from data
 		explicit coff_debug_info(const pe_win::image_coff_symbols_header* info);
+		//Constructor from data with allocator (symbols are allocated from its memory resource)
+		coff_debug_info(const pe_win::image_coff_symbols_header* info, const coff_symbol::allocator_type& allocator);
 
 		//Returns number of symbols
 		uint32_t get_number_of_symbols() const;
@@ -161,6 +181,7 @@ namespace pe_bliss
 	public: //These functions do not change everything inside image, they are used by PE class
 		//Adds COFF symbol
 		void add_symbol(const coff_symbol& sym);
+		void add_symbol(coff_symbol&& sym);
 
 	private:
 		uint32_t number_of_symbols_;
@@ -176,6 +197,103 @@ namespace pe_bliss
 		coff_symbols_list symbols_;
 	};
 
+	//COFF symbol record decoded from COFF symbol table (IMAGE_SYMBOL), auxiliary records are not decoded
+	struct coff_symbol_record
+	{
+		uint32_t index; //Index of record in symbol table
+		uint32_t value; //Symbol value (RVA for symbols, which have section number)
+		int16_t section_number;
+		uint16_t type;
+		uint8_t storage_class;
+		uint8_t number_of_aux_symbols;
+		//Symbol name (from short name or string table) or file name (from auxiliary records) for image_sym_class_file symbols
+		//It is a view into raw debug data
+		std::string_view name;
+	};
+
+	//Class representing view of COFF symbol table inside raw COFF (IMAGE_DEBUG_TYPE_COFF) debug data
+	//Unlike coff_debug_info, symbols are not copied: records are decoded from raw data when they are iterated,
+	//names are views into raw data and auxiliary records are skipped, so nothing is allocated per symbol
+	//Raw data (see get_raw_debug_data_list of pe_base or get_pointer_to_raw_data of debug_info) must be alive while view is used
+	class coff_symbol_table_view
+	{
+	public:
+		//Index of address index entries is allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+		//Value returned by find_symbol_by_address, if symbol is not found
+		static const uint32_t npos = static_cast<uint32_t>(-1);
+
+		//Input iterator over symbols (auxiliary records are skipped, symbols are decoded and returned by value)
+		class iterator
+		{
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef coff_symbol_record value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef void pointer;
+			typedef coff_symbol_record reference;
+
+		public:
+			//Default constructor
+			iterator();
+			//Constructor from view and index of record
+			iterator(const coff_symbol_table_view* view, uint32_t index);
+
+			reference operator*() const;
+			iterator& operator++();
+			iterator operator++(int);
+			bool operator==(const iterator& other) const;
+			bool operator!=(const iterator& other) const;
+
+		private:
+			const coff_symbol_table_view* view_;
+			uint32_t index_;
+		};
+
+	public:
+		//Default constructor (empty symbol table)
+		coff_symbol_table_view();
+		//Constructor from raw COFF debug data (image_coff_symbols_header, symbols and string table)
+		//Checks header and symbol table bounds
+		explicit coff_symbol_table_view(std::string_view debug_data, const allocator_type& allocator = allocator_type());
+
+		//Returns COFF symbols header
+		const pe_win::image_coff_symbols_header& get_header() const;
+		//Returns number of records in symbol table (including auxiliary records)
+		uint32_t get_number_of_records() const;
+		//Returns string table (data after symbol table)
+		std::string_view get_string_table() const;
+		//Decodes symbol by index of record (record must not be auxiliary one)
+		coff_symbol_record get_symbol(uint32_t index) const;
+
+		iterator begin() const;
+		iterator end() const;
+
+		//Builds index of symbols by address, which is used by find_symbol_by_address
+		//Symbols with positive section number are indexed, if they are external, or static or label without auxiliary records
+		//(static symbols with auxiliary records are section definitions)
+		void build_address_index();
+		//Returns true if address index is built
+		bool has_address_index() const;
+		//Returns index of record of symbol with the greatest address, which is not greater than RVA
+		//(the first one in symbol table order, if there are several), or npos, if there's no such symbol
+		//Address index must be built
+		uint32_t find_symbol_by_address(uint32_t rva) const;
+
+	private:
+		//Returns number of auxiliary records after record (clamped by symbol table size)
+		uint32_t get_number_of_aux_records(uint32_t index) const;
+
+	private:
+		pe_win::image_coff_symbols_header header_;
+		std::string_view symbols_;
+		std::string_view string_table_;
+		//Address and index of record (address << 32 | index) of indexed symbols, sorted
+		std::pmr::vector<uint64_t> address_index_;
+		bool address_index_built_;
+	};
+
 	//Class representing debug information
 	class debug_info
 	{
@@ -221,6 +339,10 @@ namespace pe_bliss
 		debug_info(const debug_info& info);
 		//Copy assignment operator
 		debug_info& operator=(const debug_info& info);
+		//Move constructor (advanced debug information is not copied)
+		debug_info(debug_info&& info) noexcept;
+		//Move assignment operator
+		debug_info& operator=(debug_info&& info) noexcept;
 		//Destructor
 		~debug_info();
 
@@ -248,7 +370,7 @@ namespace pe_bliss
 		//Returns advanced debug information or throws an exception,
 		//if requested information type is not contained by structure
 		template<typename AdvancedInfo>
-		const AdvancedInfo get_advanced_debug_info() const;
+		AdvancedInfo get_advanced_debug_info() const;
 
 	public: //These functions do not change everything inside image, they are used by PE class
 		//Sets advanced debug information
@@ -256,6 +378,7 @@ namespace pe_bliss
 		void set_advanced_debug_info(const pdb_2_0_info& info);
 		void set_advanced_debug_info(const misc_debug_info& info);
 		void set_advanced_debug_info(const coff_debug_info& info);
+		void set_advanced_debug_info(coff_debug_info&& info);
 
 		//Sets advanced debug information type, if no advanced info structure available
 		void set_advanced_info_type(advanced_info_type type);
@@ -296,8 +419,16 @@ namespace pe_bliss
 		advanced_info_type advanced_info_type_;
 	};
 
-	typedef std::vector<debug_info> debug_info_list;
+	typedef std::pmr::vector<debug_info> debug_info_list;
 
 	//Returns debug information list
-	const debug_info_list get_debug_information(const pe_base& pe);
+	//Advanced debug information is read from raw debug data held by image (see read_debug_raw_data of pe_factory)
+	//List and COFF symbols are allocated from "resource", so it must outlive returned list
+	debug_info_list get_debug_information(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	//Returns debug information list, raw debug data is viewed in the whole file data (memory mapped or read file),
+	//data is not copied, so image may be read with read_debug_raw_data = false
+	debug_info_list get_debug_information(const pe_base& pe, std::string_view file_data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	//Returns debug information list, raw debug data is read from file (the image was read from) only for directories,
+	//which have advanced debug information, so image may be read with read_debug_raw_data = false
+	debug_info_list get_debug_information(const pe_base& pe, std::istream& file, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 }
@@ -0,0 +1,156 @@
+#pragma once
+#include <string_view>
+#include <memory_resource>
+#include "pe_structures.h"
+#include "pe_base.h"
+#include "pe_data_cursor.h"
+#include "pe_imports.h"
+#include "pe_bound_import.h"
+#include "name_pool.h"
+
+namespace pe_bliss
+{
+	//Class representing delay-loaded library information
+	//All addresses are RVAs, addresses of old VA-based descriptors are converted when parsed
+	class delay_import_library
+	{
+	public:
+		typedef import_library::imported_list imported_list;
+		//Name and imported functions are allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+	public:
+		//Default constructor
+		delay_import_library();
+		//Constructor with allocator
+		explicit delay_import_library(const allocator_type& allocator);
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		delay_import_library(const delay_import_library& other, const allocator_type& allocator);
+		delay_import_library(delay_import_library&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		delay_import_library(const delay_import_library& other) = default;
+		delay_import_library(delay_import_library&& other) noexcept = default;
+		delay_import_library& operator=(const delay_import_library& other) = default;
+		delay_import_library& operator=(delay_import_library&& other) = default;
+
+		//Returns name of library (null-terminated)
+		std::string_view get_name() const;
+		//Returns name of library as std::string
+		std::string get_name_string() const;
+		//Returns ID of library name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_name_id() const;
+		//Returns descriptor attributes
+		uint32_t get_attributes() const;
+		//Returns true if descriptor addresses are RVAs (otherwise they are VAs, old Visual C++ 6.0 format)
+		bool is_rva_based() const;
+		//Returns RVA to library module handle
+		uint32_t get_rva_to_module_handle() const;
+		//Returns RVA to Import Address Table (IAT)
+		uint32_t get_rva_to_iat() const;
+		//Returns RVA to Import Name Table
+		uint32_t get_rva_to_name_table() const;
+		//Returns RVA to bound IAT (zero, if not present)
+		uint32_t get_rva_to_bound_iat() const;
+		//Returns RVA to unload information table (copy of IAT, zero, if not present)
+		uint32_t get_rva_to_unload_info() const;
+		//Returns timestamp of library image bound to (zero, if not bound)
+		uint32_t get_timestamp() const;
+
+		//Returns imported functions list
+		//IAT VA of each function is initial value of IAT entry (VA of delay load helper thunk)
+		const imported_list& get_imported_functions() const;
+
+	public: //Setters do not change everything inside image, they are used by PE class
+		//Sets name of library
+		void set_name(std::string_view name);
+		//Sets name of library interned in pool
+		void set_name(std::string_view name, name_pool& pool);
+		//Sets descriptor attributes
+		void set_attributes(uint32_t attributes);
+		//Sets RVA to library module handle
+		void set_rva_to_module_handle(uint32_t rva);
+		//Sets RVA to Import Address Table (IAT)
+		void set_rva_to_iat(uint32_t rva);
+		//Sets RVA to Import Name Table
+		void set_rva_to_name_table(uint32_t rva);
+		//Sets RVA to bound IAT
+		void set_rva_to_bound_iat(uint32_t rva);
+		//Sets RVA to unload information table
+		void set_rva_to_unload_info(uint32_t rva);
+		//Sets timestamp
+		void set_timestamp(uint32_t timestamp);
+
+		//Adds imported function
+		void add_import(const imported_function& func);
+		void add_import(imported_function&& func);
+		//Clears imported functions list
+		void clear_imports();
+
+	private:
+		pooled_name name_; //Library name
+		uint32_t attributes_;
+		uint32_t rva_to_module_handle_;
+		uint32_t rva_to_iat_;
+		uint32_t rva_to_name_table_;
+		uint32_t rva_to_bound_iat_;
+		uint32_t rva_to_unload_info_;
+		uint32_t timestamp_;
+
+		imported_list imports_;
+	};
+
+	typedef std::pmr::vector<delay_import_library> delay_imported_functions_list;
+
+	//Returns delay-loaded imported functions list with related libraries info
+	//Both RVA-based and old VA-based descriptors are supported
+	//All lists and names are allocated from "resource", so it must outlive returned list
+	//If "names" is not null, library and function names are interned in it instead (pool must outlive returned list)
+	delay_imported_functions_list get_delay_imported_functions(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
+
+	template<typename PEClassType>
+	delay_imported_functions_list get_delay_imported_functions_base(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
+
+	//Reads delay-loaded imported functions list of image with "cursor" and appends it to "imports" (see get_all_imports)
+	//Checks are the same as in get_delay_imported_functions, names are allocated from memory resource of "imports" or interned in "names"
+	void read_delay_imported_functions(pe_data_cursor& cursor, delay_imported_functions_list& imports, name_pool* names = 0);
+
+	//Class representing all image imports: regular, delay-loaded and bound ones
+	class all_imports
+	{
+	public:
+		//All lists are allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+	public:
+		//Default constructor
+		all_imports();
+		//Constructor with allocator
+		explicit all_imports(const allocator_type& allocator);
+
+		//Returns regular imported libraries
+		const imported_functions_list& get_imports() const;
+		//Returns delay-loaded libraries
+		const delay_imported_functions_list& get_delay_imports() const;
+		//Returns bound imported modules
+		const bound_import_module_list& get_bound_imports() const;
+
+	public: //These functions do not change everything inside image, they are used by get_all_imports
+		//Returns regular imported libraries
+		imported_functions_list& get_imports();
+		//Returns delay-loaded libraries
+		delay_imported_functions_list& get_delay_imports();
+		//Returns bound imported modules
+		bound_import_module_list& get_bound_imports();
+
+	private:
+		imported_functions_list imports_;
+		delay_imported_functions_list delay_imports_;
+		bound_import_module_list bound_imports_;
+	};
+
+	//Returns regular, delay-loaded and bound imports of image in one scan
+	//All directories are walked with one pe_data_cursor, which remembers current section, and read straight to resulting lists
+	//All lists and names are allocated from "resource" (it must outlive returned value)
+	//If "names" is not null, all library, function and bound module names are interned in it instead
+	all_imports get_all_imports(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
+}
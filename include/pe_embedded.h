@@ -0,0 +1,128 @@
+#pragma once
+#include <vector>
+#include <string_view>
+#include "pe_structures.h"
+#include "pe_base.h"
+
+namespace pe_bliss
+{
+	//Class representing PE image found inside data of other image
+	//Image data is not copied, embedded_pe holds a view to data of scanned image,
+	//so scanned image (or buffer) must not be changed or destroyed while views are used
+	class embedded_pe
+	{
+	public:
+		//Enumeration of places where embedded image may be found
+		enum embedded_pe_source
+		{
+			source_resource, //Resource data entry (leaf)
+			source_section, //Section raw data
+			source_overlay, //Overlay data or raw data buffer
+			source_embedded_pe //Data of other embedded image
+		};
+
+	public:
+		//Default constructor
+		embedded_pe();
+		//Constructor from data
+		embedded_pe(embedded_pe_source source, std::string_view data, uint32_t offset, uint32_t rva, uint32_t depth, pe_type type);
+
+		//Returns place where image was found
+		embedded_pe_source get_source() const;
+		//Returns offset of image from the beginning of containing data
+		//(resource data, section raw data, overlay or parent embedded image)
+		uint32_t get_offset() const;
+		//Returns RVA of image inside scanned image
+		//Zero for images found in overlay, raw buffers and inside of other embedded images
+		uint32_t get_rva() const;
+		//Returns nesting depth (1 for images found directly inside scanned image)
+		uint32_t get_depth() const;
+		//Returns index of parent image inside scan result list or -1, if image has no embedded parent
+		std::size_t get_parent_index() const;
+		//Returns PE type of image
+		pe_type get_pe_type() const;
+		//Returns size of image (calculated from image headers)
+		uint32_t get_size() const;
+		//Returns image data view
+		std::string_view get_data() const;
+
+		//Creates pe_base from image data (parses embedded image fully)
+		pe_base create_pe(bool read_debug_raw_data = true) const;
+
+	public: //These functions do not change everything inside image, they are used by scanner
+		//Sets index of parent image inside scan result list
+		void set_parent_index(std::size_t index);
+
+	private:
+		embedded_pe_source source_;
+		std::string_view data_;
+		uint32_t offset_;
+		uint32_t rva_;
+		uint32_t depth_;
+		std::size_t parent_index_;
+		pe_type type_;
+	};
+
+	typedef std::vector<embedded_pe> embedded_pe_list;
+
+	//Class representing embedded PE scanner settings
+	class embedded_pe_scan_settings
+	{
+	public:
+		//Default constructor
+		//max_depth - maximum nesting depth (1 - don't scan found images for nested ones)
+		//max_image_size - images with larger calculated size are ignored
+		explicit embedded_pe_scan_settings(uint32_t max_depth = 3, uint32_t max_image_size = 0x10000000);
+
+		//Returns maximum nesting depth
+		uint32_t get_max_depth() const;
+		//Returns maximum size of embedded image
+		uint32_t get_max_image_size() const;
+		//Returns maximum number of scanning threads (0 = hardware concurrency)
+		uint32_t get_max_threads() const;
+
+		//Returns true if resource data entries will be scanned
+		bool scan_resources() const;
+		//Returns true if section raw data will be scanned
+		bool scan_sections() const;
+		//Returns true if overlay data held by image will be scanned
+		bool scan_overlay() const;
+
+	public: //Setters
+		//Sets maximum nesting depth
+		void set_max_depth(uint32_t max_depth);
+		//Sets maximum size of embedded image
+		void set_max_image_size(uint32_t max_image_size);
+		//Sets maximum number of scanning threads (0 = hardware concurrency, 1 = scan in calling thread)
+		void set_max_threads(uint32_t max_threads);
+
+		//Sets if resource data entries will be scanned
+		void scan_resources(bool enable);
+		//Sets if section raw data will be scanned
+		void scan_sections(bool enable);
+		//Sets if overlay data held by image will be scanned
+		void scan_overlay(bool enable);
+
+	private:
+		uint32_t max_depth_;
+		uint32_t max_image_size_;
+		uint32_t max_threads_;
+		bool scan_resources_;
+		bool scan_sections_;
+		bool scan_overlay_;
+	};
+
+	//Checks if data starts with PE image headers (headers only are checked, nothing is parsed)
+	//If check passes, returns true and sets image_size (calculated from section table) and PE type
+	//Images, which don't fit into data, are rejected
+	bool check_embedded_pe_headers(std::string_view data, uint32_t& image_size, pe_type& type);
+
+	//Scans resource data entries, section raw data and overlay data (if held by image) for embedded PE images
+	//in one pass, including nested ones up to maximum depth
+	//Images found in resources are not reported second time as part of section data
+	embedded_pe_list find_embedded_pe(const pe_base& pe, const embedded_pe_scan_settings& settings = embedded_pe_scan_settings());
+
+	//Scans raw data buffer (for example, overlay or dump) for embedded PE images
+	//Images are reported with source_overlay source
+	embedded_pe_list find_embedded_pe(std::string_view data, const embedded_pe_scan_settings& settings = embedded_pe_scan_settings());
+}
@@ -88,7 +88,16 @@ namespace pe_bliss
 
 			error_expanding_section,
 
-			cannot_rebuild_image
+			cannot_rebuild_image,
+
+			error_writing_file,
+
+			name_not_found,
+
+			incorrect_delay_import_directory,
+
+			module_not_found,
+			import_not_found
 		};
 
 	public:
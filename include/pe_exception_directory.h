@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include "pe_structures.h"
 #include "pe_base.h"
 
@@ -63,5 +65,131 @@ namespace pe_bliss
 
 	//Returns exception directory data (exists on PE+ only)
 	//Unwind opcodes are not listed, because their format and list are subject to change
-	const exception_entry_list get_exception_directory_data(const pe_base& pe);
+	exception_entry_list get_exception_directory_data(const pe_base& pe);
+
+	//Unwind operation decoded from UNWIND_CODE slots (operation slot and its operand slots)
+	struct unwind_operation
+	{
+		uint8_t code_offset; //Offset from the beginning of prolog to the end of instruction, which performs operation
+		uint8_t operation; //Unwind operation code (see unwind_op_codes)
+		uint8_t info; //Operation info (register number, etc.)
+		//Operand from following slots: allocation size (uwop_alloc_large, uwop_alloc_small) and offset from stack pointer
+		//(uwop_save_nonvol*, uwop_save_xmm128*) are in bytes, operands of uwop_epilog and uwop_spare_code are raw, others are zero
+		uint32_t operand;
+	};
+
+	//Class representing decoded unwind information (UNWIND_INFO) of function
+	class unwind_plan
+	{
+	public:
+		typedef std::vector<unwind_operation> operation_list;
+
+	public:
+		//Default constructor
+		unwind_plan();
+
+		//Returns RVA of unwind info
+		uint32_t get_unwind_info_address() const;
+		//Returns UNWIND_INFO structure version
+		uint8_t get_version() const;
+		//Returns unwind info flags
+		uint8_t get_flags() const;
+		//Returns size of function prolog
+		uint8_t get_size_of_prolog() const;
+		//Returns number of the nonvolatile register used as the frame pointer (zero, if frame pointer is not used)
+		uint8_t get_frame_pointer_register_number() const;
+		//Returns scaled offset from RSP that is applied to the FP reg when it is established
+		uint8_t get_scaled_rsp_offset() const;
+
+		//Returns unwind operations in order they are stored (reverse order of prolog instructions)
+		const operation_list& get_operations() const;
+
+		//Returns RVA of exception or termination handler (if unw_flag_ehandler or unw_flag_uhandler is set) or zero
+		uint32_t get_handler_address() const;
+		//Returns RVA of language-specific handler data (if handler is present) or zero
+		uint32_t get_handler_data_address() const;
+
+		//Returns true if unwind info is chained (unw_flag_chaininfo is set)
+		bool is_chained() const;
+		//Returns function entry, which unwind info is chained to
+		const pe_win::image_runtime_function_entry& get_chained_function() const;
+		//Returns unwind plan of chained function entry or nullptr, if unwind info is not chained
+		const unwind_plan* get_chained_plan() const;
+		//Returns the last plan in chain (primary unwind info of function, which holds handler information)
+		const unwind_plan& get_primary_plan() const;
+
+	public: //These functions do not change everything inside image, they are used by runtime_function_index
+		//Sets UNWIND_INFO header data
+		void set_unwind_info(uint32_t address, const pe_win::unwind_info& info);
+		//Adds unwind operation
+		void add_operation(const unwind_operation& operation);
+		//Sets handler and its data addresses
+		void set_handler(uint32_t handler_address, uint32_t handler_data_address);
+		//Sets chained function entry and its plan
+		void set_chained(const pe_win::image_runtime_function_entry& function, const unwind_plan* plan);
+
+	private:
+		uint32_t unwind_info_address_;
+		uint8_t version_;
+		uint8_t flags_;
+		uint8_t size_of_prolog_;
+		uint8_t frame_register_, frame_offset_;
+		operation_list operations_;
+		uint32_t handler_address_, handler_data_address_;
+		pe_win::image_runtime_function_entry chained_function_;
+		const unwind_plan* chained_plan_;
+	};
+
+	//Class representing index of exception directory (RUNTIME_FUNCTION array) of PE+ image
+	//Functions are binary-searched by address directly in section data, unwind info is decoded on the first access
+	//and cached (by unwind info address, so shared and chained unwind infos are decoded once)
+	//Image must be alive and unchanged while index is used
+	//Functions, which decode unwind info, are not thread-safe, call decode_all first
+	//to use get_unwind_plan and find_unwind_plan from several threads (they only read cache then)
+	class runtime_function_index
+	{
+	public:
+		//Value returned by find_function, if function is not found
+		static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	public:
+		//Constructor from image, checks that function entries are sorted and do not overlap
+		explicit runtime_function_index(const pe_base& pe);
+
+		//Returns number of function entries
+		std::size_t size() const;
+		//Returns function entry by index
+		pe_win::image_runtime_function_entry get_function(std::size_t index) const;
+		//Returns index of function entry, which contains RVA, or npos, if there's no such entry
+		std::size_t find_function(uint32_t rva) const;
+
+		//Returns unwind plan of function entry by index
+		const unwind_plan& get_unwind_plan(std::size_t index);
+		//Returns unwind plan of function entry, which contains RVA, or nullptr, if there's no such entry
+		const unwind_plan* find_unwind_plan(uint32_t rva);
+		//Decodes unwind info of all function entries
+		void decode_all();
+
+	private:
+		//Returns BeginAddress or EndAddress of function entry
+		uint32_t get_begin_address(std::size_t index) const;
+		uint32_t get_end_address(std::size_t index) const;
+		//Decodes unwind info at RVA (and chained unwind info), returns cached plan
+		const unwind_plan& decode_unwind_info(uint32_t address, uint32_t chain_depth);
+
+	private:
+		const pe_base& pe_;
+		//RUNTIME_FUNCTION array inside section data
+		const char* functions_;
+		std::size_t count_;
+		//Decoded plans (references to deque elements remain valid when plans are added)
+		std::deque<unwind_plan> plans_;
+		//Unwind info address -> index of plan
+		std::unordered_map<uint32_t, std::size_t> plan_indexes_;
+		//Plans of function entries (nullptr, if unwind info is not decoded yet)
+		std::vector<const unwind_plan*> function_plans_;
+
+		runtime_function_index(const runtime_function_index&);
+		runtime_function_index& operator=(const runtime_function_index&);
+	};
 }
@@ -1,18 +1,35 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <string_view>
+#include <memory_resource>
 #include "pe_structures.h"
 #include "pe_base.h"
 #include "pe_directory.h"
+#include "name_pool.h"
 
 namespace pe_bliss
 {
 	//Class representing exported function
 	class exported_function
 	{
+	public:
+		//Names are allocated from memory resource of allocator (see get_exported_functions)
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
 	public:
 		//Default constructor
 		exported_function();
+		//Constructor with allocator
+		explicit exported_function(const allocator_type& allocator);
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		exported_function(const exported_function& other, const allocator_type& allocator);
+		exported_function(exported_function&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		exported_function(const exported_function& other) = default;
+		exported_function(exported_function&& other) noexcept = default;
+		exported_function& operator=(const exported_function& other) = default;
+		exported_function& operator=(exported_function&& other) = default;
 
 		//Returns ordinal of function (actually, ordinal = hint + ordinal base)
 		uint16_t get_ordinal() const;
@@ -22,15 +39,21 @@ namespace pe_bliss
 
 		//Returns true if function has name and name ordinal
 		bool has_name() const;
-		//Returns name of function
-		const std::string& get_name() const;
+		//Returns name of function (null-terminated)
+		std::string_view get_name() const;
+		//Returns name of function as std::string
+		std::string get_name_string() const;
+		//Returns ID of function name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_name_id() const;
 		//Returns name ordinal of function
 		uint16_t get_name_ordinal() const;
 
 		//Returns true if function is forwarded to other library
 		bool is_forwarded() const;
-		//Returns the name of forwarded function
-		const std::string& get_forwarded_name() const;
+		//Returns the name of forwarded function (null-terminated)
+		std::string_view get_forwarded_name() const;
+		//Returns ID of forwarded function name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_forwarded_name_id() const;
 
 	public: //Setters do not change everything inside image, they are used by PE class
 		//You can also use them to rebuild export directory
@@ -42,21 +65,25 @@ namespace pe_bliss
 		void set_rva(uint32_t rva);
 
 		//Sets name of function (or clears it, if empty name is passed)
-		void set_name(const std::string& name);
+		void set_name(std::string_view name);
+		//Sets name of function interned in pool (or clears it, if empty name is passed)
+		void set_name(std::string_view name, name_pool& pool);
 		//Sets name ordinal
 		void set_name_ordinal(uint16_t name_ordinal);
 
 		//Sets forwarded function name (or clears it, if empty name is passed)
-		void set_forwarded_name(const std::string& name);
+		void set_forwarded_name(std::string_view name);
+		//Sets forwarded function name interned in pool (or clears it, if empty name is passed)
+		void set_forwarded_name(std::string_view name, name_pool& pool);
 
 	private:
 		uint16_t ordinal_; //Function ordinal
 		uint32_t rva_; //Function RVA
-		std::string name_; //Function name
+		pooled_name name_; //Function name
 		bool has_name_; //true == function has name
 		uint16_t name_ordinal_; //Function name ordinal
 		bool forward_; //true == function is forwarded
-		std::string forward_name_; //Name of forwarded function
+		pooled_name forward_name_; //Name of forwarded function
 	};
 
 	//Class representing export information
@@ -130,19 +157,21 @@ namespace pe_bliss
 	};
 
 	//Exported functions list typedef
-	typedef std::vector<exported_function> exported_functions_list;
+	typedef std::pmr::vector<exported_function> exported_functions_list;
 
 	//Returns array of exported functions
-	const exported_functions_list get_exported_functions(const pe_base& pe);
+	//Array and function names are allocated from "resource", so it must outlive returned array
+	//If "names" is not null, function names are interned in it instead (pool must outlive returned array)
+	exported_functions_list get_exported_functions(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
 	//Returns array of exported functions and information about export
-	const exported_functions_list get_exported_functions(const pe_base& pe, export_info& info);
+	exported_functions_list get_exported_functions(const pe_base& pe, export_info& info, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
 
 	//Helper export functions
 	//Returns pair: <ordinal base for supplied functions; maximum ordinal value for supplied functions>
-	const std::pair<uint16_t, uint16_t> get_export_ordinal_limits(const exported_functions_list& exports);
+	std::pair<uint16_t, uint16_t> get_export_ordinal_limits(const exported_functions_list& exports);
 
 	//Checks if exported function name already exists
-	bool exported_name_exists(const std::string& function_name, const exported_functions_list& exports);
+	bool exported_name_exists(std::string_view function_name, const exported_functions_list& exports);
 
 	//Checks if exported function ordinal already exists
 	bool exported_ordinal_exists(uint16_t ordinal, const exported_functions_list& exports);
@@ -157,7 +186,11 @@ namespace pe_bliss
 	//number_of_functions and number_of_names parameters don't matter in "info" when rebuilding, they're calculated independently
 	//characteristics, major_version, minor_version, timestamp and name are the only used members of "info" structure
 	//Returns new export directory information
-	//exported_functions_list is copied intentionally to be sorted by ordinal values later
 	//Name ordinals in exported function don't matter, they will be recalculated
-	const image_directory rebuild_exports(pe_base& pe, const export_info& info, exported_functions_list exports, section& exports_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
+	image_directory rebuild_exports(pe_base& pe, const export_info& info, const exported_functions_list& exports, section& exports_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
+
+	//Linear-time export directory rebuilder for large export tables
+	//Parameters and resulting export directory layout are the same as for rebuild_exports,
+	//but names are sorted with MSD radix sort instead of comparison sort
+	image_directory rebuild_exports_linear(pe_base& pe, const export_info& info, const exported_functions_list& exports, section& exports_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
 }
@@ -11,6 +11,8 @@ namespace pe_bliss
 		//Creates pe_base class instance from PE or PE+ istream
 		//If read_bound_import_raw_data, raw bound import data will be read (used to get bound import info)
 		//If read_debug_raw_data, raw debug data will be read (used to get image debug info)
-		static pe_base create_pe(std::istream& file, bool read_debug_raw_data = true);
+		//Pass false to get advanced debug info later from file or file data only when needed (see get_debug_information)
+		//If read_overlay_data, overlay data will be read and held by image (written back by rebuild_pe)
+		static pe_base create_pe(std::istream& file, bool read_debug_raw_data = true, bool read_overlay_data = false);
 	};
 }
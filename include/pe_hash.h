@@ -0,0 +1,93 @@
+#pragma once
+#include <string>
+#include "stdint_defs.h"
+#include "pe_base.h"
+#include "pe_relocations.h"
+
+namespace pe_bliss
+{
+	//Interface of hash algorithm used by relocation-normalized hashing
+	//Implement it to use other hash algorithms
+	class hash_algorithm
+	{
+	public:
+		//Destructor
+		virtual ~hash_algorithm();
+
+		//Starts new hash
+		virtual void reset() = 0;
+		//Adds data to hash
+		virtual void update(const char* data, std::size_t length) = 0;
+		//Returns digest of hashed data (raw bytes)
+		virtual std::string finish() = 0;
+	};
+
+	//CRC-32 (IEEE 802.3), digest is 4 bytes (big-endian)
+	class crc32_hash : public hash_algorithm
+	{
+	public:
+		//Default constructor
+		crc32_hash();
+
+		virtual void reset();
+		virtual void update(const char* data, std::size_t length);
+		virtual std::string finish();
+
+	private:
+		uint32_t crc_;
+	};
+
+	//XXH64 (seed is zero), non-cryptographic hash running at memory bandwidth, digest is 8 bytes (big-endian)
+	class xxhash64_hash : public hash_algorithm
+	{
+	public:
+		//Default constructor
+		xxhash64_hash();
+
+		virtual void reset();
+		virtual void update(const char* data, std::size_t length);
+		virtual std::string finish();
+
+	private:
+		uint64_t state_[4];
+		uint64_t length_;
+		//Data, which does not fill whole stripe yet
+		unsigned char buffer_[32];
+		uint32_t buffer_size_;
+	};
+
+	//SHA-256, digest is 32 bytes
+	class sha256_hash : public hash_algorithm
+	{
+	public:
+		//Default constructor
+		sha256_hash();
+
+		virtual void reset();
+		virtual void update(const char* data, std::size_t length);
+		virtual std::string finish();
+
+	private:
+		//Processes 64-byte block
+		void process_block(const unsigned char* block);
+
+	private:
+		uint32_t state_[8];
+		uint64_t length_;
+		//Data, which does not fill whole block yet
+		unsigned char buffer_[64];
+		uint32_t buffer_size_;
+	};
+
+	//Adds data placed at RVA to hash, bytes of relocated values (see relocation_coverage) are hashed as zeros
+	//Data is not copied: relocated and not relocated ranges are found by coverage bitmap walk
+	//and passed to hash algorithm as they are (or as zeros)
+	void update_normalized_hash(hash_algorithm& hash, const char* data, std::size_t size, uint32_t rva, const relocation_coverage& coverage);
+
+	//Returns hash of section raw data, bytes of relocated values are hashed as zeros,
+	//so hash does not depend on image base, for which section is relocated
+	//Raw data after aligned virtual size of section is hashed as is
+	std::string get_normalized_section_hash(const section& s, uint32_t section_alignment, const relocation_coverage& coverage, hash_algorithm& hash);
+	//Returns hash of raw data of all image sections (in order of section table), bytes of relocated values are hashed as zeros
+	std::string get_normalized_image_hash(const pe_base& pe, const relocation_coverage& coverage, hash_algorithm& hash);
+}
@@ -1,23 +1,46 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <iterator>
+#include <string_view>
+#include <memory_resource>
 #include "pe_structures.h"
 #include "pe_directory.h"
 #include "pe_base.h"
+#include "pe_data_cursor.h"
+#include "name_pool.h"
 
 namespace pe_bliss
 {
 	//Class representing imported function
 	class imported_function
 	{
+	public:
+		//Name is allocated from memory resource of allocator (see get_imported_functions)
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
 	public:
 		//Default constructor
 		imported_function();
+		//Constructor with allocator
+		explicit imported_function(const allocator_type& allocator);
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		imported_function(const imported_function& other, const allocator_type& allocator);
+		imported_function(imported_function&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		imported_function(const imported_function& other) = default;
+		imported_function(imported_function&& other) noexcept = default;
+		imported_function& operator=(const imported_function& other) = default;
+		imported_function& operator=(imported_function&& other) = default;
 
 		//Returns true if imported function has name (and hint)
 		bool has_name() const;
-		//Returns name of function
-		const std::string& get_name() const;
+		//Returns name of function (null-terminated)
+		std::string_view get_name() const;
+		//Returns name of function as std::string
+		std::string get_name_string() const;
+		//Returns ID of function name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_name_id() const;
 		//Returns hint
 		uint16_t get_hint() const;
 		//Returns ordinal of function
@@ -29,7 +52,9 @@ namespace pe_bliss
 	public: //Setters do not change everything inside image, they are used by PE class
 		//You also can use them to rebuild image imports
 		//Sets name of function
-		void set_name(const std::string& name);
+		void set_name(std::string_view name);
+		//Sets name of function interned in pool
+		void set_name(std::string_view name, name_pool& pool);
 		//Sets hint
 		void set_hint(uint16_t hint);
 		//Sets ordinal
@@ -39,7 +64,7 @@ namespace pe_bliss
 		void set_iat_va(uint64_t rva);
 
 	private:
-		std::string name_; //Function name
+		pooled_name name_; //Function name
 		uint16_t hint_; //Hint
 		uint16_t ordinal_; //Ordinal
 		uint64_t iat_va_;
@@ -49,14 +74,30 @@ namespace pe_bliss
 	class import_library
 	{
 	public:
-		typedef std::vector<imported_function> imported_list;
+		typedef std::pmr::vector<imported_function> imported_list;
+		//Name and imported functions are allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
 
 	public:
 		//Default constructor
 		import_library();
+		//Constructor with allocator
+		explicit import_library(const allocator_type& allocator);
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		import_library(const import_library& other, const allocator_type& allocator);
+		import_library(import_library&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		import_library(const import_library& other) = default;
+		import_library(import_library&& other) noexcept = default;
+		import_library& operator=(const import_library& other) = default;
+		import_library& operator=(import_library&& other) = default;
 
-		//Returns name of library
-		const std::string& get_name() const;
+		//Returns name of library (null-terminated)
+		std::string_view get_name() const;
+		//Returns name of library as std::string
+		std::string get_name_string() const;
+		//Returns ID of library name inside name_pool or name_pool::no_id, if name is not interned
+		uint32_t get_name_id() const;
 		//Returns RVA to Import Address Table (IAT)
 		uint32_t get_rva_to_iat() const;
 		//Returns RVA to Original Import Address Table (Original IAT)
@@ -70,7 +111,9 @@ namespace pe_bliss
 	public: //Setters do not change everything inside image, they are used by PE class
 		//You also can use them to rebuild image imports
 		//Sets name of library
-		void set_name(const std::string& name);
+		void set_name(std::string_view name);
+		//Sets name of library interned in pool
+		void set_name(std::string_view name, name_pool& pool);
 		//Sets RVA to Import Address Table (IAT)
 		void set_rva_to_iat(uint32_t rva_to_iat);
 		//Sets RVA to Original Import Address Table (Original IAT)
@@ -80,11 +123,12 @@ namespace pe_bliss
 
 		//Adds imported function
 		void add_import(const imported_function& func);
+		void add_import(imported_function&& func);
 		//Clears imported functions list
 		void clear_imports();
 
 	private:
-		std::string name_; //Library name
+		pooled_name name_; //Library name
 		uint32_t rva_to_iat_; //RVA to IAT
 		uint32_t rva_to_original_iat_; //RVA to original IAT
 		uint32_t timestamp_; //DLL TimeStamp
@@ -129,6 +173,8 @@ namespace pe_bliss
 
 		//Returns true if the last section should be stripped automatically, if imports are inside it
 		bool auto_strip_last_section_enabled() const;
+		//Returns true if import directory will be rebuilt in compact mode
+		bool compact_mode_enabled() const;
 
 	public: //Setters
 		//Sets offset from section start where import directory data will be placed
@@ -151,6 +197,11 @@ namespace pe_bliss
 
 		//Sets if the last section should be stripped automatically, if imports are inside it, default true
 		void enable_auto_strip_last_section(bool enable);
+		//Sets if import directory will be rebuilt in compact mode, default false
+		//In compact mode equal library names and IMAGE_IMPORT_BY_NAME structures are written once,
+		//only thunk tables are aligned and exactly needed space is used, so directory can be placed to slack of existing section
+		//Section data after rebuilt directory is not truncated in compact mode
+		void enable_compact_mode(bool enable);
 
 	private:
 		uint32_t offset_from_section_start_;
@@ -161,15 +212,240 @@ namespace pe_bliss
 		bool zero_directory_entry_iat_;
 		bool rewrite_iat_and_original_iat_contents_;
 		bool auto_strip_last_section_;
+		bool compact_mode_;
 	};
 
-	typedef std::vector<import_library> imported_functions_list;
+	typedef std::pmr::vector<import_library> imported_functions_list;
 
 	//Returns imported functions list with related libraries info
-	const imported_functions_list get_imported_functions(const pe_base& pe);
+	//All lists and names are allocated from "resource" (for example, std::pmr::monotonic_buffer_resource
+	//to release everything at once), so it must outlive returned list
+	//If "names" is not null, library and function names are interned in it instead (pool must outlive returned list)
+	imported_functions_list get_imported_functions(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
 
 	template<typename PEClassType>
-	const imported_functions_list get_imported_functions_base(const pe_base& pe);
+	imported_functions_list get_imported_functions_base(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource(), name_pool* names = 0);
+
+	//Reads imported functions list of image with "cursor" and appends it to "imports" (see get_all_imports)
+	//Checks are the same as in get_imported_functions, names are allocated from memory resource of "imports" or interned in "names"
+	void read_imported_functions(pe_data_cursor& cursor, imported_functions_list& imports, name_pool* names = 0);
+
+	//Class representing imported function decoded on the fly from import thunks (see import_directory_view)
+	//Name is a view to image data, so image must not be changed or destroyed while it is used
+	class imported_function_view
+	{
+	public:
+		//Default constructor
+		imported_function_view();
+
+		//Returns true if imported function has name (and hint)
+		bool has_name() const;
+		//Returns name of function (null-terminated)
+		std::string_view get_name() const;
+		//Returns name of function as std::string
+		std::string get_name_string() const;
+		//Returns hint
+		uint16_t get_hint() const;
+		//Returns ordinal of function
+		uint16_t get_ordinal() const;
+		//Returns IAT entry VA
+		uint64_t get_iat_va() const;
+		//Returns RVA of IAT entry (thunk) of function
+		uint32_t get_iat_rva() const;
+
+	public: //These functions do not change everything inside image, they are used by import view
+		//Sets function data
+		void set(std::string_view name, uint16_t hint, uint16_t ordinal, uint64_t iat_va, uint32_t iat_rva);
+
+	private:
+		std::string_view name_;
+		uint16_t hint_;
+		uint16_t ordinal_;
+		uint64_t iat_va_;
+		uint32_t iat_rva_;
+	};
+
+	//Forward range of functions imported from one library, thunks are decoded while iterating
+	class imported_functions_view
+	{
+	public:
+		//Forward iterator over imported functions
+		class iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef imported_function_view value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const imported_function_view* pointer;
+			typedef const imported_function_view& reference;
+
+		public:
+			//Default constructor (end iterator)
+			iterator();
+			//Constructor from first thunks of library
+			iterator(const pe_base& pe, uint32_t thunk_rva, uint32_t original_thunk_rva);
+
+			reference operator*() const;
+			pointer operator->() const;
+			iterator& operator++();
+			iterator operator++(int);
+			bool operator==(const iterator& other) const;
+			bool operator!=(const iterator& other) const;
+
+		private:
+			//Decodes function at current thunk or reaches the end
+			void read();
+
+		private:
+			const pe_base* pe_;
+			uint32_t thunk_rva_;
+			uint32_t original_thunk_rva_;
+			imported_function_view func_;
+		};
+
+	public:
+		//Default constructor (empty range)
+		imported_functions_view();
+		//Constructor from first thunks of library (IAT is used as original IAT, if original_thunk_rva is zero)
+		imported_functions_view(const pe_base& pe, uint32_t thunk_rva, uint32_t original_thunk_rva);
+
+		iterator begin() const;
+		iterator end() const;
+
+	private:
+		const pe_base* pe_;
+		uint32_t thunk_rva_;
+		uint32_t original_thunk_rva_;
+	};
+
+	//Class representing imported library decoded on the fly from import descriptor (see import_directory_view)
+	//Name is a view to image data, so image must not be changed or destroyed while it is used
+	class import_library_view
+	{
+	public:
+		//Default constructor
+		import_library_view();
+
+		//Returns name of library (null-terminated)
+		std::string_view get_name() const;
+		//Returns name of library as std::string
+		std::string get_name_string() const;
+		//Returns RVA to Import Address Table (IAT)
+		uint32_t get_rva_to_iat() const;
+		//Returns RVA to Original Import Address Table (Original IAT)
+		uint32_t get_rva_to_original_iat() const;
+		//Returns timestamp
+		uint32_t get_timestamp() const;
+
+		//Returns range of imported functions, which are decoded while iterating
+		const imported_functions_view& get_imported_functions() const;
+
+	public: //These functions do not change everything inside image, they are used by import view
+		//Sets library data
+		void set(std::string_view name, const pe_win::image_import_descriptor& descriptor, const imported_functions_view& functions);
+
+	private:
+		std::string_view name_;
+		uint32_t rva_to_iat_;
+		uint32_t rva_to_original_iat_;
+		uint32_t timestamp_;
+		imported_functions_view functions_;
+	};
+
+	//Forward range of imported libraries, import descriptors are decoded while iterating
+	//Nothing is allocated, iteration can be stopped at any moment
+	//Descriptors, thunks and names are checked the same way as get_imported_functions does it, exceptions are thrown
+	//when incorrect data is reached, so parts of import directory, which were not iterated, are not checked
+	class import_directory_view
+	{
+	public:
+		//Forward iterator over imported libraries
+		class iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef import_library_view value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const import_library_view* pointer;
+			typedef const import_library_view& reference;
+
+		public:
+			//Default constructor (end iterator)
+			iterator();
+			//Constructor from the first import descriptor
+			explicit iterator(const pe_base& pe);
+
+			reference operator*() const;
+			pointer operator->() const;
+			iterator& operator++();
+			iterator operator++(int);
+			bool operator==(const iterator& other) const;
+			bool operator!=(const iterator& other) const;
+
+		private:
+			//Decodes library at current descriptor or reaches the end
+			void read();
+
+		private:
+			const pe_base* pe_;
+			uint32_t descriptor_pos_;
+			import_library_view lib_;
+		};
+
+	public:
+		//Constructor
+		explicit import_directory_view(const pe_base& pe);
+
+		iterator begin() const;
+		iterator end() const;
+
+	private:
+		const pe_base* pe_;
+	};
+
+	//Returns range of imported libraries, which are decoded from image while iterating
+	import_directory_view get_import_directory_view(const pe_base& pe);
+
+	//Class representing reverse index of import address table: IAT slot (thunk) RVA or VA -> imported function
+	//Index is built once from imported functions list and answers lookups in constant time:
+	//if IAT slots are placed densely (which is usual), direct lookup table is used, otherwise slots are binary searched
+	class iat_index
+	{
+	public:
+		//IAT slot record, indices refer to imported functions list index was built from
+		struct slot
+		{
+			uint32_t rva; //RVA of IAT slot
+			uint32_t library_index; //Index of library inside imported functions list
+			uint32_t function_index; //Index of function inside library imported functions list
+		};
+
+		typedef std::vector<slot> slot_list;
+
+	public:
+		//Default constructor (empty index)
+		iat_index();
+		//Builds index from imported functions list of image (as returned by get_imported_functions)
+		iat_index(const pe_base& pe, const imported_functions_list& imports);
+
+		//Returns IAT slot, which starts at RVA, or null, if there is no such slot
+		const slot* find_by_rva(uint32_t rva) const;
+		//Returns IAT slot, which starts at VA, or null, if there is no such slot
+		const slot* find_by_va(uint64_t va) const;
+
+		//Returns all IAT slots sorted by RVA
+		const slot_list& get_slots() const;
+		//Returns true if direct lookup table is used
+		bool is_dense() const;
+
+	private:
+		slot_list slots_;
+		//Direct lookup table: slot number (relative to the first slot) -> index of slot + 1 (or 0, if there is no slot)
+		std::vector<uint32_t> table_;
+		uint32_t first_rva_;
+		uint32_t slot_size_;
+		uint64_t image_base_;
+	};
 
 	//You can get all image imports with get_imported_functions() function
 	//You can use returned value to, for example, add new imported library with some functions
@@ -178,8 +454,31 @@ namespace pe_bliss
 	//Don't add new imported functions to existing imported library entries, because this can cause
 	//rewriting of some used memory (or other IAT/orig.IAT fields) by system loader
 	//The safest way is just adding import libraries with functions to the end of imported_functions_list array
-	const image_directory rebuild_imports(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings = import_rebuilder_settings());
+	image_directory rebuild_imports(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings = import_rebuilder_settings());
 
 	template<typename PEClassType>
-	const image_directory rebuild_imports_base(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings = import_rebuilder_settings());
+	image_directory rebuild_imports_base(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings = import_rebuilder_settings());
+
+	//Appends imported libraries to import directory without rebuilding it
+	//Existing import descriptors, IATs, original IATs and names are neither changed nor moved,
+	//new IATs (and original IATs, if build_original_iat is set) are always created for appended libraries
+	//New descriptors are written after existing ones, if there is unused zero space (slack) after the end of descriptor array,
+	//otherwise descriptor array is copied to import_section
+	//New thunk tables and names (library names and IMAGE_IMPORT_BY_NAME structures are deduplicated) are placed to import_section
+	//at offset_from_section_start, import_section data before and after them is kept
+	//Only offset_from_section_start, build_original_iat, auto_set_to_pe_headers, zero_directory_entry_iat
+	//and auto_strip_last_section settings are used
+	//Returns import descriptor array location
+	image_directory append_imports(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings = import_rebuilder_settings());
+
+	template<typename PEClassType>
+	image_directory append_imports_base(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings = import_rebuilder_settings());
+
+	//Searches for section, which has enough slack (unused zero space between the end of section virtual size
+	//and the end of its file-aligned raw data) to hold import directory rebuilt in compact mode
+	//If section is found, enables compact mode in import_settings, sets offset from section start and returns section,
+	//otherwise returns 0 (and import_settings are not changed), so new section should be added
+	//The smallest suitable slack is chosen. If found section is not writeable, zero IMAGE_DIRECTORY_ENTRY_IAT
+	//(zero_directory_entry_iat), so loader could change new IATs
+	section* find_import_section_slack(pe_base& pe, const imported_functions_list& imports, import_rebuilder_settings& import_settings);
 }
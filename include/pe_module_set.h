@@ -0,0 +1,174 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <memory_resource>
+#include "pe_base.h"
+#include "pe_imports.h"
+#include "pe_exports.h"
+#include "pe_bound_import.h"
+#include "name_pool.h"
+
+namespace pe_bliss
+{
+	//Status of symbol resolution
+	enum symbol_resolve_status
+	{
+		symbol_resolved,
+		symbol_module_not_found, //Module (imported library or forwarder target) is not in module set
+		symbol_not_found, //Module does not export symbol
+		symbol_forwarder_cycle //Forwarder chain is looped
+	};
+
+	//Symbol resolved against module set
+	//For forwarded exports, module and RVA of the final (not forwarded) export are set
+	struct resolved_symbol
+	{
+		symbol_resolve_status status;
+		uint32_t module_index; //Index of module inside module set (if resolved)
+		uint32_t rva; //RVA of exported symbol inside module (if resolved)
+		uint16_t ordinal; //Ordinal of exported symbol (if resolved)
+	};
+
+	//Imported function, which was not resolved
+	struct unresolved_import
+	{
+		uint32_t library_index; //Index of library inside imported functions list
+		uint32_t function_index; //Index of function inside library
+		symbol_resolve_status status;
+	};
+
+	typedef std::vector<unresolved_import> unresolved_import_list;
+
+	//Class representing result of binding imports of image against module set
+	class import_binding
+	{
+	public:
+		//Default constructor
+		import_binding();
+
+		//Returns resolved symbol of imported function
+		const resolved_symbol& get_symbol(std::size_t library_index, std::size_t function_index) const;
+		//Returns list of unresolved imports
+		const unresolved_import_list& get_unresolved() const;
+		//Returns true if all imports were resolved
+		bool all_resolved() const;
+
+	public: //These functions do not change everything inside image, they are used by module_set
+		//Starts next library
+		void add_library();
+		//Adds resolved symbol of next function of the last library
+		void add_symbol(const resolved_symbol& symbol);
+
+	private:
+		std::vector<resolved_symbol> symbols_;
+		//Index of the first symbol of each library
+		std::vector<uint32_t> library_offsets_;
+		unresolved_import_list unresolved_;
+	};
+
+	//Bound import module with outdated or unknown timestamp
+	struct stale_bound_import
+	{
+		std::string_view module_name; //Name from bound import list (must be alive while this structure is used)
+		uint32_t bound_timestamp; //Timestamp saved in bound import directory
+		uint32_t module_timestamp; //Actual timestamp of module (zero if module is not in module set)
+		bool module_found;
+	};
+
+	typedef std::vector<stale_bound_import> stale_bound_import_list;
+
+	//Class representing set of modules (DLLs), used to resolve imports like loader does
+	//Exported names and ordinals of each module are indexed in hash tables, forwarder chains
+	//(like "NTDLL.RtlAllocateHeap" or "NTDLL.#5") are resolved once and cached, loops are detected
+	//Module names are case-insensitive, ".dll" extension is assumed for names without extension
+	//Functions, which change set or resolve symbols, are not thread-safe,
+	//use bind_imports for list of images to bind them in parallel
+	class module_set
+	{
+	public:
+		//Value returned by find_module, if module is not found
+		static const std::size_t npos = static_cast<std::size_t>(-1);
+
+	public:
+		//Default constructor
+		module_set();
+
+		//Adds module with specified name, exports are read from image
+		//If module with the same name exists already, it is replaced
+		//Returns index of module
+		std::size_t add_module(std::string_view name, const pe_base& pe);
+		//Adds module with specified name, exports list and image timestamp
+		std::size_t add_module(std::string_view name, const exported_functions_list& exports, uint32_t timestamp);
+
+		//Returns index of module or npos, if module is not found
+		std::size_t find_module(std::string_view name) const;
+		//Returns number of modules
+		std::size_t get_module_count() const;
+		//Returns name of module (normalized: lower-case, with extension)
+		const std::string& get_module_name(std::size_t index) const;
+		//Returns timestamp of module image
+		uint32_t get_module_timestamp(std::size_t index) const;
+		//Returns exports of module
+		const exported_functions_list& get_module_exports(std::size_t index) const;
+
+		//Resolves symbol exported by name, following forwarders
+		resolved_symbol resolve(std::string_view module_name, std::string_view name);
+		//Resolves symbol exported by ordinal, following forwarders
+		resolved_symbol resolve(std::string_view module_name, uint16_t ordinal);
+
+		//Binds imports of image, resolving each imported function
+		import_binding bind_imports(const imported_functions_list& imports);
+		//Binds imports of several images in parallel
+		//max_threads - maximum number of binding threads (0 = hardware concurrency, 1 = bind in calling thread)
+		std::vector<import_binding> bind_imports(const std::vector<const imported_functions_list*>& images, uint32_t max_threads = 0);
+
+		//Checks bound import modules (and their forwarder references) timestamps against timestamps of modules
+		//Returns list of modules with outdated timestamps and modules, which are not in module set
+		stale_bound_import_list check_bound_imports(const bound_import_module_list& bound_imports) const;
+
+	private:
+		//Module information
+		struct module_entry
+		{
+			std::string name;
+			uint32_t timestamp;
+			exported_functions_list exports;
+			//Exported name -> index of export
+			std::unordered_map<std::string_view, uint32_t> names;
+			//Ordinal - ordinal_base -> index of export + 1 (zero, if ordinal is not exported)
+			std::vector<uint32_t> ordinals;
+			uint16_t ordinal_base;
+			//Resolved targets of forwarded exports (by index of export)
+			std::vector<resolved_symbol> forward_targets;
+
+			explicit module_entry(std::pmr::memory_resource* resource);
+		};
+
+		//Resolves all forwarders, if modules were changed
+		void prepare();
+		//Resolves forwarded export (states: 0 - not resolved, 1 - resolving now, 2 - resolved)
+		resolved_symbol resolve_forwarder(uint32_t module_index, uint32_t export_index, std::vector<std::vector<uint8_t> >& states);
+		//Returns index of export by name or ordinal, or -1, if not found
+		uint32_t find_export(const module_entry& module, std::string_view name) const;
+		uint32_t find_export(const module_entry& module, uint16_t ordinal) const;
+		//Returns resolved symbol for export (forwarders must be resolved already)
+		resolved_symbol get_export_symbol(uint32_t module_index, uint32_t export_index) const;
+		//Binds imports of image (forwarders must be resolved already)
+		import_binding bind_prepared_imports(const imported_functions_list& imports) const;
+
+	private:
+		//Exports and their names are allocated from this resource
+		std::pmr::unsynchronized_pool_resource resource_;
+		name_pool names_;
+		std::vector<module_entry> modules_;
+		//Normalized module name -> index of module
+		std::unordered_map<std::string, std::size_t> module_indexes_;
+		//True if forwarders are resolved for current set of modules
+		bool prepared_;
+
+		module_set(const module_set&);
+		module_set& operator=(const module_set&);
+	};
+}
@@ -1,11 +1,114 @@
 #pragma once
+#include <istream>
 #include <ostream>
+#include <string>
+#include <vector>
+#include "pe_structures.h"
+#ifndef PE_BLISS_WINDOWS
+#include <sys/uio.h>
+#endif
 
 namespace pe_bliss
 {
 	class pe_base;
+
+	//Class representing rebuilt PE image layout: list of data chunks, which form image file when written one after another
+	//Headers are held by this class, section and overlay data chunks point to data of image,
+	//so image must not be changed or destroyed while layout is used
+	class rebuilt_pe
+	{
+	public:
+		//Data chunk (data is null for zero padding chunks)
+		struct chunk
+		{
+			const char* data;
+			std::size_t size;
+			//True if chunk data is stored unchanged in the file image was read from, at source_offset
+			bool has_source;
+			uint32_t source_offset;
+		};
+
+		typedef std::vector<chunk> chunk_list;
+
+	public:
+		//Default constructor
+		rebuilt_pe();
+		//Copy constructor and assignment operator (chunks are rebased to copied headers)
+		rebuilt_pe(const rebuilt_pe& other);
+		rebuilt_pe& operator=(const rebuilt_pe& other);
+		//Move constructor and assignment operator (headers buffer is moved, so chunks stay valid)
+		rebuilt_pe(rebuilt_pe&& other) noexcept;
+		rebuilt_pe& operator=(rebuilt_pe&& other) noexcept;
+
+		//Returns exact size of rebuilt image
+		std::size_t get_size() const;
+		//Returns list of data chunks
+		const chunk_list& get_chunks() const;
+		//Returns file offset of data following the last section
+		uint32_t get_end_of_sections() const;
+
+		//Writes rebuilt image to contiguous buffer, which must be at least get_size() bytes long
+		void write_to(char* buffer, std::size_t buffer_size) const;
+		//Writes rebuilt image to ostream
+		void write_to(std::ostream& out) const;
+
+#ifndef PE_BLISS_WINDOWS
+		//Returns list of iovec structures to write rebuilt image with writev or pwritev
+		//Zero padding chunks point to static zero-filled memory and may be split into several iovecs
+		std::vector<iovec> get_iovecs() const;
+#endif
+
+	public: //These functions do not change everything inside image, they are used by PE rebuilder
+		//Returns headers buffer
+		std::vector<char>& get_headers();
+		//Appends headers buffer as data chunk
+		void add_headers();
+		//Appends data chunk
+		void add_data(const char* data, std::size_t size);
+		//Appends data chunk, which is stored unchanged in the file image was read from
+		void add_data(const char* data, std::size_t size, uint32_t source_offset);
+		//Appends zero padding chunk up to specified file offset (if it was not reached yet)
+		void add_padding(std::size_t offset);
+		//Sets file offset of data following the last section
+		void set_end_of_sections(uint32_t offset);
+
+	private:
+		std::vector<char> headers_;
+		chunk_list chunks_;
+		std::size_t size_;
+		uint32_t end_of_sections_;
+	};
+
+	//Rebuilds PE image and returns its layout without writing anything. If strip_dos_header == true, DOS header will be stripped a little
+	//If change_size_of_headers == true, SizeOfHeaders will be recalculated automatically
+	//If save_bound_import == true, existing bound import directory will be saved correctly (because some compilers and bind.exe put it to PE headers)
+	//If image holds overlay data (see pe_base::get_overlay_data), it is placed after the last section
+	rebuilt_pe rebuild_pe_layout(pe_base& pe, bool strip_dos_header = false, bool change_size_of_headers = true, bool save_bound_import = true);
+
 	//Rebuilds PE image, writes resulting image to ostream "out". If strip_dos_header == true, DOS header will be stripped a little
 	//If change_size_of_headers == true, SizeOfHeaders will be recalculated automatically
 	//If save_bound_import == true, existing bound import directory will be saved correctly (because some compilers and bind.exe put it to PE headers)
+	//If image holds overlay data (see pe_base::get_overlay_data), it is written after the last section
 	void rebuild_pe(pe_base& pe, std::ostream& out, bool strip_dos_header = false, bool change_size_of_headers = true, bool save_bound_import = true);
+
+	//Rebuilds PE image the same way, but copies overlay data (if it is not held by image) by chunks from "overlay_source",
+	//which is the file image was read from
+	//Overlay is placed after the last section (file-aligned), security directory is moved together with it in rebuilt image
+	//(image keeps overlay offset and security directory of the source file, so it may be rebuilt from the same source again)
+	void rebuild_pe(pe_base& pe, std::ostream& out, std::istream& overlay_source, bool strip_dos_header = false, bool change_size_of_headers = true, bool save_bound_import = true);
+
+#ifndef PE_BLISS_WINDOWS
+	//Rebuilds PE image the same way and writes it to regular file "out_fd" (from its beginning, file is truncated to image size)
+	//"source_fd" is the file image was read from: raw data of sections, which were not accessed for writing since loading,
+	//and overlay data (if it is not held by image) are copied from it inside the kernel (copy_file_range, where available),
+	//only headers and changed sections are written from memory
+	void rebuild_pe(pe_base& pe, int out_fd, int source_fd, bool strip_dos_header = false, bool change_size_of_headers = true, bool save_bound_import = true);
+
+	//Writes changes of image back to file "fd" image was read from, without rebuilding it
+	//Image layout (headers placement, section table, section raw data placement and sizes) must not be changed,
+	//otherwise exception is thrown and nothing is written
+	//Only changed header bytes, dirty ranges of sections (see pe_base::patch_section_data) and sections,
+	//which were accessed for writing as a whole, are written. Overlay is not written
+	void commit_inplace(pe_base& pe, int fd);
+#endif
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <vector>
+#include <iterator>
+#include <memory_resource>
 #include "pe_structures.h"
 #include "pe_base.h"
 #include "pe_directory.h"
@@ -47,13 +49,26 @@ namespace pe_bliss
 	class relocation_table
 	{
 	public:
-		typedef std::vector<relocation_entry> relocation_list;
+		typedef std::pmr::vector<relocation_entry> relocation_list;
+		//Relocation list is allocated from memory resource of allocator (see get_relocations)
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
 
 	public:
 		//Default constructor
 		relocation_table();
 		//Constructor from RVA of relocation table
 		explicit relocation_table(uint32_t rva);
+		//Constructors with allocator
+		explicit relocation_table(const allocator_type& allocator);
+		relocation_table(uint32_t rva, const allocator_type& allocator);
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		relocation_table(const relocation_table& other, const allocator_type& allocator);
+		relocation_table(relocation_table&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		relocation_table(const relocation_table& other) = default;
+		relocation_table(relocation_table&& other) noexcept = default;
+		relocation_table& operator=(const relocation_table& other) = default;
+		relocation_table& operator=(relocation_table&& other) = default;
 
 		//Returns relocation list
 		const relocation_list& get_relocations() const;
@@ -75,11 +90,192 @@ namespace pe_bliss
 		relocation_list relocations_;
 	};
 
-	typedef std::vector<relocation_table> relocation_table_list;
+	typedef std::pmr::vector<relocation_table> relocation_table_list;
 
 	//Get relocation list of pe file, supports one-word sized relocations only
 	//If list_absolute_entries = true, IMAGE_REL_BASED_ABSOLUTE will be listed
-	const relocation_table_list get_relocations(const pe_base& pe, bool list_absolute_entries = false);
+	//All tables are allocated from "resource", so it must outlive returned list
+	relocation_table_list get_relocations(const pe_base& pe, bool list_absolute_entries = false, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	//Range of relocation entries of one page of packed_relocations
+	//Entries are decoded from raw relocation words while iterating
+	class packed_relocation_page
+	{
+	public:
+		//Input iterator over relocation entries (entries are decoded and returned by value)
+		class iterator
+		{
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef relocation_entry value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef void pointer;
+			typedef relocation_entry reference;
+
+		public:
+			//Default constructor
+			iterator();
+			//Constructor from raw relocation word
+			explicit iterator(const uint16_t* item);
+
+			reference operator*() const;
+			iterator& operator++();
+			iterator operator++(int);
+			bool operator==(const iterator& other) const;
+			bool operator!=(const iterator& other) const;
+
+		private:
+			const uint16_t* item_;
+		};
+
+	public:
+		//Default constructor (empty page)
+		packed_relocation_page();
+		//Constructor from RVA of page and its raw relocation words
+		packed_relocation_page(uint32_t rva, const uint16_t* items, std::size_t count);
+
+		//Returns RVA of page
+		uint32_t get_rva() const;
+		//Returns number of relocation words (including IMAGE_REL_BASED_ABSOLUTE ones)
+		std::size_t size() const;
+		//Returns true if page has no relocation words
+		bool empty() const;
+		//Returns relocation entry by index
+		relocation_entry operator[](std::size_t index) const;
+		//Returns raw relocation words (type | offset)
+		const uint16_t* get_items() const;
+
+		iterator begin() const;
+		iterator end() const;
+
+	private:
+		uint32_t rva_;
+		const uint16_t* items_;
+		std::size_t count_;
+	};
+
+	//Class representing relocations stored in their raw form: 16-bit (type | offset) words of all
+	//pages are kept in a single array exactly as in relocation directory, pages are indexed by first word
+	//Takes about half of relocation_table_list memory and needs no allocations per page
+	class packed_relocations
+	{
+	public:
+		//Words and pages index are allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+	public:
+		//Default constructor
+		packed_relocations();
+		//Constructor with allocator
+		explicit packed_relocations(const allocator_type& allocator);
+		//Constructor from relocation tables
+		//Tables must be read with list_absolute_entries = true to keep parameters of IMAGE_REL_BASED_HIGHADJ relocations
+		explicit packed_relocations(const relocation_table_list& tables, const allocator_type& allocator = allocator_type());
+
+		//Returns number of pages (relocation tables)
+		std::size_t get_page_count() const;
+		//Returns page by index
+		packed_relocation_page get_page(std::size_t index) const;
+		//Returns total number of relocation words (including IMAGE_REL_BASED_ABSOLUTE ones)
+		std::size_t get_item_count() const;
+
+		//Converts packed relocations to relocation tables
+		//If list_absolute_entries = true, IMAGE_REL_BASED_ABSOLUTE will be listed
+		//All tables are allocated from "resource", so it must outlive returned list
+		relocation_table_list to_relocation_tables(bool list_absolute_entries = false, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const;
+
+	public: //These functions do not change everything inside image, they are used by get_packed_relocations
+		//Adds page with raw relocation words
+		void add_page(uint32_t rva, const uint16_t* items, std::size_t count);
+		//Adds raw relocation words to the last page
+		void add_items(const uint16_t* items, std::size_t count);
+		//Reserves space for relocation words
+		void reserve_items(std::size_t count);
+
+	private:
+		//Page index entry
+		struct page_info
+		{
+			uint32_t rva;
+			uint32_t first_item;
+		};
+
+		std::pmr::vector<uint16_t> items_;
+		std::pmr::vector<page_info> pages_;
+	};
+
+	//Get relocations of pe file in packed form
+	//Relocation directory is checked the same way as get_relocations does it, all words are kept
+	//All data is allocated from "resource", so it must outlive returned value
+	packed_relocations get_packed_relocations(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	//Class representing image RVA space coverage by base relocations
+	//Two bitmaps with byte granularity are kept: starts of relocated values and all bytes of relocated values,
+	//each of them has rank index, so point and range queries take constant time
+	//Sizes of relocated values: HIGH, LOW and HIGHADJ - 2 bytes, DIR64 - 8 bytes, other types - 4 bytes
+	//Relocated values, which do not fit into image, are ignored
+	class relocation_coverage
+	{
+	public:
+		//Default constructor (empty image)
+		relocation_coverage();
+		//Constructor from image (relocations are read by get_packed_relocations)
+		explicit relocation_coverage(const pe_base& pe);
+		//Constructor from relocations and image size (SizeOfImage)
+		relocation_coverage(const packed_relocations& relocs, uint32_t image_size);
+
+		//Returns size of covered RVA space
+		uint32_t get_image_size() const;
+		//Returns number of relocated values
+		std::size_t get_relocation_count() const;
+
+		//Returns true if relocated value starts at RVA
+		bool is_relocation_start(uint32_t rva) const;
+		//Returns true if byte at RVA belongs to relocated value
+		bool is_relocated(uint32_t rva) const;
+		//Returns true if any byte of range belongs to relocated value
+		bool intersects(uint32_t rva, uint32_t size) const;
+		//Returns number of relocated values starting inside range
+		std::size_t count_relocations(uint32_t rva, uint32_t size) const;
+
+		//Returns RVA of the first relocated byte inside [rva, end_rva) or end_rva, if there's no such byte
+		uint32_t find_relocated(uint32_t rva, uint32_t end_rva) const;
+		//Returns RVA of the first not relocated byte inside [rva, end_rva) or end_rva, if there's no such byte
+		uint32_t find_not_relocated(uint32_t rva, uint32_t end_rva) const;
+
+		//Appends RVAs of relocated values starting inside range to "rvas" (in ascending order)
+		void get_relocation_rvas(uint32_t rva, uint32_t size, std::vector<uint32_t>& rvas) const;
+		//Appends RVAs of relocated values starting inside section "s" to "rvas" (in ascending order)
+		void get_relocation_rvas(const section& s, uint32_t section_alignment, std::vector<uint32_t>& rvas) const;
+
+	private:
+		//Bitmap with rank index
+		struct rank_bitmap
+		{
+			std::vector<uint64_t> words;
+			//Number of set bits before each block of words
+			std::vector<uint32_t> ranks;
+
+			//Builds rank index
+			void build_ranks();
+			//Returns number of set bits before bit
+			std::size_t rank(uint32_t bit) const;
+			//Returns bit value
+			bool test(uint32_t bit) const;
+		};
+
+		//Marks relocated value
+		void add_relocation(uint32_t rva, uint32_t size);
+		//Returns number of set bits in range of bitmap
+		std::size_t count_bits(const rank_bitmap& bitmap, uint32_t rva, uint32_t size) const;
+		//Returns position of the first bit with value "set" of covered bytes bitmap inside [rva, end_rva) or end_rva
+		uint32_t find_covered_bit(uint32_t rva, uint32_t end_rva, bool set) const;
+
+	private:
+		uint32_t image_size_;
+		rank_bitmap starts_;
+		rank_bitmap covered_;
+	};
 
 	//Simple relocations rebuilder
 	//To keep PE file working, don't remove any of existing relocations in
@@ -87,7 +283,22 @@ namespace pe_bliss
 	//auto_strip_last_section - if true and relocations are placed in the last section, it will be automatically stripped
 	//offset_from_section_start - offset from the beginning of reloc_section, where relocations data will be situated
 	//If save_to_pe_header is true, PE header will be modified automatically
-	const image_directory rebuild_relocations(pe_base& pe, const relocation_table_list& relocs, section& reloc_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
+	image_directory rebuild_relocations(pe_base& pe, const relocation_table_list& relocs, section& reloc_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
+
+	//Adds relocation to relocation directory of image, changing only the block of relocation page, if possible
+	//Free IMAGE_REL_BASED_ABSOLUTE entries of the block are used first, then the block is grown (or new block is added)
+	//using zero-filled space after the directory, which is not used by section (after its virtual size)
+	//If there's no such space, the directory is rebuilt at its place (like rebuild_relocations does it), if the grown
+	//directory overwrites only such space inside of section. Otherwise, the directory is rebuilt after the data
+	//of its section, if the section is the last one, or pe_exception (insufficient_space) is thrown
+	//param - low word of value for IMAGE_REL_BASED_HIGHADJ relocation (it takes two entries)
+	//If relocation at RVA exists already, it is replaced
+	//Returns true if the directory was changed in place, false if it was rebuilt
+	bool add_relocation(pe_base& pe, uint32_t rva, uint16_t type, uint16_t param = 0);
+
+	//Removes relocation from relocation directory of image, replacing its entry with IMAGE_REL_BASED_ABSOLUTE one
+	//Returns false if there's no relocation at RVA
+	bool remove_relocation(pe_base& pe, uint32_t rva);
 
 	//Recalculates image base with the help of relocation tables
 	//Recalculates VAs of DWORDS/QWORDS in image according to relocations
@@ -98,4 +309,75 @@ namespace pe_bliss
 
 	template<typename PEClassType>
 	void rebase_image_base(pe_base& pe, const relocation_table_list& tables, uint64_t new_base);
+
+	//High-throughput version of rebase_image for images with many relocations
+	//Each relocation page is resolved to section raw data once, contiguous runs of HIGHLOW and DIR64
+	//relocations are patched in tight loops, and pages are processed in parallel
+	//HIGH, LOW, HIGHADJ, HIGHLOW and DIR64 relocations are supported, other types (except ABSOLUTE) cause an exception
+	//Raw relocation words are used (see get_packed_relocations), so HIGHADJ parameter is always the next word of page
+	//Pages must not relocate the same bytes twice, if they are rebased in parallel
+	//max_threads - maximum number of rebasing threads (0 = hardware concurrency, 1 = rebase in calling thread)
+	void rebase_image_fast(pe_base& pe, const packed_relocations& relocs, uint64_t new_base, uint32_t max_threads = 0);
+
+	//Class representing relocations of image resolved once for repeated rebasing (for example, to generate many ASLR variants)
+	//Relocations are resolved to (section, offset, type) slots and contiguous HIGHLOW and DIR64 values are merged into runs,
+	//so each rebase is a single pass over slots without parsing relocation directory or looking up sections
+	//Relocations are checked when they are prepared, exceptions are the same as rebase_image_fast throws
+	class prepared_rebase
+	{
+	public:
+		//Default constructor (no relocations)
+		prepared_rebase();
+		//Prepares relocations of image (they are read by get_packed_relocations)
+		explicit prepared_rebase(const pe_base& pe);
+		//Prepares relocations of image
+		prepared_rebase(const pe_base& pe, const packed_relocations& relocs);
+
+		//Returns image base of prepared image
+		uint64_t get_image_base() const;
+		//Returns number of relocated values
+		std::size_t get_relocation_count() const;
+
+		//Rebases image to new base, image must have the same sections layout as prepared one
+		//(usually it is a copy of prepared image, which shares unchanged data with it)
+		//Current image base of "pe" is used to calculate delta
+		void apply(pe_base& pe, uint64_t new_base) const;
+		//Rebases image mapped to memory (data at RVA is placed at image + RVA)
+		//image_size - size of buffer, current_base - image base, for which image data is relocated now
+		void apply(char* image, std::size_t image_size, uint64_t current_base, uint64_t new_base) const;
+
+	private:
+		//Resolved relocation
+		struct rebase_slot
+		{
+			uint32_t rva;
+			uint16_t type;
+			//Number of values in run for HIGHLOW and DIR64, low word of value for HIGHADJ
+			uint16_t param;
+		};
+
+		//Headers or section, which contains relocated values
+		struct rebase_target
+		{
+			bool headers;
+			uint32_t section_index;
+			uint32_t rva;
+			//Raw data size needed for all relocated values of region
+			uint32_t needed_size;
+			//Index of the first slot (slots of region end at the first slot of the next region)
+			uint32_t first_slot;
+		};
+
+		//Applies slots of region to its data
+		void apply_slots(char* data, uint32_t data_rva, std::size_t target_index, uint64_t delta) const;
+
+	private:
+		uint64_t image_base_;
+		std::size_t relocation_count_;
+		std::size_t section_count_;
+		//End RVA of the last relocated value
+		uint32_t max_rva_;
+		std::vector<rebase_slot> slots_;
+		std::vector<rebase_target> targets_;
+	};
 }
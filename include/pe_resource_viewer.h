@@ -52,20 +52,20 @@ namespace pe_bliss
 		const resource_directory& get_root_directory() const;
 
 		//Lists resource types existing in PE file (non-named only)
-		const resource_type_list list_resource_types() const;
+		resource_type_list list_resource_types() const;
 		//Returns true if resource type exists
 		bool resource_exists(resource_type type) const;
 		//Returns true if resource name exists
 		bool resource_exists(const std::wstring& root_name) const;
 
 		//Lists resource names existing in PE file by resource type
-		const resource_name_list list_resource_names(resource_type type) const;
+		resource_name_list list_resource_names(resource_type type) const;
 		//Lists resource names existing in PE file by resource name
-		const resource_name_list list_resource_names(const std::wstring& root_name) const;
+		resource_name_list list_resource_names(const std::wstring& root_name) const;
 		//Lists resource IDs existing in PE file by resource type
-		const resource_id_list list_resource_ids(resource_type type) const;
+		resource_id_list list_resource_ids(resource_type type) const;
 		//Lists resource IDs existing in PE file by resource name
-		const resource_id_list list_resource_ids(const std::wstring& root_name) const;
+		resource_id_list list_resource_ids(const std::wstring& root_name) const;
 		//Returns resource count by type
 		unsigned long get_resource_count(resource_type type) const;
 		//Returns resource count by name
@@ -80,39 +80,39 @@ namespace pe_bliss
 		//Returns language count of resource by resource name and ID
 		unsigned long get_language_count(const std::wstring& root_name, uint32_t id) const;
 		//Lists resource languages by resource type and name
-		const resource_language_list list_resource_languages(resource_type type, const std::wstring& name) const;
+		resource_language_list list_resource_languages(resource_type type, const std::wstring& name) const;
 		//Lists resource languages by resource names
-		const resource_language_list list_resource_languages(const std::wstring& root_name, const std::wstring& name) const;
+		resource_language_list list_resource_languages(const std::wstring& root_name, const std::wstring& name) const;
 		//Lists resource languages by resource type and ID
-		const resource_language_list list_resource_languages(resource_type type, uint32_t id) const;
+		resource_language_list list_resource_languages(resource_type type, uint32_t id) const;
 		//Lists resource languages by resource name and ID
-		const resource_language_list list_resource_languages(const std::wstring& root_name, uint32_t id) const;
+		resource_language_list list_resource_languages(const std::wstring& root_name, uint32_t id) const;
 
 		//Returns raw resource data by type, name and language
-		const resource_data_info get_resource_data_by_name(uint32_t language, resource_type type, const std::wstring& name) const;
+		resource_data_info get_resource_data_by_name(uint32_t language, resource_type type, const std::wstring& name) const;
 		//Returns raw resource data by root name, name and language
-		const resource_data_info get_resource_data_by_name(uint32_t language, const std::wstring& root_name, const std::wstring& name) const;
+		resource_data_info get_resource_data_by_name(uint32_t language, const std::wstring& root_name, const std::wstring& name) const;
 		//Returns raw resource data by type, ID and language
-		const resource_data_info get_resource_data_by_id(uint32_t language, resource_type type, uint32_t id) const;
+		resource_data_info get_resource_data_by_id(uint32_t language, resource_type type, uint32_t id) const;
 		//Returns raw resource data by root name, ID and language
-		const resource_data_info get_resource_data_by_id(uint32_t language, const std::wstring& root_name, uint32_t id) const;
+		resource_data_info get_resource_data_by_id(uint32_t language, const std::wstring& root_name, uint32_t id) const;
 		//Returns raw resource data by type, name and index in language directory (instead of language)
-		const resource_data_info get_resource_data_by_name(resource_type type, const std::wstring& name, uint32_t index = 0) const;
+		resource_data_info get_resource_data_by_name(resource_type type, const std::wstring& name, uint32_t index = 0) const;
 		//Returns raw resource data by root name, name and index in language directory (instead of language)
-		const resource_data_info get_resource_data_by_name(const std::wstring& root_name, const std::wstring& name, uint32_t index = 0) const;
+		resource_data_info get_resource_data_by_name(const std::wstring& root_name, const std::wstring& name, uint32_t index = 0) const;
 		//Returns raw resource data by type, ID and index in language directory (instead of language)
-		const resource_data_info get_resource_data_by_id(resource_type type, uint32_t id, uint32_t index = 0) const;
+		resource_data_info get_resource_data_by_id(resource_type type, uint32_t id, uint32_t index = 0) const;
 		//Returns raw resource data by root name, ID and index in language directory (instead of language)
-		const resource_data_info get_resource_data_by_id(const std::wstring& root_name, uint32_t id, uint32_t index = 0) const;
+		resource_data_info get_resource_data_by_id(const std::wstring& root_name, uint32_t id, uint32_t index = 0) const;
 
 	protected:
 		//Root resource directory. We're not copying it, because it might be heavy
 		const resource_directory& root_dir_;
 
 		//Helper function to get ID list from entry list
-		static const resource_id_list get_id_list(const resource_directory::entry_list& entries);
+		static resource_id_list get_id_list(const resource_directory::entry_list& entries);
 		//Helper function to get name list from entry list
-		static const resource_name_list get_name_list(const resource_directory::entry_list& entries);
+		static resource_name_list get_name_list(const resource_directory::entry_list& entries);
 
 	protected:
 		//Helper structure - finder of resource_directory_entry that is named
@@ -2,6 +2,7 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <memory_resource>
 #include "pe_structures.h"
 #include "pe_base.h"
 #include "pe_directory.h"
@@ -16,6 +17,7 @@ namespace pe_bliss
 		resource_data_entry();
 		//Constructor from data
 		resource_data_entry(const std::string& data, uint32_t codepage);
+		resource_data_entry(std::string&& data, uint32_t codepage);
 
 		//Returns resource data codepage
 		uint32_t get_codepage() const;
@@ -29,6 +31,7 @@ namespace pe_bliss
 		void set_codepage(uint32_t codepage);
 		//Sets resource data
 		void set_data(const std::string& data);
+		void set_data(std::string&& data);
 
 	private:
 		uint32_t codepage_; //Resource data codepage
@@ -41,13 +44,27 @@ namespace pe_bliss
 	//Class representing resource directory entry
 	class resource_directory_entry
 	{
+	public:
+		//Included data or directory is allocated from memory resource of allocator (see get_resources)
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
 	public:
 		//Default constructor
 		resource_directory_entry();
+		//Constructor with allocator
+		explicit resource_directory_entry(const allocator_type& allocator);
 		//Copy constructor
 		resource_directory_entry(const resource_directory_entry& other);
+		//Allocator-extended copy constructor
+		resource_directory_entry(const resource_directory_entry& other, const allocator_type& allocator);
 		//Copy assignment operator
 		resource_directory_entry& operator=(const resource_directory_entry& other);
+		//Move constructor (included data or directory is not copied)
+		resource_directory_entry(resource_directory_entry&& other) noexcept;
+		//Allocator-extended move constructor (included data or directory is copied, if allocators are not equal)
+		resource_directory_entry(resource_directory_entry&& other, const allocator_type& allocator);
+		//Move assignment operator (included data or directory is copied, if allocators are not equal)
+		resource_directory_entry& operator=(resource_directory_entry&& other);
 
 		//Returns entry ID
 		uint32_t get_id() const;
@@ -83,14 +100,19 @@ namespace pe_bliss
 
 		//Adds resource_data_entry
 		void add_data_entry(const resource_data_entry& entry);
+		void add_data_entry(resource_data_entry&& entry);
 		//Adds resource_directory
 		void add_resource_directory(const resource_directory& dir);
+		void add_resource_directory(resource_directory&& dir);
 
 	private:
+		//Copies included data or directory of other entry
+		void copy_included(const resource_directory_entry& other);
 		//Destroys included data
 		void release();
 
 	private:
+		allocator_type allocator_;
 		uint32_t id_;
 		std::wstring name_;
 
@@ -113,13 +135,26 @@ namespace pe_bliss
 	class resource_directory
 	{
 	public:
-		typedef std::vector<resource_directory_entry> entry_list;
+		typedef std::pmr::vector<resource_directory_entry> entry_list;
+		//Entries are allocated from memory resource of allocator
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
 
 	public:
 		//Default constructor
 		resource_directory();
 		//Constructor from data
 		explicit resource_directory(const pe_win::image_resource_directory& dir);
+		//Constructors with allocator
+		explicit resource_directory(const allocator_type& allocator);
+		resource_directory(const pe_win::image_resource_directory& dir, const allocator_type& allocator);
+		//Allocator-extended copy and move constructors (used by std::pmr containers)
+		resource_directory(const resource_directory& other, const allocator_type& allocator);
+		resource_directory(resource_directory&& other, const allocator_type& allocator);
+		//Copy and move constructors and assignment operators
+		resource_directory(const resource_directory& other) = default;
+		resource_directory(resource_directory&& other) noexcept = default;
+		resource_directory& operator=(const resource_directory& other) = default;
+		resource_directory& operator=(resource_directory&& other) = default;
 
 		//Returns characteristics of directory
 		uint32_t get_characteristics() const;
@@ -145,6 +180,7 @@ namespace pe_bliss
 
 		//Adds resource_directory_entry
 		void add_resource_directory_entry(const resource_directory_entry& entry);
+		void add_resource_directory_entry(resource_directory_entry&& entry);
 		//Clears resource_directory_entry array
 		void clear_resource_directory_entry_list();
 
@@ -210,7 +246,8 @@ namespace pe_bliss
 	};
 
 	//Returns resources (root resource_directory) from PE file
-	const resource_directory get_resources(const pe_base& pe);
+	//Directory tree is allocated from "resource", so it must outlive returned directory
+	resource_directory get_resources(const pe_base& pe, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 	//Resources rebuilder
 	//resource_directory - root resource directory
@@ -220,5 +257,5 @@ namespace pe_bliss
 	//save_to_pe_headers - if true, new resource directory information will be saved to PE image headers
 	//auto_strip_last_section - if true and resources are placed in the last section, it will be automatically stripped
 	//number_of_id_entries and number_of_named_entries for resource directories are recalculated and not used
-	const image_directory rebuild_resources(pe_base& pe, resource_directory& info, section& resources_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
+	image_directory rebuild_resources(pe_base& pe, resource_directory& info, section& resources_section, uint32_t offset_from_section_start = 0, bool save_to_pe_header = true, bool auto_strip_last_section = true);
 }
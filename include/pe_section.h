@@ -1,7 +1,11 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <utility>
+#include <memory>
+#include <mutex>
 #include "pe_structures.h"
+#include "shared_data.h"
 
 namespace pe_bliss
 {
@@ -18,12 +22,19 @@ namespace pe_bliss
 	public:
 		//Default constructor
 		section();
+		//Copy constructor and assignment operator
+		//Raw data is shared with copy, unless reference to it was handed out by non-const get_raw_data or get_virtual_data
+		section(const section& other);
+		section& operator=(const section& other);
+		//Move constructor and assignment operator
+		section(section&& other) noexcept = default;
+		section& operator=(section&& other) noexcept = default;
 
 		//Sets the name of section (stripped to 8 characters)
 		void set_name(const std::string& name);
 
 		//Returns the name of section
-		const std::string get_name() const;
+		std::string get_name() const;
 
 		//Changes attributes of section
 		section& readable(bool readable);
@@ -43,12 +54,18 @@ namespace pe_bliss
 		bool empty() const;
 
 		//Returns raw section data from file image
+		//Raw data stops being shared with copies of section: copies made later get their own data,
+		//so changes made through returned reference are not visible in them
 		std::string& get_raw_data();
 		//Returns raw section data from file image
 		const std::string& get_raw_data() const;
-		//Returns mapped virtual section data
+		//Returns mapped virtual section data (raw data followed by zeros up to aligned virtual size)
+		//Raw data is not changed: if it is shorter than virtual data, zero-padded copy is created once
+		//and shared between section copies, which share raw data
+		//If reference to raw data was handed out by non-const accessors, raw data is mapped in place instead
 		const std::string& get_virtual_data(uint32_t section_alignment) const;
 		//Returns mapped virtual section data
+		//Raw data stops being shared with copies of section, as for non-const get_raw_data
 		std::string& get_virtual_data(uint32_t section_alignment);
 
 	public: //Header getters
@@ -81,6 +98,10 @@ namespace pe_bliss
 		void set_characteristics(uint32_t characteristics);
 		//Sets raw section data from file image
 		void set_raw_data(const std::string& data);
+		void set_raw_data(std::string&& data);
+		//Writes data to raw section data at offset (data must fit into existing raw data)
+		//Only written bytes are marked changed (see get_dirty_ranges)
+		void patch_raw_data(uint32_t offset, const char* data, uint32_t size);
 
 	public: //Setters, be careful
 		//Sets section virtual size (doesn't set internal aligned virtual size, changes only header value)
@@ -91,6 +112,30 @@ namespace pe_bliss
 		//Returns raw image section header
 		pe_win::image_section_header& get_raw_header();
 
+	public: //These functions do not change everything inside image, they are used by PE class
+		typedef std::vector<std::pair<uint32_t, uint32_t> > dirty_range_list;
+
+		//Returns true if section raw data was read from file
+		bool has_source() const;
+		//Returns true if section raw data was not changed since it was read from file
+		bool raw_data_unchanged() const;
+		//Returns true if section raw data was accessed for writing as a whole since it was read from file
+		//Otherwise only dirty ranges were changed
+		bool raw_data_rewritten() const;
+		//Returns list of raw data ranges (offset, size) changed by patch_raw_data, ranges may overlap
+		const dirty_range_list& get_dirty_ranges() const;
+		//Returns offset of section raw data in the file image was read from
+		uint32_t get_source_offset() const;
+		//Returns size of section raw data in the file image was read from
+		uint32_t get_source_size() const;
+		//Sets offset of section raw data in the file image was read from and marks raw data unchanged
+		void set_source_offset(uint32_t offset);
+		//Returns size of mapped virtual section data
+		uint32_t get_virtual_data_size(uint32_t section_alignment) const;
+		//Copies data from offset of mapped virtual section data (tail after raw data is read as zeros, nothing is mapped)
+		//Returns false if data is out of mapped virtual section data
+		bool read_virtual_data(uint32_t section_alignment, uint32_t offset, char* data, uint32_t size) const;
+
 	private:
 		//Section header
 		pe_win::image_section_header header_;
@@ -101,14 +146,38 @@ namespace pe_bliss
 		//Unmaps virtual section data
 		void unmap_virtual() const;
 
+		//Called before raw data is changed, drops zero-padded copies of old raw data
+		void reset_virtual_data();
+
 		//Set flag (attribute) of section
 		section& set_flag(uint32_t flag, bool setflag);
 
 		//Old size of section (stored after mapping of virtual section memory)
 		mutable std::size_t old_size_;
 
-		//Section raw/virtual data
-		mutable std::string raw_data_;
+		//Section raw/virtual data (shared between section copies until first write)
+		mutable shared_data<std::string> raw_data_;
+
+		//Zero-padded copies of raw data (by size) returned by const get_virtual_data
+		//Copies are never changed or removed while raw data is unchanged, so pointers to them remain valid
+		struct virtual_data_cache
+		{
+			std::mutex lock;
+			std::vector<std::unique_ptr<const std::string> > data;
+		};
+
+		//Shared between section copies, which share raw data, replaced when raw data is changed
+		mutable std::shared_ptr<virtual_data_cache> virtual_data_;
+
+		//Offset and size of raw data in the file image was read from
+		uint32_t source_offset_;
+		uint32_t source_size_;
+		//True if raw data was read from file
+		bool has_source_;
+		//True if raw data was not accessed for writing since it was read from file
+		bool raw_data_unchanged_;
+		//Raw data ranges changed by patch_raw_data
+		dirty_range_list dirty_ranges_;
 	};
 
 	//Section by file offset finder helper (4gb max)
@@ -627,6 +627,22 @@ namespace pe_bliss
 			uint32_t FirstThunk;                    // RVA to IAT (if bound this IAT has actual addresses)
 		};
 
+		/// Delay load import descriptors pointed to by DataDirectory[ IMAGE_DIRECTORY_ENTRY_DELAY_IMPORT ] ///
+		constexpr uint32_t image_delayload_rva_based = 0x1;     // Addresses in descriptor are RVAs (otherwise VAs, old Visual C++ 6.0 format)
+
+		struct image_delayload_descriptor
+		{
+			uint32_t Attributes;                    // image_delayload_rva_based
+			uint32_t DllNameRVA;                    // RVA to the name of the target library (NULL-terminate ASCII string)
+			uint32_t ModuleHandleRVA;               // RVA to the HMODULE caching location (PHMODULE)
+			uint32_t ImportAddressTableRVA;         // RVA to the start of the IAT (PIMAGE_THUNK_DATA)
+			uint32_t ImportNameTableRVA;            // RVA to the start of the name table (PIMAGE_THUNK_DATA::AddressOfData)
+			uint32_t BoundImportAddressTableRVA;    // RVA to an optional bound IAT
+			uint32_t UnloadInformationTableRVA;     // RVA to an optional unload info table
+			uint32_t TimeDateStamp;                 // 0 if not bound,
+			// Otherwise, date/time of the target DLL
+		};
+
 		/// TLS ///
 		struct image_tls_directory64
 		{
@@ -704,6 +720,8 @@ namespace pe_bliss
 			uwop_set_fpreg,       /* no info, FP = RSP + UNWIND_INFO.FPRegOffset*16 */
 			uwop_save_nonvol,     /* info == register number, offset in next slot */
 			uwop_save_nonvol_far, /* info == register number, offset in next 2 slots */
+			uwop_epilog,          /* version 2: epilog description, operand in next slot (version 1: save XMM, offset in next slot) */
+			uwop_spare_code,      /* version 2: reserved, 2 more slots (version 1: save XMM far, offset in next 2 slots) */
 			uwop_save_xmm128,     /* info == XMM reg number, offset in next slot */
 			uwop_save_xmm128_far, /* info == XMM reg number, offset in next 2 slots */
 			uwop_push_machframe   /* info == 0: no error-code, 1: error-code */
@@ -68,6 +68,6 @@ namespace pe_bliss
 		void remove_cursors_from_cursor_group(const std::string& cursor_group_data, uint32_t language);
 
 		//Returns free icon or cursor ID list depending on icon_place_mode
-		const std::vector<uint16_t> get_icon_or_cursor_free_id_list(pe_resource_manager::resource_type type, icon_place_mode mode, uint32_t count);
+		std::vector<uint16_t> get_icon_or_cursor_free_id_list(pe_resource_manager::resource_type type, icon_place_mode mode, uint32_t count);
 	};
 }
@@ -17,8 +17,8 @@ namespace pe_bliss
 		//file_version_info: versions and file info
 		//lang_lang_string_values_map: map of version info strings with encodings with encodings
 		//translation_values_map: map of translations
-		const file_version_info get_version_info(lang_string_values_map& string_values, translation_values_map& translations, uint32_t index = 0) const;
-		const file_version_info get_version_info_by_lang(lang_string_values_map& string_values, translation_values_map& translations, uint32_t language) const;
+		file_version_info get_version_info(lang_string_values_map& string_values, translation_values_map& translations, uint32_t index = 0) const;
+		file_version_info get_version_info_by_lang(lang_string_values_map& string_values, translation_values_map& translations, uint32_t language) const;
 
 	public:
 		//L"VS_VERSION_INFO" key of root version info block
@@ -38,7 +38,7 @@ namespace pe_bliss
 		//file_version_info: versions and file info
 		//lang_string_values_map: map of version info strings with encodings
 		//translation_values_map: map of translations
-		const file_version_info get_version_info(lang_string_values_map& string_values, translation_values_map& translations, const std::string& resource_data) const;
+		file_version_info get_version_info(lang_string_values_map& string_values, translation_values_map& translations, const std::string& resource_data) const;
 
 		//Throws an exception (id = resource_incorrect_version_info)
 		static void throw_incorrect_version_info();
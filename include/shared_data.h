@@ -0,0 +1,124 @@
+#pragma once
+#include <memory>
+#include <utility>
+
+namespace pe_bliss
+{
+	//Reference-counted data holder with copy-on-write semantics
+	//Copies of holder share the same data until one of them requests it for writing
+	//Once a reference for writing is handed out by get_unshareable, holder is never shared again
+	//(copies of it get their own data), so that reference stays private to this holder
+	template<typename T>
+	class shared_data
+	{
+	public:
+		//Default constructor (empty data, nothing is allocated)
+		shared_data()
+			:unshareable_(false)
+		{}
+
+		//Constructor from data
+		explicit shared_data(const T& data)
+			:data_(std::make_shared<T>(data)), unshareable_(false)
+		{}
+
+		//Copy constructor (data is copied if it is unshareable)
+		shared_data(const shared_data& other)
+			:data_(other.unshareable_ ? std::make_shared<T>(*other.data_) : other.data_), unshareable_(false)
+		{}
+
+		//Move constructor (data and references to it are kept)
+		shared_data(shared_data&& other) noexcept
+			:data_(std::move(other.data_)), unshareable_(other.unshareable_)
+		{
+			other.unshareable_ = false;
+		}
+
+		//Copy assignment operator (data is copied if it is unshareable)
+		shared_data& operator=(const shared_data& other)
+		{
+			if (this != &other)
+			{
+				data_ = other.unshareable_ ? std::make_shared<T>(*other.data_) : other.data_;
+				unshareable_ = false;
+			}
+
+			return *this;
+		}
+
+		//Move assignment operator (data and references to it are kept)
+		shared_data& operator=(shared_data&& other) noexcept
+		{
+			if (this != &other)
+			{
+				data_ = std::move(other.data_);
+				unshareable_ = other.unshareable_;
+				other.unshareable_ = false;
+			}
+
+			return *this;
+		}
+
+		//Returns data for reading
+		const T& get() const
+		{
+			static const T empty;
+			return data_ ? *data_ : empty;
+		}
+
+		//Returns data for writing, data is copied first if it is shared with other holders
+		T& get_for_write()
+		{
+			if (!data_)
+				data_ = std::make_shared<T>();
+			else if (data_.use_count() > 1)
+				data_ = std::make_shared<T>(*data_);
+
+			return *data_;
+		}
+
+		//Returns data for writing, which may be held by caller: data is copied first if it is shared with other holders,
+		//and holder becomes unshareable, so later copies of holder do not see changes made through returned reference
+		T& get_unshareable()
+		{
+			T& data = get_for_write();
+			unshareable_ = true;
+			return data;
+		}
+
+		//Replaces data (in place, if it is not shared, so references returned by get_unshareable stay valid)
+		void set(const T& data)
+		{
+			if (data_ && data_.use_count() == 1)
+				*data_ = data;
+			else
+				data_ = std::make_shared<T>(data);
+		}
+
+		//Replaces data (in place, if it is not shared, so references returned by get_unshareable stay valid)
+		void set(T&& data)
+		{
+			if (data_ && data_.use_count() == 1)
+				*data_ = std::move(data);
+			else
+				data_ = std::make_shared<T>(std::move(data));
+		}
+
+		//Returns true if data is shared with other holders
+		bool shared() const
+		{
+			return data_ && data_.use_count() > 1;
+		}
+
+		//Returns true if reference for writing was handed out by get_unshareable
+		bool unshareable() const
+		{
+			return unshareable_;
+		}
+
+	private:
+		std::shared_ptr<T> data_;
+		//True if reference for writing was handed out by get_unshareable
+		bool unshareable_;
+	};
+}
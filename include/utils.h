@@ -71,8 +71,8 @@ namespace pe_bliss
 
 #ifndef PE_BLISS_WINDOWS
 	public:
-		static const u16string to_ucs2(const std::wstring& str);
-		static const std::wstring from_ucs2(const u16string& str);
+		static u16string to_ucs2(const std::wstring& str);
+		static std::wstring from_ucs2(const u16string& str);
 #endif
 
 	private:
@@ -0,0 +1,54 @@
+#include "memory_stream.h"
+
+namespace pe_bliss
+{
+	//Constructor from data
+	memory_streambuf::memory_streambuf(const char* data, std::size_t size)
+	{
+		//Get area is never written, const_cast is required by std::streambuf interface only
+		char* begin = const_cast<char*>(data);
+		setg(begin, begin, begin + size);
+	}
+
+	//Changes read position relative to beginning, current position or end of memory block
+	memory_streambuf::pos_type memory_streambuf::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+	{
+		if (!(which & std::ios_base::in))
+			return pos_type(off_type(-1));
+
+		off_type base;
+		if (dir == std::ios_base::beg)
+			base = 0;
+		else if (dir == std::ios_base::cur)
+			base = gptr() - eback();
+		else
+			base = egptr() - eback();
+
+		return seekpos(pos_type(base + off), which);
+	}
+
+	//Changes read position to absolute value
+	memory_streambuf::pos_type memory_streambuf::seekpos(pos_type pos, std::ios_base::openmode which)
+	{
+		const off_type offset = off_type(pos);
+		if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+			return pos_type(off_type(-1));
+
+		setg(eback(), eback() + offset, egptr());
+		return pos;
+	}
+
+	//Constructor from data
+	memory_istream::memory_istream(const char* data, std::size_t size)
+		:std::istream(0), buf_(data, size)
+	{
+		rdbuf(&buf_);
+	}
+
+	//Constructor from data
+	memory_istream::memory_istream(std::string_view data)
+		:std::istream(0), buf_(data.data(), data.size())
+	{
+		rdbuf(&buf_);
+	}
+}
@@ -0,0 +1,301 @@
+#include <string.h>
+#include <mutex>
+#include "name_pool.h"
+#include "pe_exception.h"
+
+namespace pe_bliss
+{
+	//NAME POOL
+	//Shard constructor
+	name_pool::shard::shard()
+		:block_pos(0), block_free(0), storage_size(0)
+	{}
+
+	//Default constructor
+	name_pool::name_pool()
+	{}
+
+	//Returns index of shard for name
+	uint32_t name_pool::get_shard_index(std::string_view name)
+	{
+		//High bits of hash are used, low ones select bucket inside shard
+		return static_cast<uint32_t>(std::hash<std::string_view>()(name) >> (sizeof(std::size_t) * 8 - shard_bits));
+	}
+
+	//Interns name, returns view of pooled copy and sets its ID
+	std::string_view name_pool::intern(std::string_view name, uint32_t& id)
+	{
+		uint32_t shard_index = get_shard_index(name);
+		shard& s = shards_[shard_index];
+
+		//Most names are already interned, look them up under shared lock first
+		{
+			std::shared_lock<std::shared_mutex> lock(s.lock);
+			std::unordered_map<std::string_view, uint32_t>::const_iterator it = s.ids.find(name);
+			if (it != s.ids.end())
+			{
+				id = (*it).second;
+				return (*it).first;
+			}
+		}
+
+		std::unique_lock<std::shared_mutex> lock(s.lock);
+
+		//Name could be interned by other thread while lock was released
+		std::unordered_map<std::string_view, uint32_t>::const_iterator it = s.ids.find(name);
+		if (it != s.ids.end())
+		{
+			id = (*it).second;
+			return (*it).first;
+		}
+
+		//Copy name (with null-termination) to storage
+		std::size_t needed_size = name.length() + 1;
+		char* data;
+		if (needed_size > block_size / 4)
+		{
+			//Large names get their own blocks
+			s.blocks.push_back(std::unique_ptr<char[]>(new char[needed_size]));
+			s.storage_size += needed_size;
+			data = s.blocks.back().get();
+		}
+		else
+		{
+			if (needed_size > s.block_free)
+			{
+				//Blocks grow twice up to maximum size, so small pools stay small
+				std::size_t new_block_size = s.storage_size < min_block_size ? min_block_size : s.storage_size;
+				if (new_block_size > block_size)
+					new_block_size = block_size;
+				if (new_block_size < needed_size)
+					new_block_size = needed_size;
+
+				s.blocks.push_back(std::unique_ptr<char[]>(new char[new_block_size]));
+				s.storage_size += new_block_size;
+				s.block_pos = s.blocks.back().get();
+				s.block_free = new_block_size;
+			}
+
+			data = s.block_pos;
+			s.block_pos += needed_size;
+			s.block_free -= needed_size;
+		}
+
+		memcpy(data, name.data(), name.length());
+		data[name.length()] = '\0';
+
+		std::string_view pooled(data, name.length());
+		id = (static_cast<uint32_t>(s.names.size()) << shard_bits) | shard_index;
+		s.names.push_back(pooled);
+		s.ids.insert(std::make_pair(pooled, id));
+		return pooled;
+	}
+
+	//Interns name and returns its ID
+	uint32_t name_pool::intern(std::string_view name)
+	{
+		uint32_t id;
+		intern(name, id);
+		return id;
+	}
+
+	//Returns ID of name or no_id, if name was not interned
+	uint32_t name_pool::find(std::string_view name) const
+	{
+		const shard& s = shards_[get_shard_index(name)];
+
+		std::shared_lock<std::shared_mutex> lock(s.lock);
+		std::unordered_map<std::string_view, uint32_t>::const_iterator it = s.ids.find(name);
+		return it == s.ids.end() ? no_id : (*it).second;
+	}
+
+	//Returns interned name by ID, throws an exception if ID is incorrect
+	std::string_view name_pool::get_name(uint32_t id) const
+	{
+		const shard& s = shards_[id & (shard_count - 1)];
+
+		std::shared_lock<std::shared_mutex> lock(s.lock);
+		if ((id >> shard_bits) >= s.names.size())
+			throw pe_exception("Name with specified ID does not exist", pe_exception::name_not_found);
+
+		return s.names[id >> shard_bits];
+	}
+
+	//Returns number of interned names
+	std::size_t name_pool::size() const
+	{
+		std::size_t ret = 0;
+		for (uint32_t i = 0; i != shard_count; ++i)
+		{
+			std::shared_lock<std::shared_mutex> lock(shards_[i].lock);
+			ret += shards_[i].names.size();
+		}
+
+		return ret;
+	}
+
+	//Returns number of bytes allocated for names storage
+	std::size_t name_pool::get_storage_size() const
+	{
+		std::size_t ret = 0;
+		for (uint32_t i = 0; i != shard_count; ++i)
+		{
+			std::shared_lock<std::shared_mutex> lock(shards_[i].lock);
+			ret += shards_[i].storage_size;
+		}
+
+		return ret;
+	}
+
+	//POOLED NAME
+	//Default constructor
+	pooled_name::pooled_name() noexcept
+		:data_(0), size_(0), id_(name_pool::no_id)
+	{}
+
+	//Constructor with allocator
+	pooled_name::pooled_name(const allocator_type& allocator) noexcept
+		:allocator_(allocator), data_(0), size_(0), id_(name_pool::no_id)
+	{}
+
+	//Copy constructor
+	pooled_name::pooled_name(const pooled_name& other)
+		:data_(0), size_(0), id_(name_pool::no_id)
+	{
+		*this = other;
+	}
+
+	//Allocator-extended copy constructor
+	pooled_name::pooled_name(const pooled_name& other, const allocator_type& allocator)
+		:allocator_(allocator), data_(0), size_(0), id_(name_pool::no_id)
+	{
+		*this = other;
+	}
+
+	//Move constructor
+	pooled_name::pooled_name(pooled_name&& other) noexcept
+		:allocator_(other.allocator_), data_(other.data_), size_(other.size_), id_(other.id_)
+	{
+		other.data_ = 0;
+		other.size_ = 0;
+		other.id_ = name_pool::no_id;
+	}
+
+	//Allocator-extended move constructor
+	pooled_name::pooled_name(pooled_name&& other, const allocator_type& allocator)
+		:allocator_(allocator), data_(0), size_(0), id_(name_pool::no_id)
+	{
+		*this = std::move(other);
+	}
+
+	//Copy assignment operator
+	pooled_name& pooled_name::operator=(const pooled_name& other)
+	{
+		if (this != &other)
+		{
+			if (other.id_ != name_pool::no_id)
+			{
+				//Interned name is shared
+				release();
+				data_ = other.data_;
+				size_ = other.size_;
+				id_ = other.id_;
+			}
+			else
+			{
+				assign(other.get());
+			}
+		}
+
+		return *this;
+	}
+
+	//Move assignment operator
+	pooled_name& pooled_name::operator=(pooled_name&& other)
+	{
+		if (this != &other)
+		{
+			if (other.id_ != name_pool::no_id || allocator_ == other.allocator_)
+			{
+				//Take name from other one
+				release();
+				data_ = other.data_;
+				size_ = other.size_;
+				id_ = other.id_;
+
+				other.data_ = 0;
+				other.size_ = 0;
+				other.id_ = name_pool::no_id;
+			}
+			else
+			{
+				assign(other.get());
+			}
+		}
+
+		return *this;
+	}
+
+	//Destructor
+	pooled_name::~pooled_name()
+	{
+		release();
+	}
+
+	//Returns name
+	std::string_view pooled_name::get() const noexcept
+	{
+		return data_ ? std::string_view(data_, size_) : std::string_view("", 0);
+	}
+
+	//Returns ID of name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t pooled_name::get_id() const noexcept
+	{
+		return id_;
+	}
+
+	//Sets name, its copy is stored in memory resource of allocator
+	void pooled_name::set(std::string_view name)
+	{
+		assign(name);
+	}
+
+	//Sets name interned in pool, nothing is allocated
+	void pooled_name::set(std::string_view name, name_pool& pool)
+	{
+		uint32_t id;
+		std::string_view pooled = pool.intern(name, id);
+
+		release();
+		data_ = pooled.data();
+		size_ = static_cast<uint32_t>(pooled.length());
+		id_ = id;
+	}
+
+	//Stores copy of name
+	void pooled_name::assign(std::string_view name)
+	{
+		char* data = 0;
+		if (!name.empty())
+		{
+			data = allocator_.allocate(name.length() + 1);
+			memcpy(data, name.data(), name.length());
+			data[name.length()] = '\0';
+		}
+
+		release();
+		data_ = data;
+		size_ = static_cast<uint32_t>(name.length());
+	}
+
+	//Frees stored copy of name
+	void pooled_name::release() noexcept
+	{
+		if (data_ && id_ == name_pool::no_id)
+			allocator_.deallocate(const_cast<char*>(data_), size_ + 1);
+
+		data_ = 0;
+		size_ = 0;
+		id_ = name_pool::no_id;
+	}
+}
@@ -15,7 +15,7 @@ namespace pe_bliss
 	using namespace pe_win;
 
 	//Constructor
-	pe_base::pe_base(std::istream& file, const pe_properties& props, bool read_debug_raw_data)
+	pe_base::pe_base(std::istream& file, const pe_properties& props, bool read_debug_raw_data, bool read_overlay_data)
 	{
 		props_ = props.duplicate().release();
 
@@ -28,7 +28,7 @@ namespace pe_bliss
 			file.exceptions(std::ios::goodbit);
 			//Read DOS header, PE headers and section data
 			read_dos_header(file);
-			read_pe(file, read_debug_raw_data);
+			read_pe(file, read_debug_raw_data, read_overlay_data);
 		}
 		catch (const std::exception&)
 		{
@@ -51,7 +51,8 @@ namespace pe_bliss
 		props_ = props.duplicate().release();
 		props_->create_pe(section_alignment, subsystem);
 
-		has_overlay_ = false;
+		overlay_offset_ = 0;
+		overlay_size_ = 0;
 		memset(&dos_header_, 0, sizeof(dos_header_));
 
 		dos_header_.e_magic = 0x5A4D; //"MZ"
@@ -79,8 +80,11 @@ namespace pe_bliss
 		:dos_header_(pe.dos_header_),
 		rich_overlay_(pe.rich_overlay_),
 		sections_(pe.sections_),
-		has_overlay_(pe.has_overlay_),
+		overlay_offset_(pe.overlay_offset_),
+		overlay_size_(pe.overlay_size_),
+		overlay_data_(pe.overlay_data_),
 		full_headers_data_(pe.full_headers_data_),
+		original_headers_data_(pe.original_headers_data_),
 		debug_data_(pe.debug_data_),
 		props_(0)
 	{
@@ -92,8 +96,11 @@ namespace pe_bliss
 		dos_header_ = pe.dos_header_;
 		rich_overlay_ = pe.rich_overlay_;
 		sections_ = pe.sections_;
-		has_overlay_ = pe.has_overlay_;
+		overlay_offset_ = pe.overlay_offset_;
+		overlay_size_ = pe.overlay_size_;
+		overlay_data_ = pe.overlay_data_;
 		full_headers_data_ = pe.full_headers_data_;
+		original_headers_data_ = pe.original_headers_data_;
 		debug_data_ = pe.debug_data_;
 		delete props_;
 		props_ = 0;
@@ -102,6 +109,40 @@ namespace pe_bliss
 		return *this;
 	}
 
+	pe_base::pe_base(pe_base&& pe) noexcept
+		:dos_header_(pe.dos_header_),
+		rich_overlay_(std::move(pe.rich_overlay_)),
+		sections_(std::move(pe.sections_)),
+		overlay_offset_(pe.overlay_offset_),
+		overlay_size_(pe.overlay_size_),
+		overlay_data_(std::move(pe.overlay_data_)),
+		full_headers_data_(std::move(pe.full_headers_data_)),
+		original_headers_data_(std::move(pe.original_headers_data_)),
+		debug_data_(std::move(pe.debug_data_)),
+		props_(pe.props_)
+	{
+		pe.props_ = 0;
+	}
+
+	pe_base& pe_base::operator=(pe_base&& pe) noexcept
+	{
+		if (this != &pe)
+		{
+			dos_header_ = pe.dos_header_;
+			rich_overlay_ = std::move(pe.rich_overlay_);
+			sections_ = std::move(pe.sections_);
+			overlay_offset_ = pe.overlay_offset_;
+			overlay_size_ = pe.overlay_size_;
+			overlay_data_ = std::move(pe.overlay_data_);
+			full_headers_data_ = std::move(pe.full_headers_data_);
+			original_headers_data_ = std::move(pe.original_headers_data_);
+			debug_data_ = std::move(pe.debug_data_);
+			std::swap(props_, pe.props_);
+		}
+
+		return *this;
+	}
+
 	pe_base::~pe_base()
 	{
 		delete props_;
@@ -144,6 +185,12 @@ namespace pe_bliss
 		rich_overlay_ = data;
 	}
 
+	//Sets stub MSVS overlay
+	void pe_base::set_stub_overlay(std::string&& data)
+	{
+		rich_overlay_ = std::move(data);
+	}
+
 	//Returns stub overlay
 	const std::string& pe_base::get_stub_overlay() const noexcept
 	{
@@ -488,11 +535,11 @@ namespace pe_bliss
 		}
 
 		//Add section to the end of section list
-		sections_.push_back(s);
+		sections_.push_back(std::move(s));
 		//Set number of sections in PE header
 		set_number_of_sections(static_cast<uint16_t>(sections_.size()));
 		//Recalculate virtual size of image
-		set_size_of_image(get_size_of_image() + s.get_aligned_virtual_size(get_section_alignment()));
+		set_size_of_image(get_size_of_image() + sections_.back().get_aligned_virtual_size(get_section_alignment()));
 		//Return last section
 		return sections_.back();
 	}
@@ -648,8 +695,8 @@ namespace pe_bliss
 	uint32_t pe_base::section_data_length_from_rva(uint32_t rva, section_data_type datatype, bool include_headers) const
 	{
 		//if RVA is inside of headers and we're searching them too...
-		if (include_headers && rva < full_headers_data_.length())
-			return static_cast<unsigned long>(full_headers_data_.length());
+		if (include_headers && rva < full_headers_data_.get().length())
+			return static_cast<unsigned long>(full_headers_data_.get().length());
 
 		const section& s = section_from_rva(rva);
 		return static_cast<unsigned long>(datatype == section_data_raw ? s.get_raw_data().length() /* instead of SizeOfRawData */ : s.get_aligned_virtual_size(get_section_alignment()));
@@ -671,8 +718,8 @@ namespace pe_bliss
 	uint32_t pe_base::section_data_length_from_rva(uint32_t rva, uint32_t rva_inside, section_data_type datatype, bool include_headers) const
 	{
 		//if RVAs are inside of headers and we're searching them too...
-		if (include_headers && rva < full_headers_data_.length() && rva_inside < full_headers_data_.length())
-			return static_cast<unsigned long>(full_headers_data_.length() - rva_inside);
+		if (include_headers && rva < full_headers_data_.get().length() && rva_inside < full_headers_data_.get().length())
+			return static_cast<unsigned long>(full_headers_data_.get().length() - rva_inside);
 
 		const section& s = section_from_rva(rva);
 		if (rva_inside < s.get_virtual_address())
@@ -735,8 +782,8 @@ namespace pe_bliss
 	char* pe_base::section_data_from_rva(uint32_t rva, bool include_headers)
 	{
 		//if RVA is inside of headers and we're searching them too...
-		if (include_headers && rva < full_headers_data_.length())
-			return &full_headers_data_[rva];
+		if (include_headers && rva < full_headers_data_.get().length())
+			return &full_headers_data_.get_unshareable()[rva];
 
 		section& s = section_from_rva(rva);
 
@@ -750,13 +797,30 @@ namespace pe_bliss
 	const char* pe_base::section_data_from_rva(uint32_t rva, section_data_type datatype, bool include_headers) const
 	{
 		//if RVA is inside of headers and we're searching them too...
-		if (include_headers && rva < full_headers_data_.length())
-			return &full_headers_data_[rva];
+		if (include_headers && rva < full_headers_data_.get().length())
+			return &full_headers_data_.get()[rva];
 
 		const section& s = section_from_rva(rva);
 		return (datatype == section_data_raw ? s.get_raw_data().data() : s.get_virtual_data(get_section_alignment()).c_str()) + rva - s.get_virtual_address();
 	}
 
+	//Writes data to section raw data at RVA
+	void pe_base::patch_section_data(uint32_t rva, const char* data, uint32_t size, bool include_headers)
+	{
+		//if RVA is inside of headers and we're searching them too...
+		if (include_headers && rva < full_headers_data_.get().length())
+		{
+			if (!pe_utils::is_sum_safe(rva, size) || rva + size > full_headers_data_.get().length())
+				throw pe_exception("RVA and requested data size does not exist inside headers", pe_exception::rva_not_exists);
+
+			memcpy(&full_headers_data_.get_for_write()[rva], data, size);
+			return;
+		}
+
+		section& s = section_from_rva(rva);
+		s.patch_raw_data(rva - s.get_virtual_address(), data, size);
+	}
+
 	//Reads DOS headers from istream
 	void pe_base::read_dos_header(std::istream& file, image_dos_header& header)
 	{
@@ -781,7 +845,7 @@ namespace pe_bliss
 	}
 
 	//Reads PE image from istream
-	void pe_base::read_pe(std::istream& file, bool read_debug_raw_data)
+	void pe_base::read_pe(std::istream& file, bool read_debug_raw_data, bool read_overlay_data)
 	{
 		//Get istream size
 		std::streamoff filesize = pe_utils::get_file_size(file);
@@ -862,7 +926,8 @@ namespace pe_bliss
 				throw pe_exception("Cannot reach section headers", pe_exception::image_section_headers_not_found);
 		}
 
-		uint32_t last_raw_size = 0;
+		//Overlay starts after the end of raw data of all sections
+		uint32_t overlay_offset = get_size_of_headers();
 
 		//Read all sections
 		for (int i = 0; i < get_number_of_sections(); i++)
@@ -889,8 +954,10 @@ namespace pe_bliss
 			{
 				//If section has raw data
 
+				//Save the end of section raw data to locate overlay
+				overlay_offset = std::max<uint32_t>(overlay_offset, s.get_pointer_to_raw_data() + s.get_size_of_raw_data());
+
 				//If section raw data size is greater than virtual, fix it
-				last_raw_size = s.get_size_of_raw_data();
 				if (pe_utils::align_up(s.get_size_of_raw_data(), get_file_alignment()) > pe_utils::align_up(s.get_virtual_size(), get_section_alignment()))
 					s.set_size_of_raw_data(s.get_virtual_size());
 
@@ -906,10 +973,13 @@ namespace pe_bliss
 					throw pe_exception("Cannot reach section data", pe_exception::image_section_data_not_found);
 
 				//Read section raw data
-				s.get_raw_data().resize(s.get_size_of_raw_data());
-				file.read(&s.get_raw_data()[0], s.get_size_of_raw_data());
+				//It is set as a whole, so it stays shareable between copies of image
+				std::string raw_data(s.get_size_of_raw_data(), 0);
+				file.read(&raw_data[0], raw_data.size());
 				if (file.bad() || file.fail())
 					throw pe_exception("Error reading section data", pe_exception::image_section_data_not_found);
+
+				s.set_raw_data(std::move(raw_data));
 			}
 
 			//Check virtual address and size of section
@@ -917,7 +987,7 @@ namespace pe_bliss
 				throw pe_exception("Incorrect section address or size", pe_exception::section_incorrect_addr_or_size);
 
 			//Save section
-			sections_.push_back(s);
+			sections_.push_back(std::move(s));
 
 			//Seek to the next section header
 			file.seekg(next_sect);
@@ -939,7 +1009,22 @@ namespace pe_bliss
 		}
 
 		//Check if image has overlay in the end of file
-		has_overlay_ = !sections_.empty() && filesize > static_cast<std::streamoff>(sections_.back().get_pointer_to_raw_data() + last_raw_size);
+		overlay_offset_ = overlay_offset;
+		overlay_size_ = !sections_.empty() && filesize > static_cast<std::streamoff>(overlay_offset) ? static_cast<uint64_t>(filesize - overlay_offset) : 0;
+
+		//Read overlay data, if requested
+		if (read_overlay_data && overlay_size_)
+		{
+			file.seekg(overlay_offset_);
+			if (file.bad() || file.fail())
+				throw pe_exception("Cannot reach overlay data", pe_exception::error_reading_overlay);
+
+			std::string& overlay_data = overlay_data_.get_for_write();
+			overlay_data.resize(static_cast<std::size_t>(overlay_size_));
+			file.read(&overlay_data[0], overlay_data.size());
+			if (file.bad() || file.fail())
+				throw pe_exception("Error reading overlay data", pe_exception::error_reading_overlay);
+		}
 
 		{
 			//Additionally, read data from the beginning of istream to size of headers
@@ -958,8 +1043,9 @@ namespace pe_bliss
 				}
 			}
 
-			full_headers_data_.resize(size_of_headers);
-			file.read(&full_headers_data_[0], size_of_headers);
+			std::string& full_headers_data = full_headers_data_.get_for_write();
+			full_headers_data.resize(size_of_headers);
+			file.read(&full_headers_data[0], size_of_headers);
 			if (file.bad() || file.eof())
 				throw pe_exception("Error reading file", pe_exception::error_reading_file);
 		}
@@ -995,7 +1081,7 @@ namespace pe_bliss
 						if (file.bad() || file.eof())
 							throw pe_exception("Error reading file", pe_exception::error_reading_file);
 
-						debug_data_.insert(std::make_pair(directory.PointerToRawData, data));
+						debug_data_.get_for_write().insert(std::make_pair(directory.PointerToRawData, data));
 					}
 
 					//Go to next debug entry
@@ -1016,6 +1102,17 @@ namespace pe_bliss
 				break;
 			}
 		}
+
+		//Remember headers and where section raw data was read from, it is unchanged now
+		//Header fields fixed above are remembered with fixed values, so commit_inplace writes only fields changed after loading
+		//(headers data is shared until it is changed, if nothing was fixed)
+		std::string original_headers(full_headers_data_.get());
+		if (place_headers(original_headers, dos_header_.e_lfanew, get_size_of_optional_header()) && original_headers != full_headers_data_.get())
+			original_headers_data_.set(std::move(original_headers));
+		else
+			original_headers_data_ = full_headers_data_;
+		for (section_list::iterator it = sections_.begin(); it != sections_.end(); ++it)
+			(*it).set_source_offset(pe_utils::align_down((*it).get_pointer_to_raw_data(), get_file_alignment()));
 	}
 
 	//Returns PE type of this image
@@ -1079,7 +1176,55 @@ namespace pe_bliss
 	//Returns true if image has overlay data at the end of file
 	bool pe_base::has_overlay() const
 	{
-		return has_overlay_;
+		return overlay_size_ != 0;
+	}
+
+	//Returns file offset of overlay data
+	uint32_t pe_base::get_overlay_offset() const
+	{
+		return overlay_offset_;
+	}
+
+	//Returns size of overlay data
+	uint64_t pe_base::get_overlay_size() const
+	{
+		return overlay_size_;
+	}
+
+	//Returns overlay data, if it is held by image
+	const std::string& pe_base::get_overlay_data() const
+	{
+		return overlay_data_.get();
+	}
+
+	//Returns overlay data view from the whole file data
+	std::string_view pe_base::get_overlay_data(std::string_view file_data) const
+	{
+		if (!overlay_size_ || file_data.size() < overlay_offset_ + overlay_size_)
+			throw pe_exception("File data does not contain overlay", pe_exception::error_reading_overlay);
+
+		return file_data.substr(overlay_offset_, static_cast<std::size_t>(overlay_size_));
+	}
+
+	//Sets overlay data, which will be written after the last section by rebuild_pe
+	void pe_base::set_overlay_data(const std::string& data)
+	{
+		overlay_data_.set(data);
+		overlay_size_ = data.size();
+	}
+
+	//Sets overlay data, which will be written after the last section by rebuild_pe
+	void pe_base::set_overlay_data(std::string&& data)
+	{
+		overlay_size_ = data.size();
+		overlay_data_.set(std::move(data));
+	}
+
+	//Strips overlay data
+	void pe_base::strip_overlay()
+	{
+		overlay_data_ = shared_data<std::string>();
+		overlay_size_ = 0;
 	}
 
 	//Clears PE characteristics flag
@@ -1277,7 +1422,7 @@ namespace pe_bliss
 	}
 
 	//Returns section and offset (raw data only) from its start from RVA
-	const std::pair<uint32_t, const section*> pe_base::section_and_offset_from_rva(uint32_t rva) const
+	std::pair<uint32_t, const section*> pe_base::section_and_offset_from_rva(uint32_t rva) const
 	{
 		const section& s = section_from_rva(rva);
 		return std::make_pair(rva - s.get_virtual_address(), &s);
@@ -1581,12 +1726,56 @@ namespace pe_bliss
 	//Size = SizeOfHeaders
 	const std::string& pe_base::get_full_headers_data() const
 	{
-		return full_headers_data_;
+		return full_headers_data_.get();
+	}
+
+	//Returns data from the beginning of image as it was read from file (or written by commit_inplace)
+	const std::string& pe_base::get_original_headers_data() const
+	{
+		return original_headers_data_.get();
+	}
+
+	//Sets data from the beginning of image, which is stored in file
+	void pe_base::set_original_headers_data(const std::string& data)
+	{
+		original_headers_data_.set(data);
+	}
+
+	//Copies data to headers buffer at offset, returns false if data doesn't fit into headers buffer
+	bool place_headers_data(std::string& headers, uint32_t offset, const void* data, std::size_t size)
+	{
+		if (static_cast<uint64_t>(offset) + size > headers.length())
+			return false;
+
+		memcpy(&headers[offset], data, size);
+		return true;
+	}
+
+	//Places current headers over data from the beginning of image
+	bool pe_base::place_headers(std::string& headers_data, uint32_t nt_headers_offset, uint16_t size_of_optional_header) const
+	{
+		const std::size_t nt_headers_size = get_sizeof_nt_header()
+			- sizeof(image_data_directory) * (image_numberof_directory_entries - get_number_of_rvas_and_sizes());
+
+		if (!place_headers_data(headers_data, 0, &dos_header_, std::min<std::size_t>(sizeof(image_dos_header), nt_headers_offset))
+			|| !place_headers_data(headers_data, sizeof(image_dos_header), rich_overlay_.data(), rich_overlay_.size())
+			|| !place_headers_data(headers_data, nt_headers_offset, get_nt_headers_ptr(), nt_headers_size))
+			return false;
+
+		uint64_t section_header_offset = static_cast<uint64_t>(nt_headers_offset) + sizeof(uint32_t) + sizeof(image_file_header) + size_of_optional_header;
+		for (section_list::const_iterator it = sections_.begin(); it != sections_.end(); ++it, section_header_offset += sizeof(image_section_header))
+		{
+			if (section_header_offset > headers_data.length()
+				|| !place_headers_data(headers_data, static_cast<uint32_t>(section_header_offset), &(*it).get_raw_header(), sizeof(image_section_header)))
+				return false;
+		}
+
+		return true;
 	}
 
 	const pe_base::debug_data_list& pe_base::get_raw_debug_data_list() const
 	{
-		return debug_data_;
+		return debug_data_.get();
 	}
 
 	//Sets number of sections
@@ -13,15 +13,45 @@ namespace pe_bliss
 		:timestamp_(0)
 	{}
 
+	//Constructor with allocator
+	bound_import_ref::bound_import_ref(const allocator_type& allocator) noexcept
+		:module_name_(allocator), timestamp_(0)
+	{}
+
 	//Constructor from data
-	bound_import_ref::bound_import_ref(const std::string& module_name, uint32_t timestamp)
-		:module_name_(module_name), timestamp_(timestamp)
+	bound_import_ref::bound_import_ref(std::string_view module_name, uint32_t timestamp, const allocator_type& allocator)
+		:module_name_(allocator), timestamp_(timestamp)
+	{
+		module_name_.set(module_name);
+	}
+
+	//Constructor from data (module name is interned in pool)
+	bound_import_ref::bound_import_ref(std::string_view module_name, uint32_t timestamp, name_pool& pool, const allocator_type& allocator)
+		:module_name_(allocator), timestamp_(timestamp)
+	{
+		module_name_.set(module_name, pool);
+	}
+
+	//Allocator-extended copy constructor
+	bound_import_ref::bound_import_ref(const bound_import_ref& other, const allocator_type& allocator)
+		:module_name_(other.module_name_, allocator), timestamp_(other.timestamp_)
+	{}
+
+	//Allocator-extended move constructor
+	bound_import_ref::bound_import_ref(bound_import_ref&& other, const allocator_type& allocator)
+		:module_name_(std::move(other.module_name_), allocator), timestamp_(other.timestamp_)
 	{}
 
 	//Returns imported module name
-	const std::string& bound_import_ref::get_module_name() const noexcept
+	std::string_view bound_import_ref::get_module_name() const noexcept
 	{
-		return module_name_;
+		return module_name_.get();
+	}
+
+	//Returns ID of module name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t bound_import_ref::get_module_name_id() const noexcept
+	{
+		return module_name_.get_id();
 	}
 
 	//Returns bound import date and time stamp
@@ -31,9 +61,15 @@ namespace pe_bliss
 	}
 
 	//Sets module name
-	void bound_import_ref::set_module_name(const std::string& module_name) noexcept
+	void bound_import_ref::set_module_name(std::string_view module_name)
 	{
-		module_name_ = module_name;
+		module_name_.set(module_name);
+	}
+
+	//Sets module name interned in pool
+	void bound_import_ref::set_module_name(std::string_view module_name, name_pool& pool)
+	{
+		module_name_.set(module_name, pool);
 	}
 
 	//Sets timestamp
@@ -47,15 +83,45 @@ namespace pe_bliss
 		:timestamp_(0)
 	{}
 
+	//Constructor with allocator
+	bound_import::bound_import(const allocator_type& allocator) noexcept
+		:module_name_(allocator), timestamp_(0), refs_(allocator)
+	{}
+
 	//Constructor from data
-	bound_import::bound_import(const std::string& module_name, uint32_t timestamp)
-		:module_name_(module_name), timestamp_(timestamp)
+	bound_import::bound_import(std::string_view module_name, uint32_t timestamp, const allocator_type& allocator)
+		:module_name_(allocator), timestamp_(timestamp), refs_(allocator)
+	{
+		module_name_.set(module_name);
+	}
+
+	//Constructor from data (module name is interned in pool)
+	bound_import::bound_import(std::string_view module_name, uint32_t timestamp, name_pool& pool, const allocator_type& allocator)
+		:module_name_(allocator), timestamp_(timestamp), refs_(allocator)
+	{
+		module_name_.set(module_name, pool);
+	}
+
+	//Allocator-extended copy constructor
+	bound_import::bound_import(const bound_import& other, const allocator_type& allocator)
+		:module_name_(other.module_name_, allocator), timestamp_(other.timestamp_), refs_(other.refs_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	bound_import::bound_import(bound_import&& other, const allocator_type& allocator)
+		:module_name_(std::move(other.module_name_), allocator), timestamp_(other.timestamp_), refs_(std::move(other.refs_), allocator)
 	{}
 
 	//Returns imported module name
-	const std::string& bound_import::get_module_name() const noexcept
+	std::string_view bound_import::get_module_name() const noexcept
+	{
+		return module_name_.get();
+	}
+
+	//Returns ID of module name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t bound_import::get_module_name_id() const noexcept
 	{
-		return module_name_;
+		return module_name_.get_id();
 	}
 
 	//Returns bound import date and time stamp
@@ -95,9 +161,15 @@ namespace pe_bliss
 	}
 
 	//Sets module name
-	void bound_import::set_module_name(const std::string& module_name) noexcept
+	void bound_import::set_module_name(std::string_view module_name)
 	{
-		module_name_ = module_name;
+		module_name_.set(module_name);
+	}
+
+	//Sets module name interned in pool
+	void bound_import::set_module_name(std::string_view module_name, name_pool& pool)
+	{
+		module_name_.set(module_name, pool);
 	}
 
 	//Sets timestamp
@@ -106,22 +178,33 @@ namespace pe_bliss
 		timestamp_ = timestamp;
 	}
 
-	const bound_import_module_list get_bound_import_module_list(const pe_base& pe)
+	//Returns bound import information
+	bound_import_module_list get_bound_import_module_list(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
 	{
 		//Returned bound import modules list
-		bound_import_module_list ret;
+		bound_import_module_list ret(resource);
+		pe_data_cursor cursor(pe);
+		read_bound_import_module_list(cursor, ret, names);
+		return ret;
+	}
+
+	//Reads bound import information and appends it to "ret"
+	void read_bound_import_module_list(pe_data_cursor& cursor, bound_import_module_list& ret, name_pool* names)
+	{
+		const pe_base& pe = cursor.get_pe();
 
 		//If image has no bound imports
 		if (!pe.has_bound_import())
-			return ret;
+			return;
 
-		const uint32_t bound_import_data_len =
-			pe.section_data_length_from_rva(pe.get_directory_rva(image_directory_entry_bound_import), pe.get_directory_rva(image_directory_entry_bound_import), section_data_raw, true);
+		//Bound import directory is read from raw data
+		const std::string_view bound_import_raw_data = cursor.read_raw_data(pe.get_directory_rva(image_directory_entry_bound_import));
+		const uint32_t bound_import_data_len = static_cast<uint32_t>(bound_import_raw_data.length());
 
 		if (bound_import_data_len < pe.get_directory_size(image_directory_entry_bound_import))
 			throw pe_exception("Incorrect bound import directory", pe_exception::incorrect_bound_import_directory);
 
-		const char* bound_import_data = pe.section_data_from_rva(pe.get_directory_rva(image_directory_entry_bound_import), section_data_raw, true);
+		const char* bound_import_data = bound_import_raw_data.data();
 
 		//Check read in "read_pe" function raw bound import data size
 		if (bound_import_data_len < sizeof(image_bound_import_descriptor))
@@ -145,7 +228,9 @@ namespace pe_bliss
 				throw pe_exception("Incorrect bound import directory", pe_exception::incorrect_bound_import_directory);
 
 			//Create bound import descriptor structure
-			bound_import elem(&bound_import_data[descriptor->OffsetModuleName], descriptor->TimeDateStamp);
+			bound_import elem = names
+				? bound_import(&bound_import_data[descriptor->OffsetModuleName], descriptor->TimeDateStamp, *names, ret.get_allocator())
+				: bound_import(&bound_import_data[descriptor->OffsetModuleName], descriptor->TimeDateStamp, ret.get_allocator());
 
 			//Check DWORDs
 			if (descriptor->NumberOfModuleForwarderRefs >= pe_utils::max_dword / sizeof(image_bound_forwarder_ref)
@@ -175,7 +260,9 @@ namespace pe_bliss
 					throw pe_exception("Incorrect bound import directory", pe_exception::incorrect_bound_import_directory);
 
 				//Add referenced module to current bound import structure
-				elem.add_module_ref(bound_import_ref(&bound_import_data[ref_descriptor->OffsetModuleName], ref_descriptor->TimeDateStamp));
+				elem.add_module_ref(names
+					? bound_import_ref(&bound_import_data[ref_descriptor->OffsetModuleName], ref_descriptor->TimeDateStamp, *names, ret.get_allocator())
+					: bound_import_ref(&bound_import_data[ref_descriptor->OffsetModuleName], ref_descriptor->TimeDateStamp, ret.get_allocator()));
 
 				//Move after referenced bound import descriptor
 				current_pos += sizeof(image_bound_forwarder_ref);
@@ -189,11 +276,8 @@ namespace pe_bliss
 			descriptor = reinterpret_cast<const image_bound_import_descriptor*>(&bound_import_data[current_pos]);
 
 			//Save created descriptor structure and references
-			ret.push_back(elem);
+			ret.push_back(std::move(elem));
 		}
-
-		//Return result
-		return ret;
 	}
 
 	//imports - bound imported modules list
@@ -201,7 +285,7 @@ namespace pe_bliss
 	//offset_from_section_start - offset from imports_section raw data start
 	//save_to_pe_headers - if true, new bound import directory information will be saved to PE image headers
 	//auto_strip_last_section - if true and bound imports are placed in the last section, it will be automatically stripped
-	const image_directory rebuild_bound_imports(pe_base& pe, const bound_import_module_list& imports, section& imports_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_bound_imports(pe_base& pe, const bound_import_module_list& imports, section& imports_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		//Check that exports_section is attached to this PE image
 		if (!pe.section_attached(imports_section))
@@ -254,7 +338,7 @@ namespace pe_bliss
 			current_pos_for_structures += sizeof(descriptor);
 
 			size_t length = import.get_module_name().length() + 1 /* nullbyte */;
-			memcpy(&raw_data[current_pos_for_strings], import.get_module_name().c_str(), length);
+			memcpy(&raw_data[current_pos_for_strings], import.get_module_name().data(), length);
 			current_pos_for_strings += gsl::narrow_cast<uint32_t>(length);
 
 			const bound_import::ref_list& refs = import.get_module_ref_list();
@@ -269,7 +353,7 @@ namespace pe_bliss
 				current_pos_for_structures += sizeof(ref_descriptor);
 
 				length = ref.get_module_name().length() + 1 /* nullbyte */;
-				memcpy(&raw_data[current_pos_for_strings], ref.get_module_name().c_str(), length);
+				memcpy(&raw_data[current_pos_for_strings], ref.get_module_name().data(), length);
 				current_pos_for_strings += gsl::narrow_cast<uint32_t>(length);
 			}
 		}
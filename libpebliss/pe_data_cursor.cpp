@@ -0,0 +1,85 @@
+#include "pe_data_cursor.h"
+
+namespace pe_bliss
+{
+	//Constructor from image
+	pe_data_cursor::pe_data_cursor(const pe_base& pe)
+		:pe_(pe), headers_(pe.get_full_headers_data()), section_(0), section_rva_(0), section_size_(0)
+	{}
+
+	//Returns image
+	const pe_base& pe_data_cursor::get_pe() const
+	{
+		return pe_;
+	}
+
+	//Makes section containing RVA current one
+	void pe_data_cursor::select_section(uint32_t rva)
+	{
+		//Most reads are done from the current section
+		if (section_ && rva >= section_rva_ && rva - section_rva_ < section_size_)
+			return;
+
+		section_ = &pe_.section_from_rva(rva);
+		section_rva_ = section_->get_virtual_address();
+		section_size_ = section_->get_aligned_virtual_size(pe_.get_section_alignment());
+		section_data_ = section_->get_virtual_data(pe_.get_section_alignment());
+	}
+
+	//Returns pointer to "size" bytes of virtual data of section containing RVA
+	const char* pe_data_cursor::get_section_data(uint32_t rva, uint32_t size)
+	{
+		select_section(rva);
+
+		uint32_t offset = rva - section_rva_;
+		if (!pe_utils::is_sum_safe(offset, size) || offset + size > section_data_.length())
+			throw pe_exception("RVA and requested data size does not exist inside section", pe_exception::rva_not_exists);
+
+		return section_data_.data() + offset;
+	}
+
+	//Returns null-terminated string from virtual data at RVA
+	const char* pe_data_cursor::read_string(uint32_t rva, const char* error_message, pe_exception::exception_id error_id)
+	{
+		const char* str;
+		unsigned long max_length;
+
+		//if RVA is inside of headers...
+		if (rva < headers_.length())
+		{
+			str = headers_.data() + rva;
+			max_length = static_cast<unsigned long>(headers_.length() - rva);
+		}
+		else
+		{
+			select_section(rva);
+			str = section_data_.data() + rva - section_rva_;
+			max_length = section_size_ - (rva - section_rva_);
+		}
+
+		//Check for null-termination
+		if (max_length < 2 || !pe_utils::is_null_terminated(str, max_length))
+			throw pe_exception(error_message, error_id);
+
+		return str;
+	}
+
+	//Returns raw data at RVA and its remaining length
+	std::string_view pe_data_cursor::read_raw_data(uint32_t rva)
+	{
+		//if RVA is inside of headers...
+		if (rva < headers_.length())
+			return headers_.substr(rva);
+
+		const section& s = pe_.section_from_rva(rva);
+
+		//Raw data access unmaps virtual data of section, so it is looked up again by the next read
+		section_ = 0;
+
+		const std::string& raw_data = s.get_raw_data();
+		if (rva - s.get_virtual_address() >= raw_data.length())
+			return std::string_view();
+
+		return std::string_view(raw_data).substr(rva - s.get_virtual_address());
+	}
+}
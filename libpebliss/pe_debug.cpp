@@ -1,4 +1,7 @@
 #include <string.h>
+#include <stddef.h>
+#include <istream>
+#include <algorithm>
 #include "pe_debug.h"
 #include "utils.h"
 
@@ -153,6 +156,48 @@ namespace pe_bliss
 		return *this;
 	}
 
+	//Move constructor
+	debug_info::debug_info(debug_info&& info) noexcept
+		:characteristics_(info.characteristics_),
+		time_stamp_(info.time_stamp_),
+		major_version_(info.major_version_), minor_version_(info.minor_version_),
+		type_(info.type_),
+		size_of_data_(info.size_of_data_),
+		address_of_raw_data_(info.address_of_raw_data_),
+		pointer_to_raw_data_(info.pointer_to_raw_data_),
+		advanced_debug_info_(info.advanced_debug_info_),
+		advanced_info_type_(info.advanced_info_type_)
+	{
+		info.advanced_debug_info_.adv_pdb_7_0_info = 0;
+		info.advanced_info_type_ = advanced_info_none;
+	}
+
+	//Move assignment operator
+	debug_info& debug_info::operator=(debug_info&& info) noexcept
+	{
+		if (this != &info)
+		{
+			free_present_advanced_info();
+
+			characteristics_ = info.characteristics_;
+			time_stamp_ = info.time_stamp_;
+			major_version_ = info.major_version_;
+			minor_version_ = info.minor_version_;
+			type_ = info.type_;
+			size_of_data_ = info.size_of_data_;
+			address_of_raw_data_ = info.address_of_raw_data_;
+			pointer_to_raw_data_ = info.pointer_to_raw_data_;
+
+			//Take advanced debug information from other object
+			advanced_info_type_ = info.advanced_info_type_;
+			advanced_debug_info_ = info.advanced_debug_info_;
+			info.advanced_debug_info_.adv_pdb_7_0_info = 0;
+			info.advanced_info_type_ = advanced_info_none;
+		}
+
+		return *this;
+	}
+
 	//Default constructor
 	debug_info::advanced_info::advanced_info()
 		:adv_pdb_7_0_info(0) //Zero pointer to advanced data
@@ -250,6 +295,13 @@ namespace pe_bliss
 		advanced_info_type_ = advanced_info_coff;
 	}
 
+	void debug_info::set_advanced_debug_info(coff_debug_info&& info)
+	{
+		free_present_advanced_info();
+		advanced_debug_info_.adv_coff_info = new coff_debug_info(std::move(info));
+		advanced_info_type_ = advanced_info_coff;
+	}
+
 	//Returns advanced debug information type
 	debug_info::advanced_info_type debug_info::get_advanced_info_type() const
 	{
@@ -259,7 +311,7 @@ namespace pe_bliss
 	//Returns advanced debug information or throws an exception,
 	//if requested information type is not contained by structure
 	template<>
-	const pdb_7_0_info debug_info::get_advanced_debug_info<pdb_7_0_info>() const
+	pdb_7_0_info debug_info::get_advanced_debug_info<pdb_7_0_info>() const
 	{
 		if (advanced_info_type_ != advanced_info_pdb_7_0)
 			throw pe_exception("Debug info structure does not contain PDB 7.0 data", pe_exception::advanced_debug_information_request_error);
@@ -268,7 +320,7 @@ namespace pe_bliss
 	}
 
 	template<>
-	const pdb_2_0_info debug_info::get_advanced_debug_info<pdb_2_0_info>() const
+	pdb_2_0_info debug_info::get_advanced_debug_info<pdb_2_0_info>() const
 	{
 		if (advanced_info_type_ != advanced_info_pdb_2_0)
 			throw pe_exception("Debug info structure does not contain PDB 2.0 data", pe_exception::advanced_debug_information_request_error);
@@ -277,7 +329,7 @@ namespace pe_bliss
 	}
 
 	template<>
-	const misc_debug_info debug_info::get_advanced_debug_info<misc_debug_info>() const
+	misc_debug_info debug_info::get_advanced_debug_info<misc_debug_info>() const
 	{
 		if (advanced_info_type_ != advanced_info_misc)
 			throw pe_exception("Debug info structure does not contain MISC data", pe_exception::advanced_debug_information_request_error);
@@ -286,7 +338,7 @@ namespace pe_bliss
 	}
 
 	template<>
-	const coff_debug_info debug_info::get_advanced_debug_info<coff_debug_info>() const
+	coff_debug_info debug_info::get_advanced_debug_info<coff_debug_info>() const
 	{
 		if (advanced_info_type_ != advanced_info_coff)
 			throw pe_exception("Debug info structure does not contain COFF data", pe_exception::advanced_debug_information_request_error);
@@ -316,7 +368,7 @@ namespace pe_bliss
 	{}
 
 	//Returns debug PDB 7.0 structure GUID
-	const guid pdb_7_0_info::get_guid() const
+	guid pdb_7_0_info::get_guid() const
 	{
 		return guid_;
 	}
@@ -443,6 +495,19 @@ namespace pe_bliss
 		rva_to_last_byte_of_data_(info->RvaToLastByteOfData)
 	{}
 
+	//Constructor from data with allocator
+	coff_debug_info::coff_debug_info(const image_coff_symbols_header* info, const coff_symbol::allocator_type& allocator)
+		:number_of_symbols_(info->NumberOfSymbols),
+		lva_to_first_symbol_(info->LvaToFirstSymbol),
+		number_of_line_numbers_(info->NumberOfLinenumbers),
+		lva_to_first_line_number_(info->LvaToFirstLinenumber),
+		rva_to_first_byte_of_code_(info->RvaToFirstByteOfCode),
+		rva_to_last_byte_of_code_(info->RvaToLastByteOfCode),
+		rva_to_first_byte_of_data_(info->RvaToFirstByteOfData),
+		rva_to_last_byte_of_data_(info->RvaToLastByteOfData),
+		symbols_(allocator)
+	{}
+
 	//Returns number of symbols
 	uint32_t coff_debug_info::get_number_of_symbols() const
 	{
@@ -503,6 +568,12 @@ namespace pe_bliss
 		symbols_.push_back(sym);
 	}
 
+	//Adds COFF symbol
+	void coff_debug_info::add_symbol(coff_symbol&& sym)
+	{
+		symbols_.push_back(std::move(sym));
+	}
+
 	//Default constructor
 	coff_debug_info::coff_symbol::coff_symbol()
 		:storage_class_(0),
@@ -512,6 +583,36 @@ namespace pe_bliss
 		is_filename_(false)
 	{}
 
+	//Constructor with allocator
+	coff_debug_info::coff_symbol::coff_symbol(const allocator_type& allocator)
+		:storage_class_(0),
+		index_(0),
+		section_number_(0), rva_(0),
+		type_(0),
+		is_filename_(false),
+		name_(allocator)
+	{}
+
+	//Allocator-extended copy constructor
+	coff_debug_info::coff_symbol::coff_symbol(const coff_symbol& other, const allocator_type& allocator)
+		:storage_class_(other.storage_class_),
+		index_(other.index_),
+		section_number_(other.section_number_), rva_(other.rva_),
+		type_(other.type_),
+		is_filename_(other.is_filename_),
+		name_(other.name_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	coff_debug_info::coff_symbol::coff_symbol(coff_symbol&& other, const allocator_type& allocator)
+		:storage_class_(other.storage_class_),
+		index_(other.index_),
+		section_number_(other.section_number_), rva_(other.rva_),
+		type_(other.type_),
+		is_filename_(other.is_filename_),
+		name_(std::move(other.name_), allocator)
+	{}
+
 	//Returns storage class
 	uint32_t coff_debug_info::coff_symbol::get_storage_class() const
 	{
@@ -543,7 +644,7 @@ namespace pe_bliss
 	}
 
 	//Returns text data (symbol or file name)
-	const std::string& coff_debug_info::coff_symbol::get_symbol() const
+	const std::pmr::string& coff_debug_info::coff_symbol::get_symbol() const
 	{
 		return name_;
 	}
@@ -573,14 +674,14 @@ namespace pe_bliss
 	}
 
 	//Sets file name
-	void coff_debug_info::coff_symbol::set_file_name(const std::string& file_name)
+	void coff_debug_info::coff_symbol::set_file_name(std::string_view file_name)
 	{
 		name_ = file_name;
 		is_filename_ = true;
 	}
 
 	//Sets symbol name
-	void coff_debug_info::coff_symbol::set_symbol_name(const std::string& symbol_name)
+	void coff_debug_info::coff_symbol::set_symbol_name(std::string_view symbol_name)
 	{
 		name_ = symbol_name;
 		is_filename_ = false;
@@ -598,237 +699,442 @@ namespace pe_bliss
 		type_ = type;
 	}
 
-	//Returns debug information list
-	const debug_info_list get_debug_information(const pe_base& pe)
+	//COFF SYMBOL TABLE VIEW
+	//Default constructor
+	coff_symbol_table_view::iterator::iterator()
+		:view_(0), index_(0)
+	{}
+
+	//Constructor from view and index of record
+	coff_symbol_table_view::iterator::iterator(const coff_symbol_table_view* view, uint32_t index)
+		:view_(view), index_(index)
+	{}
+
+	//Returns decoded symbol
+	coff_symbol_table_view::iterator::reference coff_symbol_table_view::iterator::operator*() const
 	{
-		debug_info_list ret;
+		return view_->get_symbol(index_);
+	}
 
-		//If there's no debug directory, return empty list
-		if (!pe.has_debug())
-			return ret;
+	//Moves to next symbol, skipping auxiliary records
+	coff_symbol_table_view::iterator& coff_symbol_table_view::iterator::operator++()
+	{
+		index_ += 1 + view_->get_number_of_aux_records(index_);
+		return *this;
+	}
 
-		//Check the length in bytes of the section containing debug directory
-		if (pe.section_data_length_from_rva(pe.get_directory_rva(image_directory_entry_debug), pe.get_directory_rva(image_directory_entry_debug), section_data_virtual, true)
-			< sizeof(image_debug_directory))
-			throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+	coff_symbol_table_view::iterator coff_symbol_table_view::iterator::operator++(int)
+	{
+		iterator ret(*this);
+		++*this;
+		return ret;
+	}
 
-		unsigned long current_pos = pe.get_directory_rva(image_directory_entry_debug);
+	bool coff_symbol_table_view::iterator::operator==(const iterator& other) const
+	{
+		return index_ == other.index_ && view_ == other.view_;
+	}
 
-		//First IMAGE_DEBUG_DIRECTORY table
-		image_debug_directory directory = pe.section_data_from_rva<image_debug_directory>(current_pos, section_data_virtual, true);
+	bool coff_symbol_table_view::iterator::operator!=(const iterator& other) const
+	{
+		return !(*this == other);
+	}
 
-		if (!pe_utils::is_sum_safe(pe.get_directory_rva(image_directory_entry_debug), pe.get_directory_size(image_directory_entry_debug)))
+	//Default constructor (empty symbol table)
+	coff_symbol_table_view::coff_symbol_table_view()
+		:address_index_built_(false)
+	{
+		memset(&header_, 0, sizeof(header_));
+	}
+
+	//Constructor from raw COFF debug data
+	coff_symbol_table_view::coff_symbol_table_view(std::string_view debug_data, const allocator_type& allocator)
+		:address_index_(allocator), address_index_built_(false)
+	{
+		//Check data length
+		if (debug_data.length() < sizeof(image_coff_symbols_header))
 			throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
 
-		//Iterate over all IMAGE_DEBUG_DIRECTORY directories
-		while (directory.PointerToRawData
-			&& current_pos < pe.get_directory_rva(image_directory_entry_debug) + pe.get_directory_size(image_directory_entry_debug))
+		//Raw data may be not aligned, so header is copied
+		memcpy(&header_, debug_data.data(), sizeof(header_));
+
+		//Check symbol table bounds (64-bit values can't overflow here)
+		uint64_t symbols_end = static_cast<uint64_t>(header_.LvaToFirstSymbol) + static_cast<uint64_t>(header_.NumberOfSymbols) * sizeof(image_symbol);
+		if (symbols_end > debug_data.length())
+			throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+		symbols_ = debug_data.substr(header_.LvaToFirstSymbol, static_cast<std::size_t>(header_.NumberOfSymbols) * sizeof(image_symbol));
+		string_table_ = debug_data.substr(static_cast<std::size_t>(symbols_end));
+	}
+
+	//Returns COFF symbols header
+	const image_coff_symbols_header& coff_symbol_table_view::get_header() const
+	{
+		return header_;
+	}
+
+	//Returns number of records in symbol table
+	uint32_t coff_symbol_table_view::get_number_of_records() const
+	{
+		return header_.NumberOfSymbols;
+	}
+
+	//Returns string table
+	std::string_view coff_symbol_table_view::get_string_table() const
+	{
+		return string_table_;
+	}
+
+	//Returns number of auxiliary records after record
+	uint32_t coff_symbol_table_view::get_number_of_aux_records(uint32_t index) const
+	{
+		uint32_t count = static_cast<uint8_t>(symbols_[static_cast<std::size_t>(index) * sizeof(image_symbol) + offsetof(image_symbol, NumberOfAuxSymbols)]);
+		return std::min(count, header_.NumberOfSymbols - index - 1);
+	}
+
+	//Decodes symbol by index of record
+	coff_symbol_record coff_symbol_table_view::get_symbol(uint32_t index) const
+	{
+		if (index >= header_.NumberOfSymbols)
+			throw pe_exception("Incorrect COFF symbol index", pe_exception::incorrect_debug_directory);
+
+		const char* data = symbols_.data() + static_cast<std::size_t>(index) * sizeof(image_symbol);
+		image_symbol sym;
+		memcpy(&sym, data, sizeof(sym));
+
+		coff_symbol_record symbol;
+		symbol.index = index;
+		symbol.value = sym.Value;
+		symbol.section_number = sym.SectionNumber;
+		symbol.type = sym.Type;
+		symbol.storage_class = sym.StorageClass;
+		symbol.number_of_aux_symbols = sym.NumberOfAuxSymbols;
+
+		if (sym.StorageClass == image_sym_class_file)
 		{
-			//Create debug information structure
-			debug_info info(directory);
+			//File name is situated in auxiliary records just after this record
+			symbol.name = std::string_view(data + sizeof(image_symbol), get_number_of_aux_records(index) * sizeof(image_symbol));
+			while (!symbol.name.empty() && !symbol.name.back())
+				symbol.name.remove_suffix(1);
+		}
+		else if (sym.N.Name.Short)
+		{
+			//Short name is not null-terminated, if it is 8 characters long
+			const char* name_end = static_cast<const char*>(memchr(data, 0, sizeof(sym.N.ShortName)));
+			symbol.name = std::string_view(data, name_end ? name_end - data : sizeof(sym.N.ShortName));
+		}
+		else
+		{
+			//Long name is an offset to the string table
+			//Check symbol name for null-termination
+			if (sym.N.Name.Long >= string_table_.length()
+				|| !pe_utils::is_null_terminated(string_table_.data() + sym.N.Name.Long, string_table_.length() - sym.N.Name.Long))
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
 
-			//Find raw debug data
-			const pe_base::debug_data_list& debug_datas = pe.get_raw_debug_data_list();
-			pe_base::debug_data_list::const_iterator it = debug_datas.find(directory.PointerToRawData);
-			if (it != debug_datas.end()) //If it exists, we'll do some detailed debug info research
-			{
-				const std::string& debug_data = (*it).second;
-				switch (directory.Type)
-				{
-				case image_debug_type_coff:
-				{
-					//Check data length
-					if (debug_data.length() < sizeof(image_coff_symbols_header))
-						throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+			symbol.name = std::string_view(string_table_.data() + sym.N.Name.Long);
+		}
 
-					//Get coff header structure pointer
-					const image_coff_symbols_header* coff = reinterpret_cast<const image_coff_symbols_header*>(debug_data.data());
+		return symbol;
+	}
 
-					//Check possible overflows
-					if (coff->NumberOfSymbols >= pe_utils::max_dword / sizeof(image_symbol)
-						|| !pe_utils::is_sum_safe(coff->NumberOfSymbols * sizeof(image_symbol), coff->LvaToFirstSymbol))
-						throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+	coff_symbol_table_view::iterator coff_symbol_table_view::begin() const
+	{
+		return iterator(this, 0);
+	}
 
-					//Check data length again
-					if (debug_data.length() < coff->NumberOfSymbols * sizeof(image_symbol) + coff->LvaToFirstSymbol)
-						throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+	coff_symbol_table_view::iterator coff_symbol_table_view::end() const
+	{
+		return iterator(this, header_.NumberOfSymbols);
+	}
 
-					//Create COFF debug info structure
-					coff_debug_info coff_info(coff);
+	//Builds index of symbols by address
+	void coff_symbol_table_view::build_address_index()
+	{
+		address_index_.clear();
 
-					//Enumerate debug symbols data
-					for (uint32_t i = 0; i < coff->NumberOfSymbols; ++i)
-					{
-						//Safe sum (checked above)
-						const image_symbol* sym = reinterpret_cast<const image_symbol*>(debug_data.data() + i * sizeof(image_symbol) + coff->LvaToFirstSymbol);
-
-						coff_debug_info::coff_symbol symbol;
-						symbol.set_index(i); //Save symbol index
-						symbol.set_storage_class(sym->StorageClass); //Save storage class
-						symbol.set_type(sym->Type); //Save storage class
-
-						//Check data length again
-						if (!pe_utils::is_sum_safe(i, sym->NumberOfAuxSymbols)
-							|| (i + sym->NumberOfAuxSymbols) > coff->NumberOfSymbols
-							|| debug_data.length() < (i + 1) * sizeof(image_symbol) + coff->LvaToFirstSymbol + sym->NumberOfAuxSymbols * sizeof(image_symbol))
-							throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+		for (uint32_t i = 0; i < header_.NumberOfSymbols; i += 1 + get_number_of_aux_records(i))
+		{
+			image_symbol sym;
+			memcpy(&sym, symbols_.data() + static_cast<std::size_t>(i) * sizeof(image_symbol), sizeof(sym));
 
-						//If symbol is filename
-						if (sym->StorageClass == image_sym_class_file)
-						{
-							//Save file name, it is situated just after this IMAGE_SYMBOL structure
-							std::string file_name(reinterpret_cast<const char*>(debug_data.data() + (i + 1) * sizeof(image_symbol)), sym->NumberOfAuxSymbols * sizeof(image_symbol));
-							pe_utils::strip_nullbytes(file_name);
-							symbol.set_file_name(file_name);
-
-							//Save symbol info
-							coff_info.add_symbol(symbol);
-
-							//Move to next symbol
-							i += sym->NumberOfAuxSymbols;
-							continue;
-						}
-
-						//Dump some other symbols
-						if (((sym->StorageClass == image_sym_class_static)
-							&& (sym->NumberOfAuxSymbols == 0)
-							&& (sym->SectionNumber == 1))
-							||
-							((sym->StorageClass == image_sym_class_external)
-								&& ISFCN(sym->Type)
-								&& (sym->SectionNumber > 0))
-							)
-						{
-							//Save RVA and section number
-							symbol.set_section_number(sym->SectionNumber);
-							symbol.set_rva(sym->Value);
-
-							//If symbol has short name
-							if (sym->N.Name.Short)
-							{
-								//Copy and save symbol name
-								char name_buff[9];
-								memcpy(name_buff, sym->N.ShortName, 8);
-								name_buff[8] = '\0';
-								symbol.set_symbol_name(name_buff);
-							}
-							else
-							{
-								//Symbol has long name
-
-								//Check possible overflows
-								if (!pe_utils::is_sum_safe(coff->LvaToFirstSymbol + coff->NumberOfSymbols * sizeof(image_symbol), sym->N.Name.Long))
-									throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
-
-								//Here we have an offset to the string table
-								uint32_t symbol_offset = coff->LvaToFirstSymbol + coff->NumberOfSymbols * sizeof(image_symbol) + sym->N.Name.Long;
-
-								//Check data length
-								if (debug_data.length() < symbol_offset)
-									throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
-
-								//Check symbol name for null-termination
-								if (!pe_utils::is_null_terminated(debug_data.data() + symbol_offset, debug_data.length() - symbol_offset))
-									throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
-
-								//Save symbol name
-								symbol.set_symbol_name(debug_data.data() + symbol_offset);
-							}
-
-							//Save symbol info
-							coff_info.add_symbol(symbol);
-
-							//Move to next symbol
-							i += sym->NumberOfAuxSymbols;
-							continue;
-						}
-					}
+			if (sym.SectionNumber > 0
+				&& (sym.StorageClass == image_sym_class_external
+					|| ((sym.StorageClass == image_sym_class_static || sym.StorageClass == image_sym_class_label) && !sym.NumberOfAuxSymbols)))
+				address_index_.push_back((static_cast<uint64_t>(sym.Value) << 32) | i);
+		}
 
-					info.set_advanced_debug_info(coff_info);
-				}
-				break;
+		//Symbols with the same address remain in symbol table order
+		std::sort(address_index_.begin(), address_index_.end());
+		address_index_built_ = true;
+	}
 
-				case image_debug_type_codeview:
-				{
-					//Check data length
-					if (debug_data.length() < sizeof(OMFSignature*))
-						throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+	//Returns true if address index is built
+	bool coff_symbol_table_view::has_address_index() const
+	{
+		return address_index_built_;
+	}
 
-					//Get POMFSignature structure pointer from the very beginning of debug data
-					const OMFSignature* sig = reinterpret_cast<const OMFSignature*>(debug_data.data());
-					if (!memcmp(sig->Signature, "RSDS", 4))
-					{
-						//Signature is "RSDS" - PDB 7.0
+	//Returns index of record of symbol by address
+	uint32_t coff_symbol_table_view::find_symbol_by_address(uint32_t rva) const
+	{
+		if (!address_index_built_)
+			throw pe_exception("COFF symbols address index is not built", pe_exception::advanced_debug_information_request_error);
 
-						//Check data length
-						if (debug_data.length() < sizeof(CV_INFO_PDB70))
-							throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+		//Find the last symbol with address not greater than RVA
+		std::pmr::vector<uint64_t>::const_iterator it = std::upper_bound(address_index_.begin(), address_index_.end(), (static_cast<uint64_t>(rva) << 32) | 0xFFFFFFFF);
+		if (it == address_index_.begin())
+			return npos;
 
-						const CV_INFO_PDB70* pdb_data = reinterpret_cast<const CV_INFO_PDB70*>(debug_data.data());
+		//Find the first symbol with the same address
+		uint64_t address = *(it - 1) >> 32;
+		return static_cast<uint32_t>(*std::lower_bound(address_index_.begin(), it, address << 32));
+	}
 
-						//Check PDB file name null-termination
-						if (!pe_utils::is_null_terminated(pdb_data->PdbFileName, debug_data.length() - (sizeof(CV_INFO_PDB70) - 1 /* BYTE of filename in structure */)))
-							throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+	//Returns true if advanced information is read from raw debug data of this directory
+	bool has_advanced_debug_data(const image_debug_directory& directory)
+	{
+		return (directory.Type == image_debug_type_codeview
+			|| directory.Type == image_debug_type_misc
+			|| directory.Type == image_debug_type_coff)
+			&& directory.SizeOfData;
+	}
 
-						info.set_advanced_debug_info(pdb_7_0_info(pdb_data));
+	//Reads advanced debug information of specified type from raw debug data
+	void read_advanced_debug_info(debug_info& info, uint32_t type, std::string_view debug_data, const coff_debug_info::coff_symbol::allocator_type& allocator)
+	{
+		switch (type)
+		{
+		case image_debug_type_coff:
+		{
+			//Check data length
+			if (debug_data.length() < sizeof(image_coff_symbols_header))
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+			//Get coff header structure pointer
+			const image_coff_symbols_header* coff = reinterpret_cast<const image_coff_symbols_header*>(debug_data.data());
+
+			//Check possible overflows
+			if (coff->NumberOfSymbols >= pe_utils::max_dword / sizeof(image_symbol)
+				|| !pe_utils::is_sum_safe(coff->NumberOfSymbols * sizeof(image_symbol), coff->LvaToFirstSymbol))
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+			//Check data length again
+			if (debug_data.length() < coff->NumberOfSymbols * sizeof(image_symbol) + coff->LvaToFirstSymbol)
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+			//Create COFF debug info structure
+			coff_debug_info coff_info(coff, allocator);
+
+			//Enumerate debug symbols data
+			for (uint32_t i = 0; i < coff->NumberOfSymbols; ++i)
+			{
+				//Safe sum (checked above)
+				const image_symbol* sym = reinterpret_cast<const image_symbol*>(debug_data.data() + i * sizeof(image_symbol) + coff->LvaToFirstSymbol);
+
+				coff_debug_info::coff_symbol symbol(allocator);
+				symbol.set_index(i); //Save symbol index
+				symbol.set_storage_class(sym->StorageClass); //Save storage class
+				symbol.set_type(sym->Type); //Save storage class
+
+				//Check data length again
+				if (!pe_utils::is_sum_safe(i, sym->NumberOfAuxSymbols)
+					|| (i + sym->NumberOfAuxSymbols) > coff->NumberOfSymbols
+					|| debug_data.length() < (i + 1) * sizeof(image_symbol) + coff->LvaToFirstSymbol + sym->NumberOfAuxSymbols * sizeof(image_symbol))
+					throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+				//If symbol is filename
+				if (sym->StorageClass == image_sym_class_file)
+				{
+					//Save file name, it is situated just after this IMAGE_SYMBOL structure
+					std::string_view file_name(debug_data.data() + (i + 1) * sizeof(image_symbol) + coff->LvaToFirstSymbol, sym->NumberOfAuxSymbols * sizeof(image_symbol));
+					while (!file_name.empty() && !file_name.back())
+						file_name.remove_suffix(1);
+					symbol.set_file_name(file_name);
+
+					//Save symbol info
+					coff_info.add_symbol(std::move(symbol));
+
+					//Move to next symbol
+					i += sym->NumberOfAuxSymbols;
+					continue;
+				}
+
+				//Dump some other symbols
+				if (((sym->StorageClass == image_sym_class_static)
+					&& (sym->NumberOfAuxSymbols == 0)
+					&& (sym->SectionNumber == 1))
+					||
+					((sym->StorageClass == image_sym_class_external)
+						&& ISFCN(sym->Type)
+						&& (sym->SectionNumber > 0))
+					)
+				{
+					//Save RVA and section number
+					symbol.set_section_number(sym->SectionNumber);
+					symbol.set_rva(sym->Value);
+
+					//If symbol has short name
+					if (sym->N.Name.Short)
+					{
+						//Copy and save symbol name
+						char name_buff[9];
+						memcpy(name_buff, sym->N.ShortName, 8);
+						name_buff[8] = '\0';
+						symbol.set_symbol_name(name_buff);
 					}
-					else if (!memcmp(sig->Signature, "NB10", 4))
+					else
 					{
-						//Signature is "NB10" - PDB 2.0
+						//Symbol has long name
 
-						//Check data length
-						if (debug_data.length() < sizeof(CV_INFO_PDB20))
+						//Check possible overflows
+						if (!pe_utils::is_sum_safe(coff->LvaToFirstSymbol + coff->NumberOfSymbols * sizeof(image_symbol), sym->N.Name.Long))
 							throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
 
-						const CV_INFO_PDB20* pdb_data = reinterpret_cast<const CV_INFO_PDB20*>(debug_data.data());
+						//Here we have an offset to the string table
+						uint32_t symbol_offset = coff->LvaToFirstSymbol + coff->NumberOfSymbols * sizeof(image_symbol) + sym->N.Name.Long;
 
-						//Check PDB file name null-termination
-						if (!pe_utils::is_null_terminated(pdb_data->PdbFileName, debug_data.length() - (sizeof(CV_INFO_PDB20) - 1 /* BYTE of filename in structure */)))
+						//Check data length
+						if (debug_data.length() < symbol_offset)
 							throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
 
-						info.set_advanced_debug_info(pdb_2_0_info(pdb_data));
-					}
-					else if (!memcmp(sig->Signature, "NB09", 4))
-					{
-						//CodeView 4.0, no structures available
-						info.set_advanced_info_type(debug_info::advanced_info_codeview_4_0);
-					}
-					else if (!memcmp(sig->Signature, "NB11", 4))
-					{
-						//CodeView 5.0, no structures available
-						info.set_advanced_info_type(debug_info::advanced_info_codeview_5_0);
-					}
-					else if (!memcmp(sig->Signature, "NB05", 4))
-					{
-						//Other CodeView, no structures available
-						info.set_advanced_info_type(debug_info::advanced_info_codeview);
+						//Check symbol name for null-termination
+						if (!pe_utils::is_null_terminated(debug_data.data() + symbol_offset, debug_data.length() - symbol_offset))
+							throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+						//Save symbol name
+						symbol.set_symbol_name(debug_data.data() + symbol_offset);
 					}
+
+					//Save symbol info
+					coff_info.add_symbol(std::move(symbol));
+
+					//Move to next symbol
+					i += sym->NumberOfAuxSymbols;
+					continue;
 				}
+			}
 
-				break;
+			info.set_advanced_debug_info(std::move(coff_info));
+		}
+		break;
 
-				case image_debug_type_misc:
-				{
-					//Check data length
-					if (debug_data.length() < sizeof(image_debug_misc))
-						throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+		case image_debug_type_codeview:
+		{
+			//Check data length
+			if (debug_data.length() < sizeof(OMFSignature*))
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
 
-					//Get misc structure pointer
-					const image_debug_misc* misc_data = reinterpret_cast<const image_debug_misc*>(debug_data.data());
+			//Get POMFSignature structure pointer from the very beginning of debug data
+			const OMFSignature* sig = reinterpret_cast<const OMFSignature*>(debug_data.data());
+			if (!memcmp(sig->Signature, "RSDS", 4))
+			{
+				//Signature is "RSDS" - PDB 7.0
 
-					//Check misc data length
-					if (debug_data.length() < misc_data->Length /* Total length of record */)
-						throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+				//Check data length
+				if (debug_data.length() < sizeof(CV_INFO_PDB70))
+					throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
 
-					//Save advanced information
-					info.set_advanced_debug_info(misc_debug_info(misc_data));
-				}
-				break;
-				}
+				const CV_INFO_PDB70* pdb_data = reinterpret_cast<const CV_INFO_PDB70*>(debug_data.data());
+
+				//Check PDB file name null-termination
+				if (!pe_utils::is_null_terminated(pdb_data->PdbFileName, debug_data.length() - (sizeof(CV_INFO_PDB70) - 1 /* BYTE of filename in structure */)))
+					throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+				info.set_advanced_debug_info(pdb_7_0_info(pdb_data));
+			}
+			else if (!memcmp(sig->Signature, "NB10", 4))
+			{
+				//Signature is "NB10" - PDB 2.0
+
+				//Check data length
+				if (debug_data.length() < sizeof(CV_INFO_PDB20))
+					throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+				const CV_INFO_PDB20* pdb_data = reinterpret_cast<const CV_INFO_PDB20*>(debug_data.data());
+
+				//Check PDB file name null-termination
+				if (!pe_utils::is_null_terminated(pdb_data->PdbFileName, debug_data.length() - (sizeof(CV_INFO_PDB20) - 1 /* BYTE of filename in structure */)))
+					throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+				info.set_advanced_debug_info(pdb_2_0_info(pdb_data));
+			}
+			else if (!memcmp(sig->Signature, "NB09", 4))
+			{
+				//CodeView 4.0, no structures available
+				info.set_advanced_info_type(debug_info::advanced_info_codeview_4_0);
 			}
+			else if (!memcmp(sig->Signature, "NB11", 4))
+			{
+				//CodeView 5.0, no structures available
+				info.set_advanced_info_type(debug_info::advanced_info_codeview_5_0);
+			}
+			else if (!memcmp(sig->Signature, "NB05", 4))
+			{
+				//Other CodeView, no structures available
+				info.set_advanced_info_type(debug_info::advanced_info_codeview);
+			}
+		}
+
+		break;
+
+		case image_debug_type_misc:
+		{
+			//Check data length
+			if (debug_data.length() < sizeof(image_debug_misc))
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+			//Get misc structure pointer
+			const image_debug_misc* misc_data = reinterpret_cast<const image_debug_misc*>(debug_data.data());
+
+			//Check misc data length
+			if (debug_data.length() < misc_data->Length /* Total length of record */)
+				throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+			//Save advanced information
+			info.set_advanced_debug_info(misc_debug_info(misc_data));
+		}
+		break;
+		}
+	}
+
+	//Returns debug information list, raw debug data of each directory is requested from source
+	//Source returns empty view, if raw debug data is not available
+	template<typename Source>
+	debug_info_list read_debug_information(const pe_base& pe, std::pmr::memory_resource* resource, Source source)
+	{
+		debug_info_list ret(resource);
+
+		//If there's no debug directory, return empty list
+		if (!pe.has_debug())
+			return ret;
+
+		//Check the length in bytes of the section containing debug directory
+		if (pe.section_data_length_from_rva(pe.get_directory_rva(image_directory_entry_debug), pe.get_directory_rva(image_directory_entry_debug), section_data_virtual, true)
+			< sizeof(image_debug_directory))
+			throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+		unsigned long current_pos = pe.get_directory_rva(image_directory_entry_debug);
+
+		//First IMAGE_DEBUG_DIRECTORY table
+		image_debug_directory directory = pe.section_data_from_rva<image_debug_directory>(current_pos, section_data_virtual, true);
+
+		if (!pe_utils::is_sum_safe(pe.get_directory_rva(image_directory_entry_debug), pe.get_directory_size(image_directory_entry_debug)))
+			throw pe_exception("Incorrect debug directory", pe_exception::incorrect_debug_directory);
+
+		//Iterate over all IMAGE_DEBUG_DIRECTORY directories
+		while (directory.PointerToRawData
+			&& current_pos < pe.get_directory_rva(image_directory_entry_debug) + pe.get_directory_size(image_directory_entry_debug))
+		{
+			//Create debug information structure
+			debug_info info(directory);
+
+			//Get raw debug data
+			std::string_view debug_data = source(directory);
+			if (!debug_data.empty()) //If it exists, we'll do some detailed debug info research
+				read_advanced_debug_info(info, directory.Type, debug_data, ret.get_allocator());
 
 			//Save debug information structure
-			ret.push_back(info);
+			ret.push_back(std::move(info));
 
 			//Check possible overflow
 			if (!pe_utils::is_sum_safe(current_pos, sizeof(image_debug_directory)))
@@ -841,4 +1147,58 @@ namespace pe_bliss
 
 		return ret;
 	}
+
+	//Returns debug information list
+	debug_info_list get_debug_information(const pe_base& pe, std::pmr::memory_resource* resource)
+	{
+		const pe_base::debug_data_list& debug_datas = pe.get_raw_debug_data_list();
+		return read_debug_information(pe, resource, [&debug_datas](const image_debug_directory& directory)
+		{
+			pe_base::debug_data_list::const_iterator it = debug_datas.find(directory.PointerToRawData);
+			return it == debug_datas.end() ? std::string_view() : std::string_view((*it).second);
+		});
+	}
+
+	//Returns debug information list, raw debug data is viewed in the whole file data
+	debug_info_list get_debug_information(const pe_base& pe, std::string_view file_data, std::pmr::memory_resource* resource)
+	{
+		return read_debug_information(pe, resource, [file_data](const image_debug_directory& directory)
+		{
+			if (!has_advanced_debug_data(directory)
+				|| static_cast<uint64_t>(directory.PointerToRawData) + directory.SizeOfData > file_data.size())
+				return std::string_view();
+
+			return file_data.substr(directory.PointerToRawData, directory.SizeOfData);
+		});
+	}
+
+	//Returns debug information list, raw debug data is read from file
+	debug_info_list get_debug_information(const pe_base& pe, std::istream& file, std::pmr::memory_resource* resource)
+	{
+		//Get file size to check raw debug data bounds before reading it
+		file.clear();
+		file.seekg(0, std::ios::end);
+		uint64_t file_size = static_cast<uint64_t>(file.tellg());
+
+		//Buffer is reused for all directories, each directory is parsed before the next one is read
+		std::string buffer;
+		return read_debug_information(pe, resource, [&file, file_size, &buffer](const image_debug_directory& directory)
+		{
+			if (!has_advanced_debug_data(directory)
+				|| static_cast<uint64_t>(directory.PointerToRawData) + directory.SizeOfData > file_size)
+				return std::string_view();
+
+			buffer.resize(directory.SizeOfData);
+			file.seekg(directory.PointerToRawData);
+			file.read(&buffer[0], directory.SizeOfData);
+			if (file.bad() || file.eof())
+			{
+				//Don't throw any exception here, raw debug data is just not available
+				file.clear();
+				return std::string_view();
+			}
+
+			return std::string_view(buffer);
+		});
+	}
 }
@@ -0,0 +1,393 @@
+#include "pe_delay_import.h"
+#include "pe_properties_generic.h"
+#include "utils.h"
+
+namespace pe_bliss
+{
+	using namespace pe_win;
+
+	//DELAY IMPORT
+	//Default constructor
+	delay_import_library::delay_import_library()
+		:attributes_(0), rva_to_module_handle_(0), rva_to_iat_(0), rva_to_name_table_(0),
+		rva_to_bound_iat_(0), rva_to_unload_info_(0), timestamp_(0)
+	{}
+
+	//Constructor with allocator
+	delay_import_library::delay_import_library(const allocator_type& allocator)
+		:name_(allocator), attributes_(0), rva_to_module_handle_(0), rva_to_iat_(0), rva_to_name_table_(0),
+		rva_to_bound_iat_(0), rva_to_unload_info_(0), timestamp_(0), imports_(allocator)
+	{}
+
+	//Allocator-extended copy constructor
+	delay_import_library::delay_import_library(const delay_import_library& other, const allocator_type& allocator)
+		:name_(other.name_, allocator), attributes_(other.attributes_),
+		rva_to_module_handle_(other.rva_to_module_handle_), rva_to_iat_(other.rva_to_iat_), rva_to_name_table_(other.rva_to_name_table_),
+		rva_to_bound_iat_(other.rva_to_bound_iat_), rva_to_unload_info_(other.rva_to_unload_info_), timestamp_(other.timestamp_),
+		imports_(other.imports_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	delay_import_library::delay_import_library(delay_import_library&& other, const allocator_type& allocator)
+		:name_(std::move(other.name_), allocator), attributes_(other.attributes_),
+		rva_to_module_handle_(other.rva_to_module_handle_), rva_to_iat_(other.rva_to_iat_), rva_to_name_table_(other.rva_to_name_table_),
+		rva_to_bound_iat_(other.rva_to_bound_iat_), rva_to_unload_info_(other.rva_to_unload_info_), timestamp_(other.timestamp_),
+		imports_(std::move(other.imports_), allocator)
+	{}
+
+	//Returns name of library
+	std::string_view delay_import_library::get_name() const
+	{
+		return name_.get();
+	}
+
+	//Returns name of library as std::string
+	std::string delay_import_library::get_name_string() const
+	{
+		return std::string(get_name());
+	}
+
+	//Returns ID of library name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t delay_import_library::get_name_id() const
+	{
+		return name_.get_id();
+	}
+
+	//Returns descriptor attributes
+	uint32_t delay_import_library::get_attributes() const
+	{
+		return attributes_;
+	}
+
+	//Returns true if descriptor addresses are RVAs
+	bool delay_import_library::is_rva_based() const
+	{
+		return (attributes_ & image_delayload_rva_based) != 0;
+	}
+
+	//Returns RVA to library module handle
+	uint32_t delay_import_library::get_rva_to_module_handle() const
+	{
+		return rva_to_module_handle_;
+	}
+
+	//Returns RVA to Import Address Table (IAT)
+	uint32_t delay_import_library::get_rva_to_iat() const
+	{
+		return rva_to_iat_;
+	}
+
+	//Returns RVA to Import Name Table
+	uint32_t delay_import_library::get_rva_to_name_table() const
+	{
+		return rva_to_name_table_;
+	}
+
+	//Returns RVA to bound IAT
+	uint32_t delay_import_library::get_rva_to_bound_iat() const
+	{
+		return rva_to_bound_iat_;
+	}
+
+	//Returns RVA to unload information table
+	uint32_t delay_import_library::get_rva_to_unload_info() const
+	{
+		return rva_to_unload_info_;
+	}
+
+	//Returns timestamp of library image bound to
+	uint32_t delay_import_library::get_timestamp() const
+	{
+		return timestamp_;
+	}
+
+	//Returns imported functions list
+	const delay_import_library::imported_list& delay_import_library::get_imported_functions() const
+	{
+		return imports_;
+	}
+
+	//Sets name of library
+	void delay_import_library::set_name(std::string_view name)
+	{
+		name_.set(name);
+	}
+
+	//Sets name of library interned in pool
+	void delay_import_library::set_name(std::string_view name, name_pool& pool)
+	{
+		name_.set(name, pool);
+	}
+
+	//Sets descriptor attributes
+	void delay_import_library::set_attributes(uint32_t attributes)
+	{
+		attributes_ = attributes;
+	}
+
+	//Sets RVA to library module handle
+	void delay_import_library::set_rva_to_module_handle(uint32_t rva)
+	{
+		rva_to_module_handle_ = rva;
+	}
+
+	//Sets RVA to Import Address Table (IAT)
+	void delay_import_library::set_rva_to_iat(uint32_t rva)
+	{
+		rva_to_iat_ = rva;
+	}
+
+	//Sets RVA to Import Name Table
+	void delay_import_library::set_rva_to_name_table(uint32_t rva)
+	{
+		rva_to_name_table_ = rva;
+	}
+
+	//Sets RVA to bound IAT
+	void delay_import_library::set_rva_to_bound_iat(uint32_t rva)
+	{
+		rva_to_bound_iat_ = rva;
+	}
+
+	//Sets RVA to unload information table
+	void delay_import_library::set_rva_to_unload_info(uint32_t rva)
+	{
+		rva_to_unload_info_ = rva;
+	}
+
+	//Sets timestamp
+	void delay_import_library::set_timestamp(uint32_t timestamp)
+	{
+		timestamp_ = timestamp;
+	}
+
+	//Adds imported function
+	void delay_import_library::add_import(const imported_function& func)
+	{
+		imports_.push_back(func);
+	}
+
+	//Adds imported function
+	void delay_import_library::add_import(imported_function&& func)
+	{
+		imports_.push_back(std::move(func));
+	}
+
+	//Clears imported functions list
+	void delay_import_library::clear_imports()
+	{
+		imports_.clear();
+	}
+
+	//Helper function to convert address from delay import descriptor or name table to RVA
+	//Old VA-based descriptors hold VAs, zero address is left as is
+	static uint32_t delay_import_address_to_rva(const pe_base& pe, uint64_t address, bool rva_based)
+	{
+		if (rva_based || !address)
+		{
+			if (address > pe_utils::max_dword)
+				throw pe_exception("Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+
+			return static_cast<uint32_t>(address);
+		}
+
+		uint64_t image_base = pe.get_image_base_64();
+		if (address < image_base || address - image_base > pe_utils::max_dword)
+			throw pe_exception("Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+
+		return static_cast<uint32_t>(address - image_base);
+	}
+
+	//Helper function to read null-terminated string by RVA
+	static const char* read_delay_import_name(pe_data_cursor& cursor, uint32_t rva)
+	{
+		return cursor.read_string(rva, "Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+	}
+
+	delay_imported_functions_list get_delay_imported_functions(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
+	{
+		return (pe.get_pe_type() == pe_type_32 ?
+			get_delay_imported_functions_base<pe_types_class_32>(pe, resource, names)
+			: get_delay_imported_functions_base<pe_types_class_64>(pe, resource, names));
+	}
+
+	//Reads delay-loaded imported functions list with related libraries info and appends it to "ret"
+	template<typename PEClassType>
+	void read_delay_imported_functions_base(pe_data_cursor& cursor, delay_imported_functions_list& ret, name_pool* names)
+	{
+		const pe_base& pe = cursor.get_pe();
+
+		//If image has no delay imports, nothing is read
+		if (!pe.has_delay_import())
+			return;
+
+		uint32_t current_descriptor_pos = pe.get_directory_rva(image_directory_entry_delay_import);
+
+		while (true)
+		{
+			image_delayload_descriptor descriptor = cursor.read<image_delayload_descriptor>(current_descriptor_pos);
+
+			//Iterate descriptors until we reach zero-element
+			if (!descriptor.DllNameRVA)
+				break;
+
+			bool rva_based = (descriptor.Attributes & image_delayload_rva_based) != 0;
+
+			delay_import_library lib(ret.get_allocator());
+			lib.set_attributes(descriptor.Attributes);
+			lib.set_rva_to_module_handle(delay_import_address_to_rva(pe, descriptor.ModuleHandleRVA, rva_based));
+			lib.set_rva_to_iat(delay_import_address_to_rva(pe, descriptor.ImportAddressTableRVA, rva_based));
+			lib.set_rva_to_name_table(delay_import_address_to_rva(pe, descriptor.ImportNameTableRVA, rva_based));
+			lib.set_rva_to_bound_iat(delay_import_address_to_rva(pe, descriptor.BoundImportAddressTableRVA, rva_based));
+			lib.set_rva_to_unload_info(delay_import_address_to_rva(pe, descriptor.UnloadInformationTableRVA, rva_based));
+			lib.set_timestamp(descriptor.TimeDateStamp);
+
+			//Set library name
+			const char* dll_name = read_delay_import_name(cursor, delay_import_address_to_rva(pe, descriptor.DllNameRVA, rva_based));
+			if (names)
+				lib.set_name(dll_name, *names);
+			else
+				lib.set_name(dll_name);
+
+			//List all imported functions, names are read from name table, IAT holds addresses of delay load helper thunks
+			uint32_t current_name_thunk_rva = lib.get_rva_to_name_table();
+			uint32_t current_thunk_rva = lib.get_rva_to_iat();
+			if (current_name_thunk_rva)
+			{
+				while (true)
+				{
+					typename PEClassType::BaseSize lookup = cursor.read<typename PEClassType::BaseSize>(current_name_thunk_rva);
+					if (!lookup)
+						break;
+
+					imported_function func(ret.get_allocator());
+
+					if (current_thunk_rva)
+					{
+						func.set_iat_va(cursor.read<typename PEClassType::BaseSize>(current_thunk_rva));
+
+						if (!pe_utils::is_sum_safe(current_thunk_rva, sizeof(typename PEClassType::BaseSize)))
+							throw pe_exception("Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+
+						current_thunk_rva += sizeof(typename PEClassType::BaseSize);
+					}
+
+					//Check if function is imported by ordinal
+					if ((lookup & PEClassType::ImportSnapFlag) != 0)
+					{
+						func.set_ordinal(static_cast<uint16_t>(lookup & 0xffff));
+					}
+					else
+					{
+						//Get IMAGE_IMPORT_BY_NAME (WORD hint + string function name)
+						uint32_t import_by_name_rva = delay_import_address_to_rva(pe, lookup, rva_based);
+						if (!pe_utils::is_sum_safe(import_by_name_rva, sizeof(uint16_t)))
+							throw pe_exception("Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+
+						const char* func_name = read_delay_import_name(cursor, static_cast<uint32_t>(import_by_name_rva + sizeof(uint16_t)));
+						if (names)
+							func.set_name(func_name, *names);
+						else
+							func.set_name(func_name);
+						func.set_hint(cursor.read<uint16_t>(import_by_name_rva));
+					}
+
+					lib.add_import(std::move(func));
+
+					if (!pe_utils::is_sum_safe(current_name_thunk_rva, sizeof(typename PEClassType::BaseSize)))
+						throw pe_exception("Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+
+					current_name_thunk_rva += sizeof(typename PEClassType::BaseSize);
+				}
+			}
+
+			ret.push_back(std::move(lib));
+
+			//Check possible overflow
+			if (!pe_utils::is_sum_safe(current_descriptor_pos, sizeof(image_delayload_descriptor)))
+				throw pe_exception("Incorrect delay import directory", pe_exception::incorrect_delay_import_directory);
+
+			//Go to next library
+			current_descriptor_pos += sizeof(image_delayload_descriptor);
+		}
+	}
+
+	//Reads delay-loaded imported functions list with related libraries info and appends it to "imports"
+	void read_delay_imported_functions(pe_data_cursor& cursor, delay_imported_functions_list& imports, name_pool* names)
+	{
+		if (cursor.get_pe().get_pe_type() == pe_type_32)
+			read_delay_imported_functions_base<pe_types_class_32>(cursor, imports, names);
+		else
+			read_delay_imported_functions_base<pe_types_class_64>(cursor, imports, names);
+	}
+
+	//Returns delay-loaded imported functions list with related libraries info
+	template<typename PEClassType>
+	delay_imported_functions_list get_delay_imported_functions_base(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
+	{
+		delay_imported_functions_list ret(resource);
+		pe_data_cursor cursor(pe);
+		read_delay_imported_functions_base<PEClassType>(cursor, ret, names);
+		return ret;
+	}
+
+	//ALL IMPORTS
+	//Default constructor
+	all_imports::all_imports()
+	{}
+
+	//Constructor with allocator
+	all_imports::all_imports(const allocator_type& allocator)
+		:imports_(allocator), delay_imports_(allocator), bound_imports_(allocator)
+	{}
+
+	//Returns regular imported libraries
+	const imported_functions_list& all_imports::get_imports() const
+	{
+		return imports_;
+	}
+
+	//Returns delay-loaded libraries
+	const delay_imported_functions_list& all_imports::get_delay_imports() const
+	{
+		return delay_imports_;
+	}
+
+	//Returns bound imported modules
+	const bound_import_module_list& all_imports::get_bound_imports() const
+	{
+		return bound_imports_;
+	}
+
+	//Returns regular imported libraries
+	imported_functions_list& all_imports::get_imports()
+	{
+		return imports_;
+	}
+
+	//Returns delay-loaded libraries
+	delay_imported_functions_list& all_imports::get_delay_imports()
+	{
+		return delay_imports_;
+	}
+
+	//Returns bound imported modules
+	bound_import_module_list& all_imports::get_bound_imports()
+	{
+		return bound_imports_;
+	}
+
+	//Returns regular, delay-loaded and bound imports of image in one scan
+	all_imports get_all_imports(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
+	{
+		all_imports ret(resource);
+
+		//Import, delay import and bound import data usually lies in one or two sections (or in headers),
+		//so cursor finds section once and all three directories are read from it straight to resulting lists
+		pe_data_cursor cursor(pe);
+		read_imported_functions(cursor, ret.get_imports(), names);
+		read_delay_imported_functions(cursor, ret.get_delay_imports(), names);
+		read_bound_import_module_list(cursor, ret.get_bound_imports(), names);
+		return ret;
+	}
+}
@@ -0,0 +1,498 @@
+#include <set>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <string.h>
+#include "pe_embedded.h"
+#include "pe_factory.h"
+#include "memory_stream.h"
+#include "utils.h"
+
+namespace pe_bliss
+{
+	using namespace pe_win;
+
+	//EMBEDDED PE IMAGES
+	//Default constructor
+	embedded_pe::embedded_pe()
+		:source_(source_overlay), offset_(0), rva_(0), depth_(0), parent_index_(static_cast<std::size_t>(-1)), type_(pe_type_32)
+	{}
+
+	//Constructor from data
+	embedded_pe::embedded_pe(embedded_pe_source source, std::string_view data, uint32_t offset, uint32_t rva, uint32_t depth, pe_type type)
+		:source_(source), data_(data), offset_(offset), rva_(rva), depth_(depth), parent_index_(static_cast<std::size_t>(-1)), type_(type)
+	{}
+
+	//Returns place where image was found
+	embedded_pe::embedded_pe_source embedded_pe::get_source() const
+	{
+		return source_;
+	}
+
+	//Returns offset of image from the beginning of containing data
+	uint32_t embedded_pe::get_offset() const
+	{
+		return offset_;
+	}
+
+	//Returns RVA of image inside scanned image
+	uint32_t embedded_pe::get_rva() const
+	{
+		return rva_;
+	}
+
+	//Returns nesting depth
+	uint32_t embedded_pe::get_depth() const
+	{
+		return depth_;
+	}
+
+	//Returns index of parent image inside scan result list or -1
+	std::size_t embedded_pe::get_parent_index() const
+	{
+		return parent_index_;
+	}
+
+	//Returns PE type of image
+	pe_type embedded_pe::get_pe_type() const
+	{
+		return type_;
+	}
+
+	//Returns size of image
+	uint32_t embedded_pe::get_size() const
+	{
+		return static_cast<uint32_t>(data_.size());
+	}
+
+	//Returns image data view
+	std::string_view embedded_pe::get_data() const
+	{
+		return data_;
+	}
+
+	//Sets index of parent image inside scan result list
+	void embedded_pe::set_parent_index(std::size_t index)
+	{
+		parent_index_ = index;
+	}
+
+	//Creates pe_base from image data
+	pe_base embedded_pe::create_pe(bool read_debug_raw_data) const
+	{
+		memory_istream file(data_);
+		return pe_factory::create_pe(file, read_debug_raw_data);
+	}
+
+	//Default constructor
+	embedded_pe_scan_settings::embedded_pe_scan_settings(uint32_t max_depth, uint32_t max_image_size)
+		:max_depth_(max_depth), max_image_size_(max_image_size), max_threads_(0),
+		scan_resources_(true), scan_sections_(true), scan_overlay_(true)
+	{}
+
+	//Returns maximum nesting depth
+	uint32_t embedded_pe_scan_settings::get_max_depth() const
+	{
+		return max_depth_;
+	}
+
+	//Returns maximum size of embedded image
+	uint32_t embedded_pe_scan_settings::get_max_image_size() const
+	{
+		return max_image_size_;
+	}
+
+	//Returns maximum number of scanning threads
+	uint32_t embedded_pe_scan_settings::get_max_threads() const
+	{
+		return max_threads_;
+	}
+
+	//Returns true if resource data entries will be scanned
+	bool embedded_pe_scan_settings::scan_resources() const
+	{
+		return scan_resources_;
+	}
+
+	//Returns true if section raw data will be scanned
+	bool embedded_pe_scan_settings::scan_sections() const
+	{
+		return scan_sections_;
+	}
+
+	//Returns true if overlay data held by image will be scanned
+	bool embedded_pe_scan_settings::scan_overlay() const
+	{
+		return scan_overlay_;
+	}
+
+	//Sets maximum nesting depth
+	void embedded_pe_scan_settings::set_max_depth(uint32_t max_depth)
+	{
+		max_depth_ = max_depth;
+	}
+
+	//Sets maximum size of embedded image
+	void embedded_pe_scan_settings::set_max_image_size(uint32_t max_image_size)
+	{
+		max_image_size_ = max_image_size;
+	}
+
+	//Sets maximum number of scanning threads
+	void embedded_pe_scan_settings::set_max_threads(uint32_t max_threads)
+	{
+		max_threads_ = max_threads;
+	}
+
+	//Sets if resource data entries will be scanned
+	void embedded_pe_scan_settings::scan_resources(bool enable)
+	{
+		scan_resources_ = enable;
+	}
+
+	//Sets if section raw data will be scanned
+	void embedded_pe_scan_settings::scan_sections(bool enable)
+	{
+		scan_sections_ = enable;
+	}
+
+	//Sets if overlay data held by image will be scanned
+	void embedded_pe_scan_settings::scan_overlay(bool enable)
+	{
+		scan_overlay_ = enable;
+	}
+
+	//Checks if data starts with PE image headers
+	bool check_embedded_pe_headers(std::string_view data, uint32_t& image_size, pe_type& type)
+	{
+		//Data size is limited to 4gb, as for all PE images
+		if (data.size() < sizeof(image_dos_header) || data.size() > pe_utils::max_dword)
+			return false;
+
+		image_dos_header dos_header;
+		memcpy(&dos_header, data.data(), sizeof(dos_header));
+		if (dos_header.e_magic != 0x5a4d) //"MZ"
+			return false;
+
+		//PE header must be DWORD-aligned and the whole IMAGE_FILE_HEADER must be inside data
+		if (dos_header.e_lfanew < 0 || (dos_header.e_lfanew % sizeof(uint32_t)) != 0
+			|| static_cast<uint32_t>(dos_header.e_lfanew) > data.size() - sizeof(uint32_t) - sizeof(image_file_header) - sizeof(uint16_t))
+			return false;
+
+		const uint32_t nt_headers_pos = static_cast<uint32_t>(dos_header.e_lfanew);
+
+		uint32_t signature;
+		memcpy(&signature, data.data() + nt_headers_pos, sizeof(signature));
+		if (signature != 0x4550) //"PE"
+			return false;
+
+		image_file_header file_header;
+		memcpy(&file_header, data.data() + nt_headers_pos + sizeof(uint32_t), sizeof(file_header));
+
+		uint16_t magic;
+		memcpy(&magic, data.data() + nt_headers_pos + sizeof(uint32_t) + sizeof(image_file_header), sizeof(magic));
+
+		uint32_t file_alignment;
+		uint32_t size_of_headers;
+		if (magic == image_nt_optional_hdr32_magic)
+		{
+			if (nt_headers_pos + sizeof(image_nt_headers32) - sizeof(image_data_directory) * image_numberof_directory_entries > data.size())
+				return false;
+
+			image_nt_headers32 headers;
+			memcpy(&headers, data.data() + nt_headers_pos, sizeof(image_nt_headers32) - sizeof(image_data_directory) * image_numberof_directory_entries);
+			file_alignment = headers.OptionalHeader.FileAlignment;
+			size_of_headers = headers.OptionalHeader.SizeOfHeaders;
+			type = pe_type_32;
+		}
+		else if (magic == image_nt_optional_hdr64_magic)
+		{
+			if (nt_headers_pos + sizeof(image_nt_headers64) - sizeof(image_data_directory) * image_numberof_directory_entries > data.size())
+				return false;
+
+			image_nt_headers64 headers;
+			memcpy(&headers, data.data() + nt_headers_pos, sizeof(image_nt_headers64) - sizeof(image_data_directory) * image_numberof_directory_entries);
+			file_alignment = headers.OptionalHeader.FileAlignment;
+			size_of_headers = headers.OptionalHeader.SizeOfHeaders;
+			type = pe_type_64;
+		}
+		else
+		{
+			return false;
+		}
+
+		//Same limits, as pe_base applies when reading image
+		if (file_header.NumberOfSections > 0x60 || !file_alignment || !pe_utils::is_power_of_2(file_alignment))
+			return false;
+
+		//Section table must be inside data
+		const uint64_t first_section = static_cast<uint64_t>(nt_headers_pos) + sizeof(uint32_t) + sizeof(image_file_header) + file_header.SizeOfOptionalHeader;
+		if (first_section + static_cast<uint64_t>(file_header.NumberOfSections) * sizeof(image_section_header) > data.size())
+			return false;
+
+		//Image size is the end of the last raw section data (or headers, if there's no raw data)
+		uint32_t size = std::max<uint32_t>(size_of_headers, static_cast<uint32_t>(first_section + file_header.NumberOfSections * sizeof(image_section_header)));
+		for (uint16_t i = 0; i != file_header.NumberOfSections; ++i)
+		{
+			image_section_header header;
+			memcpy(&header, data.data() + first_section + i * sizeof(image_section_header), sizeof(header));
+
+			if (!header.SizeOfRawData)
+				continue;
+
+			if (!pe_utils::is_sum_safe(pe_utils::align_down(header.PointerToRawData, file_alignment), header.SizeOfRawData))
+				return false;
+
+			size = std::max<uint32_t>(size, pe_utils::align_down(header.PointerToRawData, file_alignment) + header.SizeOfRawData);
+		}
+
+		if (size > data.size())
+			return false;
+
+		image_size = size;
+		return true;
+	}
+
+	//Data region, which is scanned for embedded images
+	struct embedded_pe_scan_region
+	{
+		embedded_pe::embedded_pe_source source;
+		std::string_view data;
+		uint32_t rva; //RVA of data start or zero, if data is not mapped
+	};
+
+	//Scans data for embedded images (and found images for nested ones), appends found images to "found" list
+	//parent_index is index of parent image inside "found" list or -1
+	void scan_embedded_pe(const embedded_pe_scan_region& region, uint32_t depth, std::size_t parent_index, const embedded_pe_scan_settings& settings, embedded_pe_list& found)
+	{
+		//Nested images can't start at the beginning of their parent
+		std::string_view::size_type pos = region.source == embedded_pe::source_embedded_pe ? 1 : 0;
+
+		while ((pos = region.data.find("MZ", pos)) != std::string_view::npos)
+		{
+			uint32_t image_size;
+			pe_type type;
+			if (!check_embedded_pe_headers(region.data.substr(pos), image_size, type) || image_size > settings.get_max_image_size())
+			{
+				++pos;
+				continue;
+			}
+
+			const std::size_t index = found.size();
+			found.push_back(embedded_pe(region.source, region.data.substr(pos, image_size), static_cast<uint32_t>(pos),
+				region.rva ? region.rva + static_cast<uint32_t>(pos) : 0, depth, type));
+			found.back().set_parent_index(parent_index);
+
+			//Scan found image for nested ones
+			if (depth < settings.get_max_depth())
+			{
+				embedded_pe_scan_region nested = { embedded_pe::source_embedded_pe, region.data.substr(pos, image_size), 0 };
+				scan_embedded_pe(nested, depth + 1, index, settings, found);
+			}
+
+			//Nested images were reported already, continue after the end of found image
+			pos += image_size;
+		}
+	}
+
+	//Scans list of regions (in parallel, if allowed by settings)
+	//Returns found images lists for each region, parent indexes are relative to region lists
+	std::vector<embedded_pe_list> scan_embedded_pe(const std::vector<embedded_pe_scan_region>& regions, const embedded_pe_scan_settings& settings)
+	{
+		std::vector<embedded_pe_list> found(regions.size());
+		if (!settings.get_max_depth())
+			return found;
+
+		uint32_t thread_count = settings.get_max_threads() ? settings.get_max_threads() : std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+		thread_count = static_cast<uint32_t>(std::min<std::size_t>(thread_count, regions.size()));
+
+		if (thread_count <= 1)
+		{
+			for (std::size_t i = 0; i != regions.size(); ++i)
+				scan_embedded_pe(regions[i], 1, static_cast<std::size_t>(-1), settings, found[i]);
+
+			return found;
+		}
+
+		//Each worker takes next unscanned region, each region has its own result list
+		std::atomic<std::size_t> next_region(0);
+		std::vector<std::future<void> > workers;
+		for (uint32_t i = 0; i != thread_count; ++i)
+		{
+			workers.push_back(std::async(std::launch::async, [&regions, &settings, &found, &next_region]()
+				{
+					for (std::size_t region = next_region++; region < regions.size(); region = next_region++)
+						scan_embedded_pe(regions[region], 1, static_cast<std::size_t>(-1), settings, found[region]);
+				}));
+		}
+
+		//Wait for all workers, rethrow first error, if any
+		for (std::size_t i = 0; i != workers.size(); ++i)
+			workers[i].wait();
+		for (std::size_t i = 0; i != workers.size(); ++i)
+			workers[i].get();
+
+		return found;
+	}
+
+	//Appends region result list to resulting list, fixing parent indexes
+	//Images with RVAs from skip_rvas set are skipped together with their nested images
+	void append_embedded_pe(embedded_pe_list& ret, const embedded_pe_list& found, const std::set<uint32_t>* skip_rvas)
+	{
+		//New indexes of images from "found" list (-1 for skipped ones)
+		std::vector<std::size_t> new_indexes(found.size(), static_cast<std::size_t>(-1));
+
+		for (std::size_t i = 0; i != found.size(); ++i)
+		{
+			embedded_pe image(found[i]);
+			if (image.get_parent_index() != static_cast<std::size_t>(-1))
+			{
+				//Skip image, if its parent was skipped
+				if (new_indexes[image.get_parent_index()] == static_cast<std::size_t>(-1))
+					continue;
+
+				image.set_parent_index(new_indexes[image.get_parent_index()]);
+			}
+			else if (skip_rvas && skip_rvas->count(image.get_rva()))
+			{
+				continue;
+			}
+
+			new_indexes[i] = ret.size();
+			ret.push_back(image);
+		}
+	}
+
+	//Collects RVAs and sizes of resource data entries
+	//Resource directory loops are skipped
+	void collect_embedded_pe_resource_leaves(const pe_base& pe, uint32_t res_rva, uint32_t offset_to_directory, std::set<uint32_t>& processed, std::vector<std::pair<uint32_t, uint32_t> >& leaves)
+	{
+		if (!processed.insert(offset_to_directory).second || !pe_utils::is_sum_safe(res_rva, offset_to_directory))
+			return;
+
+		image_resource_directory directory = pe.section_data_from_rva<image_resource_directory>(res_rva + offset_to_directory, section_data_virtual, true);
+
+		const uint32_t number_of_entries = static_cast<uint32_t>(directory.NumberOfIdEntries) + directory.NumberOfNamedEntries;
+		if (!pe_utils::is_sum_safe(res_rva + offset_to_directory, sizeof(image_resource_directory) + number_of_entries * sizeof(image_resource_directory_entry)))
+			throw pe_exception("Incorrect resource directory", pe_exception::incorrect_resource_directory);
+
+		for (uint32_t i = 0; i != number_of_entries; ++i)
+		{
+			image_resource_directory_entry dir_entry = pe.section_data_from_rva<image_resource_directory_entry>(
+				res_rva + sizeof(image_resource_directory) + i * sizeof(image_resource_directory_entry) + offset_to_directory, section_data_virtual, true);
+
+			if (dir_entry.DataIsDirectory)
+			{
+				collect_embedded_pe_resource_leaves(pe, res_rva, dir_entry.OffsetToDirectory, processed, leaves);
+			}
+			else
+			{
+				if (!pe_utils::is_sum_safe(res_rva, dir_entry.OffsetToData))
+					throw pe_exception("Incorrect resource directory", pe_exception::incorrect_resource_directory);
+
+				image_resource_data_entry data_entry = pe.section_data_from_rva<image_resource_data_entry>(res_rva + dir_entry.OffsetToData, section_data_virtual, true);
+				if (data_entry.Size)
+					leaves.push_back(std::make_pair(data_entry.OffsetToData, data_entry.Size));
+			}
+		}
+	}
+
+	//Scans resource data entries and section raw data of image for embedded PE images
+	embedded_pe_list find_embedded_pe(const pe_base& pe, const embedded_pe_scan_settings& settings)
+	{
+		std::vector<std::pair<uint32_t, uint32_t> > leaves;
+		if (settings.scan_resources() && pe.has_resources())
+		{
+			try
+			{
+				std::set<uint32_t> processed;
+				collect_embedded_pe_resource_leaves(pe, pe.get_directory_rva(image_directory_entry_resource), 0, processed, leaves);
+			}
+			catch (const pe_exception&)
+			{
+				//Scan resource data entries that were collected before corrupted part of resource directory
+			}
+		}
+
+		//Virtual section data could be mapped when reading resource directory,
+		//unmap it before taking any views, so they won't be invalidated later
+		const section_list& sections = pe.get_image_sections();
+		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
+			(*it).get_raw_data();
+
+		std::vector<embedded_pe_scan_region> regions;
+		for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = leaves.begin(); it != leaves.end(); ++it)
+		{
+			try
+			{
+				//Resource data is scanned as it is stored in file (raw data only)
+				const section& s = pe.section_from_rva((*it).first);
+				const std::string& raw_data = s.get_raw_data();
+				const uint32_t offset = (*it).first - s.get_virtual_address();
+				if (offset >= raw_data.length())
+					continue;
+
+				embedded_pe_scan_region region = { embedded_pe::source_resource,
+					std::string_view(raw_data).substr(offset, (*it).second), (*it).first };
+				regions.push_back(region);
+			}
+			catch (const pe_exception&)
+			{
+				//Resource data is not inside any section
+			}
+		}
+
+		const std::size_t resource_regions = regions.size();
+
+		if (settings.scan_sections())
+		{
+			for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
+			{
+				embedded_pe_scan_region region = { embedded_pe::source_section, (*it).get_raw_data(), (*it).get_virtual_address() };
+				regions.push_back(region);
+			}
+		}
+
+		const std::size_t section_regions = regions.size();
+
+		if (settings.scan_overlay() && !pe.get_overlay_data().empty())
+		{
+			embedded_pe_scan_region region = { embedded_pe::source_overlay, pe.get_overlay_data(), 0 };
+			regions.push_back(region);
+		}
+
+		const std::vector<embedded_pe_list> found = scan_embedded_pe(regions, settings);
+
+		embedded_pe_list ret;
+		std::set<uint32_t> resource_rvas;
+		for (std::size_t i = 0; i != found.size(); ++i)
+		{
+			//Images from resources were found already, don't report them again as section data
+			append_embedded_pe(ret, found[i], i < resource_regions || i >= section_regions ? 0 : &resource_rvas);
+
+			if (i < resource_regions)
+			{
+				for (embedded_pe_list::const_iterator image = found[i].begin(); image != found[i].end(); ++image)
+				{
+					if ((*image).get_depth() == 1)
+						resource_rvas.insert((*image).get_rva());
+				}
+			}
+		}
+
+		return ret;
+	}
+
+	//Scans raw data buffer for embedded PE images
+	embedded_pe_list find_embedded_pe(std::string_view data, const embedded_pe_scan_settings& settings)
+	{
+		std::vector<embedded_pe_scan_region> regions;
+		embedded_pe_scan_region region = { embedded_pe::source_overlay, data, 0 };
+		regions.push_back(region);
+
+		embedded_pe_list ret;
+		append_embedded_pe(ret, scan_embedded_pe(regions, settings)[0], 0);
+		return ret;
+	}
+}
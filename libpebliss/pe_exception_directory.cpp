@@ -1,3 +1,6 @@
+#include <string.h>
+#include <stddef.h>
+#include <algorithm>
 #include "pe_exception_directory.h"
 
 namespace pe_bliss
@@ -111,7 +114,7 @@ namespace pe_bliss
 
 	//Returns exception directory data (exists on PE+ only)
 	//Unwind opcodes are not listed, because their format and list are subject to change
-	const exception_entry_list get_exception_directory_data(const pe_base& pe)
+	exception_entry_list get_exception_directory_data(const pe_base& pe)
 	{
 		exception_entry_list ret;
 
@@ -153,4 +156,397 @@ namespace pe_bliss
 
 		return ret;
 	}
+
+	//UNWIND PLAN
+	//Default constructor
+	unwind_plan::unwind_plan()
+		:unwind_info_address_(0),
+		version_(0),
+		flags_(0),
+		size_of_prolog_(0),
+		frame_register_(0), frame_offset_(0),
+		handler_address_(0), handler_data_address_(0),
+		chained_plan_(0)
+	{
+		memset(&chained_function_, 0, sizeof(chained_function_));
+	}
+
+	//Returns RVA of unwind info
+	uint32_t unwind_plan::get_unwind_info_address() const
+	{
+		return unwind_info_address_;
+	}
+
+	//Returns UNWIND_INFO structure version
+	uint8_t unwind_plan::get_version() const
+	{
+		return version_;
+	}
+
+	//Returns unwind info flags
+	uint8_t unwind_plan::get_flags() const
+	{
+		return flags_;
+	}
+
+	//Returns size of function prolog
+	uint8_t unwind_plan::get_size_of_prolog() const
+	{
+		return size_of_prolog_;
+	}
+
+	//Returns number of the nonvolatile register used as the frame pointer
+	uint8_t unwind_plan::get_frame_pointer_register_number() const
+	{
+		return frame_register_;
+	}
+
+	//Returns scaled offset from RSP that is applied to the FP reg when it is established
+	uint8_t unwind_plan::get_scaled_rsp_offset() const
+	{
+		return frame_offset_;
+	}
+
+	//Returns unwind operations
+	const unwind_plan::operation_list& unwind_plan::get_operations() const
+	{
+		return operations_;
+	}
+
+	//Returns RVA of exception or termination handler
+	uint32_t unwind_plan::get_handler_address() const
+	{
+		return handler_address_;
+	}
+
+	//Returns RVA of language-specific handler data
+	uint32_t unwind_plan::get_handler_data_address() const
+	{
+		return handler_data_address_;
+	}
+
+	//Returns true if unwind info is chained
+	bool unwind_plan::is_chained() const
+	{
+		return chained_plan_ != 0;
+	}
+
+	//Returns function entry, which unwind info is chained to
+	const image_runtime_function_entry& unwind_plan::get_chained_function() const
+	{
+		return chained_function_;
+	}
+
+	//Returns unwind plan of chained function entry
+	const unwind_plan* unwind_plan::get_chained_plan() const
+	{
+		return chained_plan_;
+	}
+
+	//Returns the last plan in chain
+	const unwind_plan& unwind_plan::get_primary_plan() const
+	{
+		const unwind_plan* plan = this;
+		while (plan->chained_plan_)
+			plan = plan->chained_plan_;
+
+		return *plan;
+	}
+
+	//Sets UNWIND_INFO header data
+	void unwind_plan::set_unwind_info(uint32_t address, const unwind_info& info)
+	{
+		unwind_info_address_ = address;
+		version_ = info.Version;
+		flags_ = info.Flags;
+		size_of_prolog_ = info.SizeOfProlog;
+		frame_register_ = info.FrameRegister;
+		frame_offset_ = info.FrameOffset;
+		operations_.reserve(info.CountOfCodes);
+	}
+
+	//Adds unwind operation
+	void unwind_plan::add_operation(const unwind_operation& operation)
+	{
+		operations_.push_back(operation);
+	}
+
+	//Sets handler and its data addresses
+	void unwind_plan::set_handler(uint32_t handler_address, uint32_t handler_data_address)
+	{
+		handler_address_ = handler_address;
+		handler_data_address_ = handler_data_address;
+	}
+
+	//Sets chained function entry and its plan
+	void unwind_plan::set_chained(const image_runtime_function_entry& function, const unwind_plan* plan)
+	{
+		chained_function_ = function;
+		chained_plan_ = plan;
+	}
+
+	//RUNTIME FUNCTION INDEX
+	//Maximum length of unwind info chain (longer chains are treated as looped)
+	const uint32_t max_unwind_chain_depth = 32;
+	//Size of UNWIND_INFO header (without unwind codes)
+	const uint32_t unwind_info_header_size = 4;
+
+	//Reads 16-bit or 32-bit value from (possibly not aligned) data
+	uint32_t read_unwind_word(const char* data)
+	{
+		uint16_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint32_t read_unwind_dword(const char* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	//Constructor from image
+	runtime_function_index::runtime_function_index(const pe_base& pe)
+		:pe_(pe), functions_(0), count_(0)
+	{
+		//If image doesn't have exception directory, index is empty
+		if (!pe.has_exception_directory())
+			return;
+
+		uint32_t rva = pe.get_directory_rva(image_directory_entry_exception);
+
+		//Check the length in bytes of the section containing exception directory
+		uint32_t length = pe.section_data_length_from_rva(rva, rva, section_data_virtual, true);
+		if (length < sizeof(image_runtime_function_entry))
+			throw pe_exception("Incorrect exception directory", pe_exception::incorrect_exception_directory);
+
+		//Check if structures are DWORD-aligned
+		if (rva % sizeof(uint32_t))
+			throw pe_exception("Incorrect exception directory", pe_exception::incorrect_exception_directory);
+
+		functions_ = pe.section_data_from_rva(rva, section_data_virtual, true);
+
+		//Entries end at the end of directory, section data or at the first zero entry
+		std::size_t max_count = std::min(length, pe.get_directory_size(image_directory_entry_exception)) / sizeof(image_runtime_function_entry);
+		while (count_ < max_count && get_begin_address(count_))
+		{
+			//Check that entries are sorted, so they can be binary-searched
+			if (get_begin_address(count_) > get_end_address(count_)
+				|| (count_ && get_end_address(count_ - 1) > get_begin_address(count_)))
+				throw pe_exception("Incorrect exception directory", pe_exception::incorrect_exception_directory);
+
+			++count_;
+		}
+
+		function_plans_.resize(count_);
+	}
+
+	//Returns number of function entries
+	std::size_t runtime_function_index::size() const
+	{
+		return count_;
+	}
+
+	//Returns BeginAddress of function entry
+	uint32_t runtime_function_index::get_begin_address(std::size_t index) const
+	{
+		return read_unwind_dword(functions_ + index * sizeof(image_runtime_function_entry) + offsetof(image_runtime_function_entry, BeginAddress));
+	}
+
+	//Returns EndAddress of function entry
+	uint32_t runtime_function_index::get_end_address(std::size_t index) const
+	{
+		return read_unwind_dword(functions_ + index * sizeof(image_runtime_function_entry) + offsetof(image_runtime_function_entry, EndAddress));
+	}
+
+	//Returns function entry by index
+	image_runtime_function_entry runtime_function_index::get_function(std::size_t index) const
+	{
+		if (index >= count_)
+			throw pe_exception("Incorrect function entry index", pe_exception::incorrect_exception_directory);
+
+		image_runtime_function_entry function;
+		memcpy(&function, functions_ + index * sizeof(image_runtime_function_entry), sizeof(function));
+		return function;
+	}
+
+	//Returns index of function entry, which contains RVA
+	std::size_t runtime_function_index::find_function(uint32_t rva) const
+	{
+		//Find the first entry, which begins after RVA
+		std::size_t first = 0, count = count_;
+		while (count)
+		{
+			std::size_t step = count / 2;
+			if (get_begin_address(first + step) <= rva)
+			{
+				first += step + 1;
+				count -= step + 1;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+
+		//Previous entry is the only one, which may contain RVA
+		return first && rva < get_end_address(first - 1) ? first - 1 : npos;
+	}
+
+	//Returns unwind plan of function entry by index
+	const unwind_plan& runtime_function_index::get_unwind_plan(std::size_t index)
+	{
+		if (index >= count_)
+			throw pe_exception("Incorrect function entry index", pe_exception::incorrect_exception_directory);
+
+		if (!function_plans_[index])
+			function_plans_[index] = &decode_unwind_info(get_function(index).UnwindInfoAddress, 0);
+
+		return *function_plans_[index];
+	}
+
+	//Returns unwind plan of function entry, which contains RVA
+	const unwind_plan* runtime_function_index::find_unwind_plan(uint32_t rva)
+	{
+		std::size_t index = find_function(rva);
+		return index == npos ? 0 : &get_unwind_plan(index);
+	}
+
+	//Decodes unwind info of all function entries
+	void runtime_function_index::decode_all()
+	{
+		for (std::size_t i = 0; i < count_; ++i)
+			get_unwind_plan(i);
+	}
+
+	//Decodes unwind info at RVA (and chained unwind info), returns cached plan
+	const unwind_plan& runtime_function_index::decode_unwind_info(uint32_t address, uint32_t chain_depth)
+	{
+		std::unordered_map<uint32_t, std::size_t>::const_iterator it = plan_indexes_.find(address);
+		if (it != plan_indexes_.end())
+			return plans_[(*it).second];
+
+		if (chain_depth > max_unwind_chain_depth)
+			throw pe_exception("Incorrect unwind info chain", pe_exception::incorrect_exception_directory);
+
+		//Check unwind info length
+		uint32_t length = pe_.section_data_length_from_rva(address, address, section_data_virtual, true);
+		if (length < unwind_info_header_size)
+			throw pe_exception("Incorrect unwind info", pe_exception::incorrect_exception_directory);
+
+		const char* data = pe_.section_data_from_rva(address, section_data_virtual, true);
+
+		unwind_info info;
+		memcpy(&info, data, unwind_info_header_size);
+		if (info.Version != 1 && info.Version != 2)
+			throw pe_exception("Incorrect unwind info version", pe_exception::incorrect_exception_directory);
+
+		//Unwind codes array is DWORD-aligned, handler address or chained function entry follow it
+		uint32_t codes_end = unwind_info_header_size + ((info.CountOfCodes + 1) & ~1) * sizeof(uint16_t);
+		uint32_t needed_length = codes_end;
+		if (info.Flags & unw_flag_chaininfo)
+			needed_length += sizeof(image_runtime_function_entry);
+		else if (info.Flags & (unw_flag_ehandler | unw_flag_uhandler))
+			needed_length += sizeof(uint32_t);
+
+		if (length < needed_length)
+			throw pe_exception("Incorrect unwind info", pe_exception::incorrect_exception_directory);
+
+		unwind_plan plan;
+		plan.set_unwind_info(address, info);
+
+		const char* codes = data + unwind_info_header_size;
+		for (uint32_t i = 0; i < info.CountOfCodes;)
+		{
+			unwind_operation operation;
+			operation.code_offset = static_cast<uint8_t>(codes[i * sizeof(uint16_t)]);
+			operation.operation = static_cast<uint8_t>(codes[i * sizeof(uint16_t) + 1]) & 0x0F;
+			operation.info = static_cast<uint8_t>(codes[i * sizeof(uint16_t) + 1]) >> 4;
+			operation.operand = 0;
+
+			//Number of slots used by operation
+			uint32_t slots = 1;
+			switch (operation.operation)
+			{
+			case uwop_push_nonvol:
+			case uwop_set_fpreg:
+			case uwop_push_machframe:
+				break;
+
+			case uwop_alloc_small:
+				operation.operand = operation.info * 8 + 8;
+				break;
+
+			case uwop_alloc_large:
+				slots = operation.info ? 3 : 2;
+				break;
+
+			case uwop_save_nonvol:
+			case uwop_save_xmm128:
+			case uwop_epilog:
+				slots = 2;
+				break;
+
+			case uwop_save_nonvol_far:
+			case uwop_save_xmm128_far:
+			case uwop_spare_code:
+				slots = 3;
+				break;
+
+			default:
+				throw pe_exception("Incorrect unwind code", pe_exception::incorrect_exception_directory);
+			}
+
+			if (slots > info.CountOfCodes - i)
+				throw pe_exception("Incorrect unwind code", pe_exception::incorrect_exception_directory);
+
+			//Decode operand from following slots
+			const char* operand = codes + (i + 1) * sizeof(uint16_t);
+			switch (operation.operation)
+			{
+			case uwop_alloc_large:
+				operation.operand = operation.info ? read_unwind_dword(operand) : read_unwind_word(operand) * 8;
+				break;
+
+			case uwop_save_nonvol:
+				operation.operand = read_unwind_word(operand) * 8;
+				break;
+
+			case uwop_save_xmm128:
+				operation.operand = read_unwind_word(operand) * 16;
+				break;
+
+			case uwop_epilog:
+				operation.operand = read_unwind_word(operand);
+				break;
+
+			case uwop_save_nonvol_far:
+			case uwop_save_xmm128_far:
+			case uwop_spare_code:
+				operation.operand = read_unwind_dword(operand);
+				break;
+			}
+
+			plan.add_operation(operation);
+			i += slots;
+		}
+
+		if (info.Flags & unw_flag_chaininfo)
+		{
+			//Chained unwind info is decoded first, so plan is cached only when the whole chain is resolved
+			image_runtime_function_entry chained;
+			memcpy(&chained, data + codes_end, sizeof(chained));
+			plan.set_chained(chained, &decode_unwind_info(chained.UnwindInfoAddress, chain_depth + 1));
+		}
+		else if (info.Flags & (unw_flag_ehandler | unw_flag_uhandler))
+		{
+			//Language-specific handler data follows handler address
+			plan.set_handler(read_unwind_dword(data + codes_end), address + codes_end + sizeof(uint32_t));
+		}
+
+		plan_indexes_.insert(std::make_pair(address, plans_.size()));
+		plans_.push_back(plan);
+		return plans_.back();
+	}
 }
@@ -14,6 +14,23 @@ namespace pe_bliss
 		:ordinal_(0), rva_(0), has_name_(false), name_ordinal_(0), forward_(false)
 	{}
 
+	//Constructor with allocator
+	exported_function::exported_function(const allocator_type& allocator)
+		:ordinal_(0), rva_(0), name_(allocator), has_name_(false), name_ordinal_(0), forward_(false), forward_name_(allocator)
+	{}
+
+	//Allocator-extended copy constructor
+	exported_function::exported_function(const exported_function& other, const allocator_type& allocator)
+		:ordinal_(other.ordinal_), rva_(other.rva_), name_(other.name_, allocator), has_name_(other.has_name_),
+		name_ordinal_(other.name_ordinal_), forward_(other.forward_), forward_name_(other.forward_name_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	exported_function::exported_function(exported_function&& other, const allocator_type& allocator)
+		:ordinal_(other.ordinal_), rva_(other.rva_), name_(std::move(other.name_), allocator), has_name_(other.has_name_),
+		name_ordinal_(other.name_ordinal_), forward_(other.forward_), forward_name_(std::move(other.forward_name_), allocator)
+	{}
+
 	//Returns ordinal of function (actually, ordinal = hint + ordinal base)
 	uint16_t exported_function::get_ordinal() const
 	{
@@ -27,9 +44,21 @@ namespace pe_bliss
 	}
 
 	//Returns name of function
-	const std::string& exported_function::get_name() const
+	std::string_view exported_function::get_name() const
 	{
-		return name_;
+		return name_.get();
+	}
+
+	//Returns name of function as std::string
+	std::string exported_function::get_name_string() const
+	{
+		return std::string(get_name());
+	}
+
+	//Returns ID of function name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t exported_function::get_name_id() const
+	{
+		return name_.get_id();
 	}
 
 	//Returns true if function has name and name ordinal
@@ -51,9 +80,15 @@ namespace pe_bliss
 	}
 
 	//Returns the name of forwarded function
-	const std::string& exported_function::get_forwarded_name() const
+	std::string_view exported_function::get_forwarded_name() const
 	{
-		return forward_name_;
+		return forward_name_.get();
+	}
+
+	//Returns ID of forwarded function name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t exported_function::get_forwarded_name_id() const
+	{
+		return forward_name_.get_id();
 	}
 
 	//Sets ordinal of function
@@ -69,9 +104,16 @@ namespace pe_bliss
 	}
 
 	//Sets name of function (or clears it, if empty name is passed)
-	void exported_function::set_name(const std::string& name)
+	void exported_function::set_name(std::string_view name)
 	{
-		name_ = name;
+		name_.set(name);
+		has_name_ = !name.empty();
+	}
+
+	//Sets name of function interned in pool (or clears it, if empty name is passed)
+	void exported_function::set_name(std::string_view name, name_pool& pool)
+	{
+		name_.set(name, pool);
 		has_name_ = !name.empty();
 	}
 
@@ -82,9 +124,16 @@ namespace pe_bliss
 	}
 
 	//Sets forwarded function name (or clears it, if empty name is passed)
-	void exported_function::set_forwarded_name(const std::string& name)
+	void exported_function::set_forwarded_name(std::string_view name)
 	{
-		forward_name_ = name;
+		forward_name_.set(name);
+		forward_ = !name.empty();
+	}
+
+	//Sets forwarded function name interned in pool (or clears it, if empty name is passed)
+	void exported_function::set_forwarded_name(std::string_view name, name_pool& pool)
+	{
+		forward_name_.set(name, pool);
 		forward_ = !name.empty();
 	}
 
@@ -234,32 +283,25 @@ namespace pe_bliss
 		address_of_name_ordinals_ = rva_of_name_ordinals;
 	}
 
-	const exported_functions_list get_exported_functions(const pe_base& pe, export_info* info);
+	exported_functions_list get_exported_functions(const pe_base& pe, export_info* info, std::pmr::memory_resource* resource, name_pool* names);
 
 	//Returns array of exported functions
-	const exported_functions_list get_exported_functions(const pe_base& pe)
+	exported_functions_list get_exported_functions(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
 	{
-		return get_exported_functions(pe, 0);
+		return get_exported_functions(pe, 0, resource, names);
 	}
 
 	//Returns array of exported functions and information about export
-	const exported_functions_list get_exported_functions(const pe_base& pe, export_info& info)
+	exported_functions_list get_exported_functions(const pe_base& pe, export_info& info, std::pmr::memory_resource* resource, name_pool* names)
 	{
-		return get_exported_functions(pe, &info);
+		return get_exported_functions(pe, &info, resource, names);
 	}
 
-	//Helper: sorts exported function list by ordinals
-	struct ordinal_sorter
-	{
-	public:
-		bool operator()(const exported_function& func1, const exported_function& func2) const;
-	};
-
 	//Returns array of exported functions and information about export (if info != 0)
-	const exported_functions_list get_exported_functions(const pe_base& pe, export_info* info)
+	exported_functions_list get_exported_functions(const pe_base& pe, export_info* info, std::pmr::memory_resource* resource, name_pool* names)
 	{
 		//Returned exported functions info array
-		std::vector<exported_function> ret;
+		exported_functions_list ret(resource);
 
 		if (pe.has_exports())
 		{
@@ -348,7 +390,7 @@ namespace pe_bliss
 				if (!rva)
 					continue;
 
-				exported_function func;
+				exported_function func(ret.get_allocator());
 				func.set_rva(rva);
 
 				if (!pe_utils::is_sum_safe(exports.Base, ordinal) || exports.Base + ordinal > pe_utils::max_word)
@@ -380,7 +422,10 @@ namespace pe_bliss
 							throw pe_exception("Incorrect export directory", pe_exception::incorrect_export_directory);
 
 						//Save function info
-						func.set_name(func_name);
+						if (names)
+							func.set_name(func_name, *names);
+						else
+							func.set_name(func_name);
 						func.set_name_ordinal(ordinal2);
 
 						//If the function is just a redirect, save its name
@@ -398,7 +443,10 @@ namespace pe_bliss
 								throw pe_exception("Incorrect export directory", pe_exception::incorrect_export_directory);
 
 							//Set the name of forwarded function
-							func.set_forwarded_name(forwarded_func_name);
+							if (names)
+								func.set_forwarded_name(forwarded_func_name, *names);
+							else
+								func.set_forwarded_name(forwarded_func_name);
 						}
 
 						break;
@@ -406,7 +454,7 @@ namespace pe_bliss
 				}
 
 				//Add function info to output array
-				ret.push_back(func);
+				ret.push_back(std::move(func));
 			}
 		}
 
@@ -415,7 +463,7 @@ namespace pe_bliss
 
 	//Helper export functions
 	//Returns pair: <ordinal base for supplied functions; maximum ordinal value for supplied functions>
-	const std::pair<uint16_t, uint16_t> get_export_ordinal_limits(const exported_functions_list& exports)
+	std::pair<uint16_t, uint16_t> get_export_ordinal_limits(const exported_functions_list& exports)
 	{
 		if (exports.empty())
 			return std::make_pair(0, 0);
@@ -435,7 +483,7 @@ namespace pe_bliss
 	}
 
 	//Checks if exported function name already exists
-	bool exported_name_exists(const std::string& function_name, const exported_functions_list& exports)
+	bool exported_name_exists(std::string_view function_name, const exported_functions_list& exports)
 	{
 		for (exported_functions_list::const_iterator it = exports.begin(); it != exports.end(); ++it)
 		{
@@ -458,32 +506,103 @@ namespace pe_bliss
 		return false;
 	}
 
-	//Helper: sorts exported function list by ordinals
-	bool ordinal_sorter::operator()(const exported_function& func1, const exported_function& func2) const
+	//Helper: exported name with name ordinal, sorted by export directory rebuilder
+	struct export_name_entry
+	{
+		std::string_view name;
+		uint16_t name_ordinal;
+	};
+
+	//Helper: returns character of name at position or -1, if name ends before it
+	inline int get_export_name_char(std::string_view name, std::size_t pos)
 	{
-		return func1.get_ordinal() < func2.get_ordinal();
+		return pos < name.length() ? static_cast<unsigned char>(name[pos]) : -1;
 	}
 
-	//Export directory rebuilder
-	//info - export information
-	//exported_functions_list - list of exported functions
-	//exports_section - section where export directory will be placed (must be attached to PE image)
-	//offset_from_section_start - offset from exports_section raw data start
-	//save_to_pe_headers - if true, new export directory information will be saved to PE image headers
-	//auto_strip_last_section - if true and exports are placed in the last section, it will be automatically stripped
-	//number_of_functions and number_of_names parameters don't matter in "info" when rebuilding, they're calculated independently
-	//characteristics, major_version, minor_version, timestamp and name are the only used members of "info" structure
-	//Returns new export directory information
-	//exported_functions_list is copied intentionally to be sorted by ordinal values later
-	//Name ordinals in exported function don't matter, they will be recalculated
-	const image_directory rebuild_exports(pe_base& pe, const export_info& info, exported_functions_list exports, section& exports_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
+	//Helper: sorts small range of names by insertion sort, first "depth" characters of all names are equal
+	void insertion_sort_export_names(export_name_entry* entries, std::size_t count, std::size_t depth)
+	{
+		for (std::size_t i = 1; i < count; ++i)
+		{
+			export_name_entry entry = entries[i];
+			std::string_view tail = entry.name.substr(depth);
+			std::size_t j = i;
+			//Names are compared as unsigned characters, like std::string_view does
+			while (j > 0 && tail < entries[j - 1].name.substr(depth))
+			{
+				entries[j] = entries[j - 1];
+				--j;
+			}
+
+			entries[j] = entry;
+		}
+	}
+
+	//Helper: sorts names by MSD radix sort, first "depth" characters of all names are equal
+	//temp - buffer of at least "count" entries
+	void radix_sort_export_names(export_name_entry* entries, export_name_entry* temp, std::size_t count, std::size_t depth)
+	{
+		//Ranges smaller than this are sorted by insertion sort
+		const std::size_t insertion_sort_threshold = 32;
+
+		while (count > insertion_sort_threshold)
+		{
+			//Bucket 0 is for names ending at current position, they go first
+			std::size_t bucket_pos[258] = { 0 };
+			for (std::size_t i = 0; i != count; ++i)
+				++bucket_pos[get_export_name_char(entries[i].name, depth) + 2];
+
+			//Single bucket - go to next character without moving anything
+			if (bucket_pos[get_export_name_char(entries[0].name, depth) + 2] == count)
+			{
+				if (entries[0].name.length() <= depth)
+					return; //All names are equal, duplicates are checked by caller
+
+				++depth;
+				continue;
+			}
+
+			for (uint32_t i = 2; i != 258; ++i)
+				bucket_pos[i] += bucket_pos[i - 1];
+
+			for (std::size_t i = 0; i != count; ++i)
+				temp[bucket_pos[get_export_name_char(entries[i].name, depth) + 1]++] = entries[i];
+
+			std::copy(temp, temp + count, entries);
+
+			//Now bucket_pos[i] is the end of bucket i, sort each bucket of non-ended names by next character
+			for (uint32_t i = 1; i != 257; ++i)
+			{
+				std::size_t bucket_size = bucket_pos[i] - bucket_pos[i - 1];
+				if (bucket_size > 1)
+					radix_sort_export_names(entries + bucket_pos[i - 1], temp, bucket_size, depth + 1);
+			}
+
+			return;
+		}
+
+		insertion_sort_export_names(entries, count, depth);
+	}
+
+	//Helper: sorts exported names alphabetically
+	struct export_name_sorter
+	{
+	public:
+		bool operator()(const export_name_entry& entry1, const export_name_entry& entry2) const
+		{
+			return entry1.name < entry2.name;
+		}
+	};
+
+	//Helper: export directory rebuilder for rebuild_exports and rebuild_exports_linear
+	//Functions are placed to address table by their ordinals, names are sorted alphabetically
+	//radix_sort_names - if true, names are sorted with MSD radix sort, otherwise with std::sort
+	image_directory write_export_directory(pe_base& pe, const export_info& info, const exported_functions_list& exports, section& exports_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section, bool radix_sort_names)
 	{
 		//Check that exports_section is attached to this PE image
 		if (!pe.section_attached(exports_section))
 			throw pe_exception("Exports section must be attached to PE file", pe_exception::section_is_not_attached);
 
-		//Needed space for strings
-		uint32_t needed_size_for_strings = static_cast<uint32_t>(info.get_name().length() + 1);
 		uint32_t number_of_names = 0; //Number of named functions
 		uint32_t max_ordinal = 0; //Maximum ordinal number
 		uint32_t ordinal_base = static_cast<uint32_t>(-1); //Minimum ordinal value
@@ -494,62 +613,87 @@ namespace pe_bliss
 		uint32_t needed_size_for_function_names = 0; //Needed space for function name strings
 		uint32_t needed_size_for_function_forwards = 0; //Needed space for function forwards names
 
-		//List all exported functions
-		//Calculate needed size for function list
+		//Calculate all sizes in one pass
+		for (exported_functions_list::const_iterator it = exports.begin(); it != exports.end(); ++it)
 		{
-			//Also check that there're no duplicate names and ordinals
-			std::set<std::string> used_function_names;
-			std::set<uint16_t> used_function_ordinals;
+			const exported_function& func = (*it);
+			max_ordinal = std::max<uint32_t>(max_ordinal, func.get_ordinal());
+			ordinal_base = std::min<uint32_t>(ordinal_base, func.get_ordinal());
+
+			if (func.has_name())
+			{
+				++number_of_names;
+				needed_size_for_function_names += static_cast<uint32_t>(func.get_name().length() + 1);
+			}
+
+			if (func.is_forwarded())
+				needed_size_for_function_forwards += static_cast<uint32_t>(func.get_forwarded_name().length() + 1);
+		}
 
+		uint32_t number_of_functions = max_ordinal - ordinal_base + 1;
+
+		//Index of function (plus one) for each ordinal, zero for skipped ordinals
+		//Ordinals are 16-bit, so this table is never larger than 64K entries
+		std::vector<uint32_t> functions_by_ordinal(exports.empty() ? 0 : number_of_functions);
+		//Names with their name ordinals
+		std::vector<export_name_entry> names(number_of_names);
+		{
+			uint32_t name_index = 0;
 			for (exported_functions_list::const_iterator it = exports.begin(); it != exports.end(); ++it)
 			{
 				const exported_function& func = (*it);
-				//Calculate maximum and minimum ordinal numbers
-				max_ordinal = std::max<uint32_t>(max_ordinal, func.get_ordinal());
-				ordinal_base = std::min<uint32_t>(ordinal_base, func.get_ordinal());
+				uint32_t& function_index = functions_by_ordinal[func.get_ordinal() - ordinal_base];
 
 				//Check if ordinal is unique
-				if (!used_function_ordinals.insert(func.get_ordinal()).second)
+				if (function_index)
 					throw pe_exception("Duplicate exported function ordinal", pe_exception::duplicate_exported_function_ordinal);
 
+				function_index = static_cast<uint32_t>(it - exports.begin()) + 1;
+
 				if (func.has_name())
 				{
-					//If function is named
-					++number_of_names;
-					needed_size_for_function_names += static_cast<uint32_t>(func.get_name().length() + 1);
-
-					//Check if it's name and name ordinal are unique
-					if (!used_function_names.insert(func.get_name()).second)
-						throw pe_exception("Duplicate exported function name", pe_exception::duplicate_exported_function_name);
+					names[name_index].name = func.get_name();
+					names[name_index].name_ordinal = static_cast<uint16_t>(func.get_ordinal() - ordinal_base);
+					++name_index;
 				}
-
-				//If function is forwarded to another DLL
-				if (func.is_forwarded())
-					needed_size_for_function_forwards += static_cast<uint32_t>(func.get_forwarded_name().length() + 1);
 			}
 		}
 
-		//Sort functions by ordinal value
-		std::sort(exports.begin(), exports.end(), ordinal_sorter());
+		//Sort names alphabetically and check that they are unique
+		if (number_of_names > 1)
+		{
+			if (radix_sort_names)
+			{
+				std::vector<export_name_entry> temp(number_of_names);
+				radix_sort_export_names(&names[0], &temp[0], number_of_names, 0);
+			}
+			else
+			{
+				std::sort(names.begin(), names.end(), export_name_sorter());
+			}
+
+			for (uint32_t i = 1; i != number_of_names; ++i)
+			{
+				if (names[i].name == names[i - 1].name)
+					throw pe_exception("Duplicate exported function name", pe_exception::duplicate_exported_function_name);
+			}
+		}
 
-		//Calculate needed space for different things...
-		needed_size_for_strings += needed_size_for_function_names;
-		needed_size_for_strings += needed_size_for_function_forwards;
 		uint32_t needed_size_for_function_name_ordinals = number_of_names * sizeof(uint16_t);
 		uint32_t needed_size_for_function_name_rvas = number_of_names * sizeof(uint32_t);
-		uint32_t needed_size_for_function_addresses = (max_ordinal - ordinal_base + 1) * sizeof(uint32_t);
+		uint32_t needed_size_for_function_addresses = number_of_functions * sizeof(uint32_t);
 
 		//Export directory header will be placed first
 		uint32_t directory_pos = pe_utils::align_up(offset_from_section_start, sizeof(uint32_t));
 
-		uint32_t needed_size = sizeof(image_export_directory); //Calculate needed size for export tables and strings
-		//sizeof(IMAGE_EXPORT_DIRECTORY) = export directory header
-
-		//Total needed space...
-		needed_size += needed_size_for_function_name_ordinals; //For list of names ordinals
-		needed_size += needed_size_for_function_addresses; //For function RVAs
-		needed_size += needed_size_for_strings; //For all strings
-		needed_size += needed_size_for_function_name_rvas; //For function name strings RVAs
+		//Total needed space: header, library name, tables and strings
+		uint32_t needed_size = sizeof(image_export_directory)
+			+ static_cast<uint32_t>(info.get_name().length() + 1)
+			+ needed_size_for_function_names
+			+ needed_size_for_function_name_ordinals
+			+ needed_size_for_function_forwards
+			+ needed_size_for_function_addresses
+			+ needed_size_for_function_name_rvas;
 
 		//Check if exports_section is last one. If it's not, check if there's enough place for exports data
 		if (&exports_section != &*(pe.get_image_sections().end() - 1) &&
@@ -562,16 +706,14 @@ namespace pe_bliss
 		if (raw_data.length() < needed_size + directory_pos)
 			raw_data.resize(needed_size + directory_pos); //Expand section raw data
 
-		//Library name will be placed after it
-		uint32_t current_pos_of_function_names = static_cast<uint32_t>(info.get_name().length() + 1 + directory_pos + sizeof(image_export_directory));
-		//Next - function names
-		uint32_t current_pos_of_function_name_ordinals = current_pos_of_function_names + needed_size_for_function_names;
-		//Next - function name ordinals
-		uint32_t current_pos_of_function_forwards = current_pos_of_function_name_ordinals + needed_size_for_function_name_ordinals;
-		//Finally - function addresses
-		uint32_t current_pos_of_function_addresses = current_pos_of_function_forwards + needed_size_for_function_forwards;
-		//Next - function names RVAs
-		uint32_t current_pos_of_function_names_rvas = current_pos_of_function_addresses + needed_size_for_function_addresses;
+		//Layout: directory, library name, function names, name ordinals, forwarded names, function addresses, name RVAs
+		uint32_t pos_of_function_names = static_cast<uint32_t>(directory_pos + sizeof(image_export_directory) + info.get_name().length() + 1);
+		uint32_t pos_of_function_name_ordinals = pos_of_function_names + needed_size_for_function_names;
+		uint32_t pos_of_function_forwards = pos_of_function_name_ordinals + needed_size_for_function_name_ordinals;
+		uint32_t pos_of_function_addresses = pos_of_function_forwards + needed_size_for_function_forwards;
+		uint32_t pos_of_function_names_rvas = pos_of_function_addresses + needed_size_for_function_addresses;
+
+		char* data = &raw_data[0];
 
 		{
 			//Create export directory and fill it
@@ -580,92 +722,64 @@ namespace pe_bliss
 			dir.MajorVersion = info.get_major_version();
 			dir.MinorVersion = info.get_minor_version();
 			dir.TimeDateStamp = info.get_timestamp();
-			dir.NumberOfFunctions = max_ordinal - ordinal_base + 1;
+			dir.NumberOfFunctions = number_of_functions;
 			dir.NumberOfNames = number_of_names;
 			dir.Base = ordinal_base;
-			dir.AddressOfFunctions = pe.rva_from_section_offset(exports_section, current_pos_of_function_addresses);
-			dir.AddressOfNameOrdinals = pe.rva_from_section_offset(exports_section, current_pos_of_function_name_ordinals);
-			dir.AddressOfNames = pe.rva_from_section_offset(exports_section, current_pos_of_function_names_rvas);
+			dir.AddressOfFunctions = pe.rva_from_section_offset(exports_section, pos_of_function_addresses);
+			dir.AddressOfNameOrdinals = pe.rva_from_section_offset(exports_section, pos_of_function_name_ordinals);
+			dir.AddressOfNames = pe.rva_from_section_offset(exports_section, pos_of_function_names_rvas);
 			dir.Name = pe.rva_from_section_offset(exports_section, directory_pos + sizeof(image_export_directory));
 
-			//Save it
-			memcpy(&raw_data[directory_pos], &dir, sizeof(dir));
+			memcpy(data + directory_pos, &dir, sizeof(dir));
 		}
 
-		//Sve library name
-		memcpy(&raw_data[directory_pos + sizeof(image_export_directory)], info.get_name().c_str(), info.get_name().length() + 1);
-
-		//A map to sort function names alphabetically
-		typedef std::map<std::string, uint16_t> funclist; //function name; function name ordinal
-		funclist funcs;
+		//Save library name
+		memcpy(data + directory_pos + sizeof(image_export_directory), info.get_name().c_str(), info.get_name().length() + 1);
 
-		uint32_t last_ordinal = ordinal_base;
-		//Enumerate all exported functions
-		for (exported_functions_list::const_iterator it = exports.begin(); it != exports.end(); ++it)
+		//Function addresses and forwarded names, in order of ordinals
+		//RVAs of strings are calculated from section RVA once
+		uint32_t section_rva = pe.rva_from_section_offset(exports_section, 0);
+		memset(data + pos_of_function_addresses, 0, needed_size_for_function_addresses);
+		for (std::size_t i = 0; i != functions_by_ordinal.size(); ++i)
 		{
-			const exported_function& func = (*it);
+			if (!functions_by_ordinal[i])
+				continue; //Skipped ordinal
 
-			//If we're skipping some ordinals...
-			if (func.get_ordinal() > last_ordinal)
-			{
-				//Fill this function RVAs data with zeros
-				uint32_t len = sizeof(uint32_t) * (func.get_ordinal() - last_ordinal - 1);
-				if (len)
-				{
-					memset(&raw_data[current_pos_of_function_addresses], 0, len);
-					current_pos_of_function_addresses += len;
-				}
-
-				//Save last encountered ordinal
-				last_ordinal = func.get_ordinal();
-			}
-
-			//If function is named, save its name ordinal and name in sorted alphabetically order
-			if (func.has_name())
-				funcs.insert(std::make_pair(func.get_name(), static_cast<uint16_t>(func.get_ordinal() - ordinal_base))); //Calculate name ordinal
-
-			//If function is forwarded to another DLL
+			const exported_function& func = exports[functions_by_ordinal[i] - 1];
+			uint32_t function_rva;
 			if (func.is_forwarded())
 			{
-				//Write its forwarded name and its RVA
-				uint32_t function_rva = pe.rva_from_section_offset(exports_section, current_pos_of_function_forwards);
-				memcpy(&raw_data[current_pos_of_function_addresses], &function_rva, sizeof(function_rva));
-				current_pos_of_function_addresses += sizeof(function_rva);
-
-				memcpy(&raw_data[current_pos_of_function_forwards], func.get_forwarded_name().c_str(), func.get_forwarded_name().length() + 1);
-				current_pos_of_function_forwards += static_cast<uint32_t>(func.get_forwarded_name().length() + 1);
+				//Write forwarded name, function RVA points to it
+				function_rva = section_rva + pos_of_function_forwards;
+				memcpy(data + pos_of_function_forwards, func.get_forwarded_name().data(), func.get_forwarded_name().length() + 1);
+				pos_of_function_forwards += static_cast<uint32_t>(func.get_forwarded_name().length() + 1);
 			}
 			else
 			{
-				//Write actual function RVA
-				uint32_t function_rva = func.get_rva();
-				memcpy(&raw_data[current_pos_of_function_addresses], &function_rva, sizeof(function_rva));
-				current_pos_of_function_addresses += sizeof(function_rva);
+				function_rva = func.get_rva();
 			}
+
+			memcpy(data + pos_of_function_addresses + i * sizeof(uint32_t), &function_rva, sizeof(function_rva));
 		}
 
-		//Enumerate sorted function names
-		for (funclist::const_iterator it = funcs.begin(); it != funcs.end(); ++it)
+		//Function names, their RVAs and name ordinals, in alphabetical order
+		for (std::vector<export_name_entry>::const_iterator it = names.begin(); it != names.end(); ++it)
 		{
-			//Save function name RVA
-			uint32_t function_name_rva = pe.rva_from_section_offset(exports_section, current_pos_of_function_names);
-			memcpy(&raw_data[current_pos_of_function_names_rvas], &function_name_rva, sizeof(function_name_rva));
-			current_pos_of_function_names_rvas += sizeof(function_name_rva);
-
-			//Save function name
-			memcpy(&raw_data[current_pos_of_function_names], (*it).first.c_str(), (*it).first.length() + 1);
-			current_pos_of_function_names += static_cast<uint32_t>((*it).first.length() + 1);
-
-			//Save function name ordinal
-			uint16_t name_ordinal = (*it).second;
-			memcpy(&raw_data[current_pos_of_function_name_ordinals], &name_ordinal, sizeof(name_ordinal));
-			current_pos_of_function_name_ordinals += sizeof(name_ordinal);
+			uint32_t function_name_rva = section_rva + pos_of_function_names;
+			memcpy(data + pos_of_function_names_rvas, &function_name_rva, sizeof(function_name_rva));
+			pos_of_function_names_rvas += sizeof(function_name_rva);
+
+			memcpy(data + pos_of_function_names, (*it).name.data(), (*it).name.length() + 1);
+			pos_of_function_names += static_cast<uint32_t>((*it).name.length() + 1);
+
+			memcpy(data + pos_of_function_name_ordinals, &(*it).name_ordinal, sizeof(uint16_t));
+			pos_of_function_name_ordinals += sizeof(uint16_t);
 		}
 
 		//Adjust section raw and virtual sizes
 		pe.recalculate_section_sizes(exports_section, auto_strip_last_section);
 
-		image_directory ret(pe.rva_from_section_offset(exports_section, directory_pos), needed_size);
+		image_directory ret(section_rva + directory_pos, needed_size);
 
 		//If auto-rewrite of PE headers is required
 		if (save_to_pe_header)
@@ -676,4 +790,28 @@ namespace pe_bliss
 
 		return ret;
 	}
+
+	//Export directory rebuilder
+	//info - export information
+	//exported_functions_list - list of exported functions
+	//exports_section - section where export directory will be placed (must be attached to PE image)
+	//offset_from_section_start - offset from exports_section raw data start
+	//save_to_pe_headers - if true, new export directory information will be saved to PE image headers
+	//auto_strip_last_section - if true and exports are placed in the last section, it will be automatically stripped
+	//number_of_functions and number_of_names parameters don't matter in "info" when rebuilding, they're calculated independently
+	//characteristics, major_version, minor_version, timestamp and name are the only used members of "info" structure
+	//Returns new export directory information
+	//Name ordinals in exported function don't matter, they will be recalculated
+	image_directory rebuild_exports(pe_base& pe, const export_info& info, const exported_functions_list& exports, section& exports_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
+	{
+		return write_export_directory(pe, info, exports, exports_section, offset_from_section_start, save_to_pe_header, auto_strip_last_section, false);
+	}
+
+	//Linear-time export directory rebuilder for large export tables
+	//Parameters and resulting export directory layout are the same as for rebuild_exports,
+	//but names are sorted with MSD radix sort instead of comparison sort
+	image_directory rebuild_exports_linear(pe_base& pe, const export_info& info, const exported_functions_list& exports, section& exports_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
+	{
+		return write_export_directory(pe, info, exports, exports_section, offset_from_section_start, save_to_pe_header, auto_strip_last_section, true);
+	}
 }
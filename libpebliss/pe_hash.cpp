@@ -0,0 +1,441 @@
+#include <string.h>
+#include <algorithm>
+#include "pe_hash.h"
+
+namespace pe_bliss
+{
+	//HASH ALGORITHM
+	//Destructor
+	hash_algorithm::~hash_algorithm()
+	{}
+
+	//CRC-32
+	//Helper: CRC-32 tables for slice-by-8 calculation
+	struct crc32_tables
+	{
+		uint32_t table[8][256];
+
+		crc32_tables()
+		{
+			for (uint32_t i = 0; i != 256; ++i)
+			{
+				uint32_t crc = i;
+				for (uint32_t bit = 0; bit != 8; ++bit)
+					crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+
+				table[0][i] = crc;
+			}
+
+			for (uint32_t i = 0; i != 256; ++i)
+			{
+				for (uint32_t slice = 1; slice != 8; ++slice)
+					table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xff];
+			}
+		}
+	};
+
+	//Helper: returns CRC-32 tables (they are built once)
+	const crc32_tables& get_crc32_tables()
+	{
+		static const crc32_tables tables;
+		return tables;
+	}
+
+	//Default constructor
+	crc32_hash::crc32_hash()
+		:crc_(0xffffffff)
+	{}
+
+	//Starts new hash
+	void crc32_hash::reset()
+	{
+		crc_ = 0xffffffff;
+	}
+
+	//Adds data to hash
+	void crc32_hash::update(const char* data, std::size_t length)
+	{
+		const uint32_t (&table)[8][256] = get_crc32_tables().table;
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+		uint32_t crc = crc_;
+
+		//Eight bytes at once
+		for (; length >= 8; length -= 8, bytes += 8)
+		{
+			uint32_t low = crc ^ (bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24));
+			crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^ table[5][(low >> 16) & 0xff] ^ table[4][low >> 24]
+				^ table[3][bytes[4]] ^ table[2][bytes[5]] ^ table[1][bytes[6]] ^ table[0][bytes[7]];
+		}
+
+		for (; length; --length, ++bytes)
+			crc = (crc >> 8) ^ table[0][(crc ^ *bytes) & 0xff];
+
+		crc_ = crc;
+	}
+
+	//Returns digest of hashed data
+	std::string crc32_hash::finish()
+	{
+		uint32_t crc = crc_ ^ 0xffffffff;
+		char digest[4] = { static_cast<char>(crc >> 24), static_cast<char>(crc >> 16), static_cast<char>(crc >> 8), static_cast<char>(crc) };
+		reset();
+		return std::string(digest, sizeof(digest));
+	}
+
+	//XXH64
+	//XXH64 constants
+	const uint64_t xxh64_prime1 = 0x9e3779b185ebca87ull;
+	const uint64_t xxh64_prime2 = 0xc2b2ae3d27d4eb4full;
+	const uint64_t xxh64_prime3 = 0x165667b19e3779f9ull;
+	const uint64_t xxh64_prime4 = 0x85ebca77c2b2ae63ull;
+	const uint64_t xxh64_prime5 = 0x27d4eb2f165667c5ull;
+
+	//Helper: rotates 64-bit value left
+	inline uint64_t rotate_left_64(uint64_t value, uint32_t bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	//Helper: reads little-endian 64-bit value
+	inline uint64_t read_le_64(const unsigned char* data)
+	{
+		uint64_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	//Helper: reads little-endian 32-bit value
+	inline uint32_t read_le_32(const unsigned char* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	//Helper: XXH64 round
+	inline uint64_t xxh64_round(uint64_t accumulator, uint64_t input)
+	{
+		accumulator += input * xxh64_prime2;
+		accumulator = rotate_left_64(accumulator, 31);
+		return accumulator * xxh64_prime1;
+	}
+
+	//Helper: XXH64 accumulator merge
+	inline uint64_t xxh64_merge_round(uint64_t hash, uint64_t accumulator)
+	{
+		hash ^= xxh64_round(0, accumulator);
+		return hash * xxh64_prime1 + xxh64_prime4;
+	}
+
+	//Default constructor
+	xxhash64_hash::xxhash64_hash()
+	{
+		reset();
+	}
+
+	//Starts new hash
+	void xxhash64_hash::reset()
+	{
+		state_[0] = xxh64_prime1 + xxh64_prime2;
+		state_[1] = xxh64_prime2;
+		state_[2] = 0;
+		state_[3] = 0 - xxh64_prime1;
+		length_ = 0;
+		buffer_size_ = 0;
+	}
+
+	//Adds data to hash
+	void xxhash64_hash::update(const char* data, std::size_t length)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+		length_ += length;
+
+		//Fill buffered stripe first
+		if (buffer_size_)
+		{
+			std::size_t copy_size = std::min<std::size_t>(length, sizeof(buffer_) - buffer_size_);
+			memcpy(buffer_ + buffer_size_, bytes, copy_size);
+			buffer_size_ += static_cast<uint32_t>(copy_size);
+			bytes += copy_size;
+			length -= copy_size;
+
+			if (buffer_size_ != sizeof(buffer_))
+				return;
+
+			for (uint32_t i = 0; i != 4; ++i)
+				state_[i] = xxh64_round(state_[i], read_le_64(buffer_ + i * 8));
+
+			buffer_size_ = 0;
+		}
+
+		//Whole stripes
+		uint64_t v1 = state_[0], v2 = state_[1], v3 = state_[2], v4 = state_[3];
+		for (; length >= 32; length -= 32, bytes += 32)
+		{
+			v1 = xxh64_round(v1, read_le_64(bytes));
+			v2 = xxh64_round(v2, read_le_64(bytes + 8));
+			v3 = xxh64_round(v3, read_le_64(bytes + 16));
+			v4 = xxh64_round(v4, read_le_64(bytes + 24));
+		}
+
+		state_[0] = v1;
+		state_[1] = v2;
+		state_[2] = v3;
+		state_[3] = v4;
+
+		memcpy(buffer_, bytes, length);
+		buffer_size_ = static_cast<uint32_t>(length);
+	}
+
+	//Returns digest of hashed data
+	std::string xxhash64_hash::finish()
+	{
+		uint64_t hash;
+		if (length_ >= 32)
+		{
+			hash = rotate_left_64(state_[0], 1) + rotate_left_64(state_[1], 7) + rotate_left_64(state_[2], 12) + rotate_left_64(state_[3], 18);
+			for (uint32_t i = 0; i != 4; ++i)
+				hash = xxh64_merge_round(hash, state_[i]);
+		}
+		else
+		{
+			hash = state_[2] + xxh64_prime5;
+		}
+
+		hash += length_;
+
+		//Remaining bytes of the last stripe
+		const unsigned char* bytes = buffer_;
+		uint32_t length = buffer_size_;
+		for (; length >= 8; length -= 8, bytes += 8)
+			hash = rotate_left_64(hash ^ xxh64_round(0, read_le_64(bytes)), 27) * xxh64_prime1 + xxh64_prime4;
+
+		if (length >= 4)
+		{
+			hash = rotate_left_64(hash ^ (read_le_32(bytes) * xxh64_prime1), 23) * xxh64_prime2 + xxh64_prime3;
+			length -= 4;
+			bytes += 4;
+		}
+
+		for (; length; --length, ++bytes)
+			hash = rotate_left_64(hash ^ (*bytes * xxh64_prime5), 11) * xxh64_prime1;
+
+		hash ^= hash >> 33;
+		hash *= xxh64_prime2;
+		hash ^= hash >> 29;
+		hash *= xxh64_prime3;
+		hash ^= hash >> 32;
+
+		char digest[8];
+		for (uint32_t i = 0; i != 8; ++i)
+			digest[i] = static_cast<char>(hash >> (56 - i * 8));
+
+		reset();
+		return std::string(digest, sizeof(digest));
+	}
+
+	//SHA-256
+	//SHA-256 round constants
+	const uint32_t sha256_constants[64] =
+	{
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	//Helper: rotates 32-bit value right
+	inline uint32_t rotate_right_32(uint32_t value, uint32_t bits)
+	{
+		return (value >> bits) | (value << (32 - bits));
+	}
+
+	//Default constructor
+	sha256_hash::sha256_hash()
+	{
+		reset();
+	}
+
+	//Starts new hash
+	void sha256_hash::reset()
+	{
+		static const uint32_t initial_state[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+		memcpy(state_, initial_state, sizeof(state_));
+		length_ = 0;
+		buffer_size_ = 0;
+	}
+
+	//Processes 64-byte block
+	void sha256_hash::process_block(const unsigned char* block)
+	{
+		uint32_t w[64];
+		for (uint32_t i = 0; i != 16; ++i)
+			w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) | (block[i * 4 + 1] << 16) | (block[i * 4 + 2] << 8) | block[i * 4 + 3];
+
+		for (uint32_t i = 16; i != 64; ++i)
+		{
+			uint32_t s0 = rotate_right_32(w[i - 15], 7) ^ rotate_right_32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+			uint32_t s1 = rotate_right_32(w[i - 2], 17) ^ rotate_right_32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+			w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+		}
+
+		uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3], e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+		for (uint32_t i = 0; i != 64; ++i)
+		{
+			uint32_t s1 = rotate_right_32(e, 6) ^ rotate_right_32(e, 11) ^ rotate_right_32(e, 25);
+			uint32_t ch = (e & f) ^ (~e & g);
+			uint32_t temp1 = h + s1 + ch + sha256_constants[i] + w[i];
+			uint32_t s0 = rotate_right_32(a, 2) ^ rotate_right_32(a, 13) ^ rotate_right_32(a, 22);
+			uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+			uint32_t temp2 = s0 + maj;
+
+			h = g;
+			g = f;
+			f = e;
+			e = d + temp1;
+			d = c;
+			c = b;
+			b = a;
+			a = temp1 + temp2;
+		}
+
+		state_[0] += a;
+		state_[1] += b;
+		state_[2] += c;
+		state_[3] += d;
+		state_[4] += e;
+		state_[5] += f;
+		state_[6] += g;
+		state_[7] += h;
+	}
+
+	//Adds data to hash
+	void sha256_hash::update(const char* data, std::size_t length)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+		length_ += length;
+
+		//Fill buffered block first
+		if (buffer_size_)
+		{
+			std::size_t copy_size = std::min<std::size_t>(length, sizeof(buffer_) - buffer_size_);
+			memcpy(buffer_ + buffer_size_, bytes, copy_size);
+			buffer_size_ += static_cast<uint32_t>(copy_size);
+			bytes += copy_size;
+			length -= copy_size;
+
+			if (buffer_size_ != sizeof(buffer_))
+				return;
+
+			process_block(buffer_);
+			buffer_size_ = 0;
+		}
+
+		for (; length >= 64; length -= 64, bytes += 64)
+			process_block(bytes);
+
+		memcpy(buffer_, bytes, length);
+		buffer_size_ = static_cast<uint32_t>(length);
+	}
+
+	//Returns digest of hashed data
+	std::string sha256_hash::finish()
+	{
+		uint64_t bit_length = length_ * 8;
+
+		//Padding: 0x80, zeros, then 64-bit big-endian length
+		buffer_[buffer_size_++] = 0x80;
+		if (buffer_size_ > 56)
+		{
+			memset(buffer_ + buffer_size_, 0, sizeof(buffer_) - buffer_size_);
+			process_block(buffer_);
+			buffer_size_ = 0;
+		}
+
+		memset(buffer_ + buffer_size_, 0, 56 - buffer_size_);
+		for (uint32_t i = 0; i != 8; ++i)
+			buffer_[56 + i] = static_cast<unsigned char>(bit_length >> (56 - i * 8));
+
+		process_block(buffer_);
+
+		char digest[32];
+		for (uint32_t i = 0; i != 32; ++i)
+			digest[i] = static_cast<char>(state_[i / 4] >> (24 - (i % 4) * 8));
+
+		reset();
+		return std::string(digest, sizeof(digest));
+	}
+
+	//NORMALIZED HASHING
+	//Helper: adds zero bytes to hash
+	void update_hash_with_zeros(hash_algorithm& hash, std::size_t length)
+	{
+		static const char zeros[256] = { 0 };
+		while (length)
+		{
+			std::size_t size = std::min(length, sizeof(zeros));
+			hash.update(zeros, size);
+			length -= size;
+		}
+	}
+
+	//Adds data placed at RVA to hash, bytes of relocated values are hashed as zeros
+	void update_normalized_hash(hash_algorithm& hash, const char* data, std::size_t size, uint32_t rva, const relocation_coverage& coverage)
+	{
+		uint64_t end = static_cast<uint64_t>(rva) + size;
+		//Bytes after image end are not relocated
+		uint32_t masked_end = static_cast<uint32_t>(std::min<uint64_t>(end, std::max(rva, coverage.get_image_size())));
+
+		uint32_t pos = rva;
+		while (pos < masked_end)
+		{
+			//Not relocated bytes are hashed as they are
+			uint32_t relocated = coverage.find_relocated(pos, masked_end);
+			hash.update(data + (pos - rva), relocated - pos);
+			if (relocated == masked_end)
+			{
+				pos = masked_end;
+				break;
+			}
+
+			pos = coverage.find_not_relocated(relocated, masked_end);
+			update_hash_with_zeros(hash, pos - relocated);
+		}
+
+		hash.update(data + (pos - rva), static_cast<std::size_t>(end - pos));
+	}
+
+	//Returns hash of section raw data, bytes of relocated values are hashed as zeros
+	std::string get_normalized_section_hash(const section& s, uint32_t section_alignment, const relocation_coverage& coverage, hash_algorithm& hash)
+	{
+		hash.reset();
+
+		const std::string& raw_data = s.get_raw_data();
+		std::size_t mapped_size = std::min<std::size_t>(raw_data.length(), s.get_aligned_virtual_size(section_alignment));
+		update_normalized_hash(hash, raw_data.data(), mapped_size, s.get_virtual_address(), coverage);
+		hash.update(raw_data.data() + mapped_size, raw_data.length() - mapped_size);
+
+		return hash.finish();
+	}
+
+	//Returns hash of raw data of all image sections, bytes of relocated values are hashed as zeros
+	std::string get_normalized_image_hash(const pe_base& pe, const relocation_coverage& coverage, hash_algorithm& hash)
+	{
+		hash.reset();
+
+		const section_list& sections = pe.get_image_sections();
+		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
+		{
+			const std::string& raw_data = (*it).get_raw_data();
+			std::size_t mapped_size = std::min<std::size_t>(raw_data.length(), (*it).get_aligned_virtual_size(pe.get_section_alignment()));
+			update_normalized_hash(hash, raw_data.data(), mapped_size, (*it).get_virtual_address(), coverage);
+			hash.update(raw_data.data() + mapped_size, raw_data.length() - mapped_size);
+		}
+
+		return hash.finish();
+	}
+}
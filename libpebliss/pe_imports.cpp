@@ -1,4 +1,6 @@
 #include <string.h>
+#include <algorithm>
+#include <map>
 #include "pe_imports.h"
 #include "pe_properties_generic.h"
 
@@ -21,7 +23,8 @@ namespace pe_bliss
 		set_to_pe_headers_(set_to_pe_headers),
 		zero_directory_entry_iat_(auto_zero_directory_entry_iat),
 		rewrite_iat_and_original_iat_contents_(false),
-		auto_strip_last_section_(true)
+		auto_strip_last_section_(true),
+		compact_mode_(false)
 	{}
 
 	//Returns offset from section start where import directory data will be placed
@@ -76,6 +79,12 @@ namespace pe_bliss
 		return auto_strip_last_section_;
 	}
 
+	//Returns true if import directory will be rebuilt in compact mode
+	bool import_rebuilder_settings::compact_mode_enabled() const
+	{
+		return compact_mode_;
+	}
+
 	//Sets offset from section start where import directory data will be placed
 	void import_rebuilder_settings::set_offset_from_section_start(uint32_t offset)
 	{
@@ -124,21 +133,54 @@ namespace pe_bliss
 		auto_strip_last_section_ = enable;
 	}
 
+	//Sets if import directory will be rebuilt in compact mode, default false
+	void import_rebuilder_settings::enable_compact_mode(bool enable)
+	{
+		compact_mode_ = enable;
+	}
+
 	//Default constructor
 	imported_function::imported_function()
 		:hint_(0), ordinal_(0), iat_va_(0)
 	{}
 
+	//Constructor with allocator
+	imported_function::imported_function(const allocator_type& allocator)
+		:name_(allocator), hint_(0), ordinal_(0), iat_va_(0)
+	{}
+
+	//Allocator-extended copy constructor
+	imported_function::imported_function(const imported_function& other, const allocator_type& allocator)
+		:name_(other.name_, allocator), hint_(other.hint_), ordinal_(other.ordinal_), iat_va_(other.iat_va_)
+	{}
+
+	//Allocator-extended move constructor
+	imported_function::imported_function(imported_function&& other, const allocator_type& allocator)
+		:name_(std::move(other.name_), allocator), hint_(other.hint_), ordinal_(other.ordinal_), iat_va_(other.iat_va_)
+	{}
+
 	//Returns name of function
-	const std::string& imported_function::get_name() const
+	std::string_view imported_function::get_name() const
 	{
-		return name_;
+		return name_.get();
+	}
+
+	//Returns name of function as std::string
+	std::string imported_function::get_name_string() const
+	{
+		return std::string(get_name());
+	}
+
+	//Returns ID of function name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t imported_function::get_name_id() const
+	{
+		return name_.get_id();
 	}
 
 	//Returns true if imported function has name (and hint)
 	bool imported_function::has_name() const
 	{
-		return !name_.empty();
+		return !name_.get().empty();
 	}
 
 	//Returns hint
@@ -160,9 +202,15 @@ namespace pe_bliss
 	}
 
 	//Sets name of function
-	void imported_function::set_name(const std::string& name)
+	void imported_function::set_name(std::string_view name)
 	{
-		name_ = name;
+		name_.set(name);
+	}
+
+	//Sets name of function interned in pool
+	void imported_function::set_name(std::string_view name, name_pool& pool)
+	{
+		name_.set(name, pool);
 	}
 
 	//Sets hint
@@ -188,10 +236,41 @@ namespace pe_bliss
 		:rva_to_iat_(0), rva_to_original_iat_(0), timestamp_(0)
 	{}
 
+	//Constructor with allocator
+	import_library::import_library(const allocator_type& allocator)
+		:name_(allocator), rva_to_iat_(0), rva_to_original_iat_(0), timestamp_(0), imports_(allocator)
+	{}
+
+	//Allocator-extended copy constructor
+	import_library::import_library(const import_library& other, const allocator_type& allocator)
+		:name_(other.name_, allocator),
+		rva_to_iat_(other.rva_to_iat_), rva_to_original_iat_(other.rva_to_original_iat_), timestamp_(other.timestamp_),
+		imports_(other.imports_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	import_library::import_library(import_library&& other, const allocator_type& allocator)
+		:name_(std::move(other.name_), allocator),
+		rva_to_iat_(other.rva_to_iat_), rva_to_original_iat_(other.rva_to_original_iat_), timestamp_(other.timestamp_),
+		imports_(std::move(other.imports_), allocator)
+	{}
+
 	//Returns name of library
-	const std::string& import_library::get_name() const
+	std::string_view import_library::get_name() const
 	{
-		return name_;
+		return name_.get();
+	}
+
+	//Returns name of library as std::string
+	std::string import_library::get_name_string() const
+	{
+		return std::string(get_name());
+	}
+
+	//Returns ID of library name inside name_pool or name_pool::no_id, if name is not interned
+	uint32_t import_library::get_name_id() const
+	{
+		return name_.get_id();
 	}
 
 	//Returns RVA to Import Address Table (IAT)
@@ -213,9 +292,15 @@ namespace pe_bliss
 	}
 
 	//Sets name of library
-	void import_library::set_name(const std::string& name)
+	void import_library::set_name(std::string_view name)
 	{
-		name_ = name;
+		name_.set(name);
+	}
+
+	//Sets name of library interned in pool
+	void import_library::set_name(std::string_view name, name_pool& pool)
+	{
+		name_.set(name, pool);
 	}
 
 	//Sets RVA to Import Address Table (IAT)
@@ -248,39 +333,52 @@ namespace pe_bliss
 		imports_.push_back(func);
 	}
 
+	//Adds imported function
+	void import_library::add_import(imported_function&& func)
+	{
+		imports_.push_back(std::move(func));
+	}
+
 	//Clears imported functions list
 	void import_library::clear_imports()
 	{
 		imports_.clear();
 	}
 
-	const imported_functions_list get_imported_functions(const pe_base& pe)
+	imported_functions_list get_imported_functions(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
 	{
 		return (pe.get_pe_type() == pe_type_32 ?
-			get_imported_functions_base<pe_types_class_32>(pe)
-			: get_imported_functions_base<pe_types_class_64>(pe));
+			get_imported_functions_base<pe_types_class_32>(pe, resource, names)
+			: get_imported_functions_base<pe_types_class_64>(pe, resource, names));
 	}
 
-	const image_directory rebuild_imports(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings)
+	image_directory rebuild_imports(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings)
 	{
 		return (pe.get_pe_type() == pe_type_32 ?
 			rebuild_imports_base<pe_types_class_32>(pe, imports, import_section, import_settings)
 			: rebuild_imports_base<pe_types_class_64>(pe, imports, import_section, import_settings));
 	}
 
-	//Returns imported functions list with related libraries info
+	image_directory append_imports(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings)
+	{
+		return (pe.get_pe_type() == pe_type_32 ?
+			append_imports_base<pe_types_class_32>(pe, imports, import_section, import_settings)
+			: append_imports_base<pe_types_class_64>(pe, imports, import_section, import_settings));
+	}
+
+	//Reads imported functions list with related libraries info and appends it to "ret"
 	template<typename PEClassType>
-	const imported_functions_list get_imported_functions_base(const pe_base& pe)
+	void read_imported_functions_base(pe_data_cursor& cursor, imported_functions_list& ret, name_pool* names)
 	{
-		imported_functions_list ret;
+		const pe_base& pe = cursor.get_pe();
 
-		//If image has no imports, return empty array
+		//If image has no imports, nothing is read
 		if (!pe.has_imports())
-			return ret;
+			return;
 
 		unsigned long current_descriptor_pos = pe.get_directory_rva(image_directory_entry_import);
 		//Get first IMAGE_IMPORT_DESCRIPTOR
-		image_import_descriptor import_descriptor = pe.section_data_from_rva<image_import_descriptor>(current_descriptor_pos, section_data_virtual, true);
+		image_import_descriptor import_descriptor = cursor.read<image_import_descriptor>(current_descriptor_pos);
 
 		//Iterate them until we reach zero-element
 		//We don't need to check correctness of this, because exception will be thrown
@@ -288,22 +386,16 @@ namespace pe_bliss
 		while (import_descriptor.Name)
 		{
 			//Get imported library information
-			import_library lib;
-
-			unsigned long max_name_length;
-			//Get byte count that we have for library name
-			if ((max_name_length = pe.section_data_length_from_rva(import_descriptor.Name, import_descriptor.Name, section_data_virtual, true)) < 2)
-				throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+			import_library lib(ret.get_allocator());
 
-			//Get DLL name pointer
-			const char* dll_name = pe.section_data_from_rva(import_descriptor.Name, section_data_virtual, true);
-
-			//Check for null-termination
-			if (!pe_utils::is_null_terminated(dll_name, max_name_length))
-				throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+			//Get DLL name pointer (it is checked for null-termination)
+			const char* dll_name = cursor.read_string(import_descriptor.Name, "Incorrect import directory", pe_exception::incorrect_import_directory);
 
 			//Set library name
-			lib.set_name(dll_name);
+			if (names)
+				lib.set_name(dll_name, *names);
+			else
+				lib.set_name(dll_name);
 			//Set library timestamp
 			lib.set_timestamp(import_descriptor.TimeDateStamp);
 			//Set library RVA to IAT and original IAT
@@ -312,7 +404,7 @@ namespace pe_bliss
 
 			//Get RVA to IAT (it must be filled by loader when loading PE)
 			uint32_t current_thunk_rva = import_descriptor.FirstThunk;
-			typename PEClassType::BaseSize import_address_table = pe.section_data_from_rva<typename PEClassType::BaseSize>(current_thunk_rva, section_data_virtual, true);
+			typename PEClassType::BaseSize import_address_table = cursor.read<typename PEClassType::BaseSize>(current_thunk_rva);
 
 			//Get RVA to original IAT (lookup table), which must handle imported functions names
 			//Some linkers leave this pointer zero-filled
@@ -320,7 +412,7 @@ namespace pe_bliss
 			//afted image was loaded, because IAT becomes the only one table
 			//containing both function names and function RVAs after loading
 			uint32_t current_original_thunk_rva = import_descriptor.OriginalFirstThunk;
-			typename PEClassType::BaseSize import_lookup_table = current_original_thunk_rva == 0 ? import_address_table : pe.section_data_from_rva<typename PEClassType::BaseSize>(current_original_thunk_rva, section_data_virtual, true);
+			typename PEClassType::BaseSize import_lookup_table = current_original_thunk_rva == 0 ? import_address_table : cursor.read<typename PEClassType::BaseSize>(current_original_thunk_rva);
 			if (current_original_thunk_rva == 0)
 				current_original_thunk_rva = current_thunk_rva;
 
@@ -330,10 +422,10 @@ namespace pe_bliss
 				while (true)
 				{
 					//Imported function description
-					imported_function func;
+					imported_function func(ret.get_allocator());
 
 					//Get VA from IAT
-					typename PEClassType::BaseSize address = pe.section_data_from_rva<typename PEClassType::BaseSize>(current_thunk_rva, section_data_virtual, true);
+					typename PEClassType::BaseSize address = cursor.read<typename PEClassType::BaseSize>(current_thunk_rva);
 					//Move pointer
 					current_thunk_rva += sizeof(typename PEClassType::BaseSize);
 
@@ -344,7 +436,7 @@ namespace pe_bliss
 					func.set_iat_va(address);
 
 					//Get VA from original IAT
-					typename PEClassType::BaseSize lookup = pe.section_data_from_rva<typename PEClassType::BaseSize>(current_original_thunk_rva, section_data_virtual, true);
+					typename PEClassType::BaseSize lookup = cursor.read<typename PEClassType::BaseSize>(current_original_thunk_rva);
 					//Move pointer
 					current_original_thunk_rva += sizeof(typename PEClassType::BaseSize);
 
@@ -360,27 +452,22 @@ namespace pe_bliss
 						if (lookup > static_cast<uint32_t>(-1) - sizeof(uint16_t))
 							throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
 
-						//Get maximum available length of function name
-						if ((max_name_length = pe.section_data_length_from_rva(static_cast<uint32_t>(lookup + sizeof(uint16_t)), static_cast<uint32_t>(lookup + sizeof(uint16_t)), section_data_virtual, true)) < 2)
-							throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
-
-						//Get imported function name
-						const char* func_name = pe.section_data_from_rva(static_cast<uint32_t>(lookup + sizeof(uint16_t)), section_data_virtual, true);
-
-						//Check for null-termination
-						if (!pe_utils::is_null_terminated(func_name, max_name_length))
-							throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+						//Get imported function name (it is checked for null-termination)
+						const char* func_name = cursor.read_string(static_cast<uint32_t>(lookup + sizeof(uint16_t)), "Incorrect import directory", pe_exception::incorrect_import_directory);
 
 						//HINT in import table is ORDINAL in export table
-						uint16_t hint = pe.section_data_from_rva<uint16_t>(static_cast<uint32_t>(lookup), section_data_virtual, true);
+						uint16_t hint = cursor.read<uint16_t>(static_cast<uint32_t>(lookup));
 
 						//Save hint and name
-						func.set_name(func_name);
+						if (names)
+							func.set_name(func_name, *names);
+						else
+							func.set_name(func_name);
 						func.set_hint(hint);
 					}
 
 					//Add function to list
-					lib.add_import(func);
+					lib.add_import(std::move(func));
 				}
 			}
 
@@ -390,16 +477,553 @@ namespace pe_bliss
 
 			//Go to next library
 			current_descriptor_pos += sizeof(image_import_descriptor);
-			import_descriptor = pe.section_data_from_rva<image_import_descriptor>(current_descriptor_pos, section_data_virtual, true);
+			import_descriptor = cursor.read<image_import_descriptor>(current_descriptor_pos);
 
 			//Save import information
-			ret.push_back(lib);
+			ret.push_back(std::move(lib));
 		}
+	}
+
+	//Reads imported functions list with related libraries info and appends it to "imports"
+	void read_imported_functions(pe_data_cursor& cursor, imported_functions_list& imports, name_pool* names)
+	{
+		if (cursor.get_pe().get_pe_type() == pe_type_32)
+			read_imported_functions_base<pe_types_class_32>(cursor, imports, names);
+		else
+			read_imported_functions_base<pe_types_class_64>(cursor, imports, names);
+	}
 
-		//Return resulting list
+	//Returns imported functions list with related libraries info
+	template<typename PEClassType>
+	imported_functions_list get_imported_functions_base(const pe_base& pe, std::pmr::memory_resource* resource, name_pool* names)
+	{
+		imported_functions_list ret(resource);
+		pe_data_cursor cursor(pe);
+		read_imported_functions_base<PEClassType>(cursor, ret, names);
 		return ret;
 	}
 
+	//Default constructor
+	imported_function_view::imported_function_view()
+		:hint_(0), ordinal_(0), iat_va_(0), iat_rva_(0)
+	{}
+
+	//Returns true if imported function has name (and hint)
+	bool imported_function_view::has_name() const
+	{
+		return !name_.empty();
+	}
+
+	//Returns name of function
+	std::string_view imported_function_view::get_name() const
+	{
+		return name_;
+	}
+
+	//Returns name of function as std::string
+	std::string imported_function_view::get_name_string() const
+	{
+		return std::string(get_name());
+	}
+
+	//Returns hint
+	uint16_t imported_function_view::get_hint() const
+	{
+		return hint_;
+	}
+
+	//Returns ordinal of function
+	uint16_t imported_function_view::get_ordinal() const
+	{
+		return ordinal_;
+	}
+
+	//Returns IAT entry VA
+	uint64_t imported_function_view::get_iat_va() const
+	{
+		return iat_va_;
+	}
+
+	//Returns RVA of IAT entry (thunk) of function
+	uint32_t imported_function_view::get_iat_rva() const
+	{
+		return iat_rva_;
+	}
+
+	//Sets function data
+	void imported_function_view::set(std::string_view name, uint16_t hint, uint16_t ordinal, uint64_t iat_va, uint32_t iat_rva)
+	{
+		name_ = name;
+		hint_ = hint;
+		ordinal_ = ordinal;
+		iat_va_ = iat_va;
+		iat_rva_ = iat_rva;
+	}
+
+	//Reads import thunk (DWORD or ULONGLONG, depending on image type)
+	uint64_t read_import_thunk(const pe_base& pe, uint32_t rva)
+	{
+		return pe.get_pe_type() == pe_type_32
+			? pe.section_data_from_rva<uint32_t>(rva, section_data_virtual, true)
+			: pe.section_data_from_rva<uint64_t>(rva, section_data_virtual, true);
+	}
+
+	//Default constructor (end iterator)
+	imported_functions_view::iterator::iterator()
+		:pe_(0), thunk_rva_(0), original_thunk_rva_(0)
+	{}
+
+	//Constructor from first thunks of library
+	imported_functions_view::iterator::iterator(const pe_base& pe, uint32_t thunk_rva, uint32_t original_thunk_rva)
+		:pe_(&pe), thunk_rva_(thunk_rva), original_thunk_rva_(original_thunk_rva)
+	{
+		read();
+	}
+
+	imported_functions_view::iterator::reference imported_functions_view::iterator::operator*() const
+	{
+		return func_;
+	}
+
+	imported_functions_view::iterator::pointer imported_functions_view::iterator::operator->() const
+	{
+		return &func_;
+	}
+
+	imported_functions_view::iterator& imported_functions_view::iterator::operator++()
+	{
+		const uint32_t thunk_size = pe_->get_pe_type() == pe_type_32 ? sizeof(uint32_t) : sizeof(uint64_t);
+		thunk_rva_ += thunk_size;
+		original_thunk_rva_ += thunk_size;
+		read();
+		return *this;
+	}
+
+	imported_functions_view::iterator imported_functions_view::iterator::operator++(int)
+	{
+		iterator ret(*this);
+		++*this;
+		return ret;
+	}
+
+	bool imported_functions_view::iterator::operator==(const iterator& other) const
+	{
+		return pe_ == other.pe_ && (!pe_ || thunk_rva_ == other.thunk_rva_);
+	}
+
+	bool imported_functions_view::iterator::operator!=(const iterator& other) const
+	{
+		return !(*this == other);
+	}
+
+	//Decodes function at current thunk or reaches the end
+	//Checks are the same as in get_imported_functions_base
+	void imported_functions_view::iterator::read()
+	{
+		//Get VA from IAT
+		uint64_t address = read_import_thunk(*pe_, thunk_rva_);
+
+		//Zero thunk terminates list of library functions
+		if (!address)
+		{
+			pe_ = 0;
+			return;
+		}
+
+		//Get VA from original IAT
+		uint64_t lookup = read_import_thunk(*pe_, original_thunk_rva_);
+
+		//Check if function is imported by ordinal
+		if (pe_->get_pe_type() == pe_type_32 ? (lookup & pe_types_class_32::ImportSnapFlag) != 0 : (lookup & pe_types_class_64::ImportSnapFlag) != 0)
+		{
+			func_.set(std::string_view(), 0, static_cast<uint16_t>(lookup & 0xffff), address, thunk_rva_);
+			return;
+		}
+
+		//Get byte count that we have for function name
+		if (lookup > static_cast<uint32_t>(-1) - sizeof(uint16_t))
+			throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+
+		//Get maximum available length of function name
+		unsigned long max_name_length;
+		if ((max_name_length = pe_->section_data_length_from_rva(static_cast<uint32_t>(lookup + sizeof(uint16_t)), static_cast<uint32_t>(lookup + sizeof(uint16_t)), section_data_virtual, true)) < 2)
+			throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+
+		//Get imported function name
+		const char* func_name = pe_->section_data_from_rva(static_cast<uint32_t>(lookup + sizeof(uint16_t)), section_data_virtual, true);
+
+		//Check for null-termination
+		if (!pe_utils::is_null_terminated(func_name, max_name_length))
+			throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+
+		//HINT in import table is ORDINAL in export table
+		uint16_t hint = pe_->section_data_from_rva<uint16_t>(static_cast<uint32_t>(lookup), section_data_virtual, true);
+
+		func_.set(func_name, hint, 0, address, thunk_rva_);
+	}
+
+	//Default constructor (empty range)
+	imported_functions_view::imported_functions_view()
+		:pe_(0), thunk_rva_(0), original_thunk_rva_(0)
+	{}
+
+	//Constructor from first thunks of library
+	imported_functions_view::imported_functions_view(const pe_base& pe, uint32_t thunk_rva, uint32_t original_thunk_rva)
+		:pe_(&pe), thunk_rva_(thunk_rva), original_thunk_rva_(original_thunk_rva ? original_thunk_rva : thunk_rva)
+	{}
+
+	imported_functions_view::iterator imported_functions_view::begin() const
+	{
+		return pe_ ? iterator(*pe_, thunk_rva_, original_thunk_rva_) : iterator();
+	}
+
+	imported_functions_view::iterator imported_functions_view::end() const
+	{
+		return iterator();
+	}
+
+	//Default constructor
+	import_library_view::import_library_view()
+		:rva_to_iat_(0), rva_to_original_iat_(0), timestamp_(0)
+	{}
+
+	//Returns name of library
+	std::string_view import_library_view::get_name() const
+	{
+		return name_;
+	}
+
+	//Returns name of library as std::string
+	std::string import_library_view::get_name_string() const
+	{
+		return std::string(get_name());
+	}
+
+	//Returns RVA to Import Address Table (IAT)
+	uint32_t import_library_view::get_rva_to_iat() const
+	{
+		return rva_to_iat_;
+	}
+
+	//Returns RVA to Original Import Address Table (Original IAT)
+	uint32_t import_library_view::get_rva_to_original_iat() const
+	{
+		return rva_to_original_iat_;
+	}
+
+	//Returns timestamp
+	uint32_t import_library_view::get_timestamp() const
+	{
+		return timestamp_;
+	}
+
+	//Returns range of imported functions, which are decoded while iterating
+	const imported_functions_view& import_library_view::get_imported_functions() const
+	{
+		return functions_;
+	}
+
+	//Sets library data
+	void import_library_view::set(std::string_view name, const image_import_descriptor& descriptor, const imported_functions_view& functions)
+	{
+		name_ = name;
+		rva_to_iat_ = descriptor.FirstThunk;
+		rva_to_original_iat_ = descriptor.OriginalFirstThunk;
+		timestamp_ = descriptor.TimeDateStamp;
+		functions_ = functions;
+	}
+
+	//Default constructor (end iterator)
+	import_directory_view::iterator::iterator()
+		:pe_(0), descriptor_pos_(0)
+	{}
+
+	//Constructor from the first import descriptor
+	import_directory_view::iterator::iterator(const pe_base& pe)
+		:pe_(pe.has_imports() ? &pe : 0), descriptor_pos_(0)
+	{
+		if (pe_)
+		{
+			descriptor_pos_ = pe.get_directory_rva(image_directory_entry_import);
+			read();
+		}
+	}
+
+	import_directory_view::iterator::reference import_directory_view::iterator::operator*() const
+	{
+		return lib_;
+	}
+
+	import_directory_view::iterator::pointer import_directory_view::iterator::operator->() const
+	{
+		return &lib_;
+	}
+
+	import_directory_view::iterator& import_directory_view::iterator::operator++()
+	{
+		//Check possible overflow
+		if (!pe_utils::is_sum_safe(descriptor_pos_, sizeof(image_import_descriptor)))
+			throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+
+		//Go to next library
+		descriptor_pos_ += sizeof(image_import_descriptor);
+		read();
+		return *this;
+	}
+
+	import_directory_view::iterator import_directory_view::iterator::operator++(int)
+	{
+		iterator ret(*this);
+		++*this;
+		return ret;
+	}
+
+	bool import_directory_view::iterator::operator==(const iterator& other) const
+	{
+		return pe_ == other.pe_ && (!pe_ || descriptor_pos_ == other.descriptor_pos_);
+	}
+
+	bool import_directory_view::iterator::operator!=(const iterator& other) const
+	{
+		return !(*this == other);
+	}
+
+	//Decodes library at current descriptor or reaches the end
+	//Checks are the same as in get_imported_functions_base
+	void import_directory_view::iterator::read()
+	{
+		image_import_descriptor import_descriptor = pe_->section_data_from_rva<image_import_descriptor>(descriptor_pos_, section_data_virtual, true);
+
+		//Zero descriptor terminates import directory
+		if (!import_descriptor.Name)
+		{
+			pe_ = 0;
+			return;
+		}
+
+		unsigned long max_name_length;
+		//Get byte count that we have for library name
+		if ((max_name_length = pe_->section_data_length_from_rva(import_descriptor.Name, import_descriptor.Name, section_data_virtual, true)) < 2)
+			throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+
+		//Get DLL name pointer
+		const char* dll_name = pe_->section_data_from_rva(import_descriptor.Name, section_data_virtual, true);
+
+		//Check for null-termination
+		if (!pe_utils::is_null_terminated(dll_name, max_name_length))
+			throw pe_exception("Incorrect import directory", pe_exception::incorrect_import_directory);
+
+		//Functions are listed only if both IAT and original IAT (or IAT, if there's no original one) are present
+		uint64_t import_address_table = read_import_thunk(*pe_, import_descriptor.FirstThunk);
+		uint64_t import_lookup_table = import_descriptor.OriginalFirstThunk == 0 ? import_address_table : read_import_thunk(*pe_, import_descriptor.OriginalFirstThunk);
+
+		lib_.set(dll_name, import_descriptor, import_lookup_table != 0 && import_address_table != 0
+			? imported_functions_view(*pe_, import_descriptor.FirstThunk, import_descriptor.OriginalFirstThunk)
+			: imported_functions_view());
+	}
+
+	//Constructor
+	import_directory_view::import_directory_view(const pe_base& pe)
+		:pe_(&pe)
+	{}
+
+	import_directory_view::iterator import_directory_view::begin() const
+	{
+		return iterator(*pe_);
+	}
+
+	import_directory_view::iterator import_directory_view::end() const
+	{
+		return iterator();
+	}
+
+	//Returns range of imported libraries, which are decoded from image while iterating
+	import_directory_view get_import_directory_view(const pe_base& pe)
+	{
+		return import_directory_view(pe);
+	}
+
+	//Helper: sorts IAT slots by RVA
+	bool iat_slot_less(const iat_index::slot& slot1, const iat_index::slot& slot2)
+	{
+		return slot1.rva < slot2.rva;
+	}
+
+	//Helper: checks if IAT slots have the same RVA
+	bool iat_slot_equal(const iat_index::slot& slot1, const iat_index::slot& slot2)
+	{
+		return slot1.rva == slot2.rva;
+	}
+
+	//Default constructor (empty index)
+	iat_index::iat_index()
+		:first_rva_(0), slot_size_(sizeof(uint32_t)), image_base_(0)
+	{}
+
+	//Builds index from imported functions list of image
+	iat_index::iat_index(const pe_base& pe, const imported_functions_list& imports)
+		:first_rva_(0),
+		slot_size_(pe.get_pe_type() == pe_type_32 ? sizeof(uint32_t) : sizeof(uint64_t)),
+		image_base_(pe.get_image_base_64())
+	{
+		//List IAT slots of all imported functions
+		for (imported_functions_list::const_iterator lib = imports.begin(); lib != imports.end(); ++lib)
+		{
+			const import_library::imported_list& functions = (*lib).get_imported_functions();
+			for (import_library::imported_list::const_iterator func = functions.begin(); func != functions.end(); ++func)
+			{
+				uint64_t rva = static_cast<uint64_t>((*lib).get_rva_to_iat()) + static_cast<uint64_t>(func - functions.begin()) * slot_size_;
+				if (rva > pe_utils::max_dword)
+					break;
+
+				slot s = { static_cast<uint32_t>(rva), static_cast<uint32_t>(lib - imports.begin()), static_cast<uint32_t>(func - functions.begin()) };
+				slots_.push_back(s);
+			}
+		}
+
+		//Sort slots by RVA, slots of malformed overlapping tables are listed once
+		std::stable_sort(slots_.begin(), slots_.end(), iat_slot_less);
+		slot_list::iterator last = std::unique(slots_.begin(), slots_.end(), iat_slot_equal);
+		slots_.erase(last, slots_.end());
+
+		if (slots_.empty())
+			return;
+
+		//Build direct lookup table, if slots are aligned to the first one and don't waste too much space
+		first_rva_ = slots_.front().rva;
+		uint64_t slot_count = (static_cast<uint64_t>(slots_.back().rva) - first_rva_) / slot_size_ + 1;
+		if (slot_count > 2 * slots_.size() + 64)
+			return;
+
+		for (slot_list::const_iterator it = slots_.begin(); it != slots_.end(); ++it)
+		{
+			if (((*it).rva - first_rva_) % slot_size_)
+				return;
+		}
+
+		table_.resize(static_cast<std::size_t>(slot_count));
+		for (slot_list::const_iterator it = slots_.begin(); it != slots_.end(); ++it)
+			table_[((*it).rva - first_rva_) / slot_size_] = static_cast<uint32_t>(it - slots_.begin()) + 1;
+	}
+
+	//Returns IAT slot, which starts at RVA, or null, if there is no such slot
+	const iat_index::slot* iat_index::find_by_rva(uint32_t rva) const
+	{
+		if (!table_.empty())
+		{
+			if (rva < first_rva_ || (rva - first_rva_) % slot_size_)
+				return 0;
+
+			uint32_t number = (rva - first_rva_) / slot_size_;
+			if (number >= table_.size() || !table_[number])
+				return 0;
+
+			return &slots_[table_[number] - 1];
+		}
+
+		slot key = { rva, 0, 0 };
+		slot_list::const_iterator it = std::lower_bound(slots_.begin(), slots_.end(), key, iat_slot_less);
+		return it != slots_.end() && (*it).rva == rva ? &*it : 0;
+	}
+
+	//Returns IAT slot, which starts at VA, or null, if there is no such slot
+	const iat_index::slot* iat_index::find_by_va(uint64_t va) const
+	{
+		if (va < image_base_ || va - image_base_ > pe_utils::max_dword)
+			return 0;
+
+		return find_by_rva(static_cast<uint32_t>(va - image_base_));
+	}
+
+	//Returns all IAT slots sorted by RVA
+	const iat_index::slot_list& iat_index::get_slots() const
+	{
+		return slots_;
+	}
+
+	//Returns true if direct lookup table is used
+	bool iat_index::is_dense() const
+	{
+		return !table_.empty();
+	}
+
+	//Offsets of library names and IMAGE_IMPORT_BY_NAME structures (from the beginning of import strings) for compact import rebuilder
+	typedef std::map<std::string_view, uint32_t> import_name_offset_map;
+	typedef std::map<std::pair<uint16_t, std::string_view>, uint32_t> import_by_name_offset_map;
+
+	//Helper function to determine how thunk tables of library are written by import rebuilder
+	//save_iats - IAT and original IAT are saved and not written at all
+	//write_original_iat - original IAT is written
+	//rewrite_saved_iat, rewrite_saved_original_iat - contents of saved IAT and original IAT are rewritten without changing their positions
+	void get_import_thunks_write_mode(const import_library& lib, const import_rebuilder_settings& import_settings,
+		bool& save_iats, bool& write_original_iat, bool& rewrite_saved_iat, bool& rewrite_saved_original_iat)
+	{
+		save_iats = import_settings.save_iat_and_original_iat_rvas() && lib.get_rva_to_iat() != 0;
+		write_original_iat = (!save_iats && import_settings.build_original_iat()) || import_settings.fill_missing_original_iats();
+		rewrite_saved_original_iat = save_iats && import_settings.rewrite_iat_and_original_iat_contents() && import_settings.build_original_iat();
+		rewrite_saved_iat = save_iats && import_settings.rewrite_iat_and_original_iat_contents();
+
+		if (save_iats)
+		{
+			if (rewrite_saved_original_iat)
+			{
+				if (lib.get_rva_to_original_iat())
+					write_original_iat = true;
+				else
+					rewrite_saved_original_iat = false;
+			}
+
+			if (rewrite_saved_iat)
+				save_iats = false;
+		}
+	}
+
+	//Helper function to calculate sizes of thunk tables and strings, which are written to import section in compact mode
+	//Equal library names and IMAGE_IMPORT_BY_NAME structures are counted once, their offsets from the beginning of strings are saved to maps
+	void get_compact_imports_sizes(const imported_functions_list& imports, const import_rebuilder_settings& import_settings, uint32_t thunk_size,
+		uint32_t& size_of_iat, uint32_t& size_of_original_iat, uint32_t& size_of_strings,
+		import_name_offset_map& library_names, import_by_name_offset_map& function_names)
+	{
+		size_of_iat = 0;
+		size_of_original_iat = 0;
+		size_of_strings = 0;
+
+		for (imported_functions_list::const_iterator it = imports.begin(); it != imports.end(); ++it)
+		{
+			if (library_names.insert(std::make_pair((*it).get_name(), size_of_strings)).second)
+				size_of_strings += static_cast<uint32_t>((*it).get_name().length() + 1 /* nullbyte */);
+
+			const import_library::imported_list& funcs = (*it).get_imported_functions();
+			for (import_library::imported_list::const_iterator f = funcs.begin(); f != funcs.end(); ++f)
+			{
+				if ((*f).has_name() && function_names.insert(std::make_pair(std::make_pair((*f).get_hint(), (*f).get_name()), size_of_strings)).second)
+					size_of_strings += static_cast<uint32_t>(sizeof(uint16_t) /* hint */ + (*f).get_name().length() + 1 /* nullbyte */);
+			}
+
+			bool save_iats, write_original_iat, rewrite_saved_iat, rewrite_saved_original_iat;
+			get_import_thunks_write_mode(*it, import_settings, save_iats, write_original_iat, rewrite_saved_iat, rewrite_saved_original_iat);
+
+			uint32_t size_of_thunks = static_cast<uint32_t>(thunk_size * (1 /*ending null */ + funcs.size()));
+			if (!save_iats && !rewrite_saved_iat)
+				size_of_iat += size_of_thunks;
+			if (write_original_iat && !rewrite_saved_original_iat)
+				size_of_original_iat += size_of_thunks;
+		}
+	}
+
+	//Helper function to calculate positions of import directory parts in compact mode
+	//Import descriptors (size_of_descriptors bytes, including ending null descriptor) are placed first, then IATs, original IATs and strings
+	//Returns position of the end of import directory data
+	uint32_t get_compact_imports_layout(uint32_t offset, uint32_t size_of_descriptors, uint32_t thunk_size,
+		uint32_t size_of_iat, uint32_t size_of_original_iat, uint32_t size_of_strings,
+		uint32_t& pos_for_descriptors, uint32_t& pos_for_iat, uint32_t& pos_for_strings)
+	{
+		pos_for_descriptors = pe_utils::align_up(offset, sizeof(uint32_t));
+		pos_for_iat = pe_utils::align_up(pos_for_descriptors + size_of_descriptors, thunk_size);
+		pos_for_strings = pos_for_iat + size_of_iat + size_of_original_iat;
+		return pos_for_strings + size_of_strings;
+	}
+
 	//Simple import directory rebuilder
 	//You can get all image imports with get_imported_functions() function
 	//You can use returned value to, for example, add new imported library with some functions
@@ -409,45 +1033,68 @@ namespace pe_bliss
 	//rewriting of some used memory (or other IAT/orig.IAT fields) by system loader
 	//The safest way is just adding import libraries with functions to the end of imported_functions_list array
 	template<typename PEClassType>
-	const image_directory rebuild_imports_base(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings)
+	image_directory rebuild_imports_base(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings)
 	{
 		//Check that import_section is attached to this PE image
 		if (!pe.section_attached(import_section))
 			throw pe_exception("Import section must be attached to PE file", pe_exception::section_is_not_attached);
 
+		bool compact = import_settings.compact_mode_enabled();
+
 		uint32_t needed_size = 0; //Calculate needed size for import structures and strings
 		uint32_t needed_size_for_strings = 0; //Calculate needed size for import strings (library and function names and hints)
 		uint32_t size_of_iat = 0; //Size of IAT structures
 
-		needed_size += static_cast<uint32_t>((1 /* ending null descriptor */ + imports.size()) * sizeof(image_import_descriptor));
+		//Positions of import directory parts in compact mode
+		uint32_t compact_pos_for_descriptors = 0, compact_pos_for_iat = 0, compact_pos_for_strings = 0;
+		uint32_t size_of_original_iat = 0;
+		//Offsets of deduplicated strings in compact mode
+		import_name_offset_map library_names;
+		import_by_name_offset_map function_names;
 
-		//Enumerate imported functions
-		for (imported_functions_list::const_iterator it = imports.begin(); it != imports.end(); ++it)
+		if (compact)
+		{
+			get_compact_imports_sizes(imports, import_settings, sizeof(typename PEClassType::BaseSize),
+				size_of_iat, size_of_original_iat, needed_size_for_strings, library_names, function_names);
+
+			needed_size = get_compact_imports_layout(import_settings.get_offset_from_section_start(),
+				static_cast<uint32_t>((1 /* ending null descriptor */ + imports.size()) * sizeof(image_import_descriptor)), sizeof(typename PEClassType::BaseSize),
+				size_of_iat, size_of_original_iat, needed_size_for_strings,
+				compact_pos_for_descriptors, compact_pos_for_iat, compact_pos_for_strings)
+				- import_settings.get_offset_from_section_start();
+		}
+		else
 		{
-			needed_size_for_strings += static_cast<uint32_t>((*it).get_name().length() + 1 /* nullbyte */);
+			needed_size += static_cast<uint32_t>((1 /* ending null descriptor */ + imports.size()) * sizeof(image_import_descriptor));
 
-			const import_library::imported_list& funcs = (*it).get_imported_functions();
+			//Enumerate imported functions
+			for (imported_functions_list::const_iterator it = imports.begin(); it != imports.end(); ++it)
+			{
+				needed_size_for_strings += static_cast<uint32_t>((*it).get_name().length() + 1 /* nullbyte */);
 
-			//IMAGE_THUNK_DATA
-			size_of_iat += static_cast<uint32_t>(sizeof(typename PEClassType::BaseSize) * (1 /*ending null */ + funcs.size()));
+				const import_library::imported_list& funcs = (*it).get_imported_functions();
 
-			//Enumerate all imported functions in library
-			for (import_library::imported_list::const_iterator f = funcs.begin(); f != funcs.end(); ++f)
-			{
-				if ((*f).has_name())
-					needed_size_for_strings += static_cast<uint32_t>((*f).get_name().length() + 1 /* nullbyte */ + sizeof(uint16_t) /* hint */);
+				//IMAGE_THUNK_DATA
+				size_of_iat += static_cast<uint32_t>(sizeof(typename PEClassType::BaseSize) * (1 /*ending null */ + funcs.size()));
+
+				//Enumerate all imported functions in library
+				for (import_library::imported_list::const_iterator f = funcs.begin(); f != funcs.end(); ++f)
+				{
+					if ((*f).has_name())
+						needed_size_for_strings += static_cast<uint32_t>((*f).get_name().length() + 1 /* nullbyte */ + sizeof(uint16_t) /* hint */);
+				}
 			}
-		}
 
-		if (import_settings.build_original_iat() || import_settings.fill_missing_original_iats())
-			needed_size += size_of_iat * 2; //We'll have two similar-sized IATs if we're building original IAT
-		else
-			needed_size += size_of_iat;
+			if (import_settings.build_original_iat() || import_settings.fill_missing_original_iats())
+				needed_size += size_of_iat * 2; //We'll have two similar-sized IATs if we're building original IAT
+			else
+				needed_size += size_of_iat;
 
-		needed_size += sizeof(typename PEClassType::BaseSize); //Maximum align for IAT and original IAT
+			needed_size += sizeof(typename PEClassType::BaseSize); //Maximum align for IAT and original IAT
 
-		//Total needed size for import structures and strings
-		needed_size += needed_size_for_strings;
+			//Total needed size for import structures and strings
+			needed_size += needed_size_for_strings;
+		}
 
 		//Check if import_section is last one. If it's not, check if there's enough place for import data
 		if (&import_section != &*(pe.get_image_sections().end() - 1) &&
@@ -469,6 +1116,24 @@ namespace pe_bliss
 		//Position for import descriptors
 		uint32_t current_pos_for_descriptors = needed_size_for_strings + import_settings.get_offset_from_section_start();
 
+		if (compact)
+		{
+			current_pos_for_descriptors = compact_pos_for_descriptors;
+			current_pos_for_iat = compact_pos_for_iat;
+			current_pos_for_original_iat = compact_pos_for_iat + size_of_iat;
+
+			//Write deduplicated library names and IMAGE_IMPORT_BY_NAME structures (WORD hint + string function name)
+			for (import_name_offset_map::const_iterator it = library_names.begin(); it != library_names.end(); ++it)
+				memcpy(&raw_data[compact_pos_for_strings + (*it).second], (*it).first.data(), (*it).first.length() + 1 /* nullbyte */);
+
+			for (import_by_name_offset_map::const_iterator it = function_names.begin(); it != function_names.end(); ++it)
+			{
+				uint16_t hint = (*it).first.first;
+				memcpy(&raw_data[compact_pos_for_strings + (*it).second], &hint, sizeof(hint));
+				memcpy(&raw_data[compact_pos_for_strings + (*it).second + sizeof(uint16_t)], (*it).first.second.data(), (*it).first.second.length() + 1 /* nullbyte */);
+			}
+		}
+
 		//Build imports
 		for (imported_functions_list::const_iterator it = imports.begin(); it != imports.end(); ++it)
 		{
@@ -476,23 +1141,22 @@ namespace pe_bliss
 			image_import_descriptor descr;
 			memset(&descr, 0, sizeof(descr));
 			descr.TimeDateStamp = (*it).get_timestamp(); //Restore timestamp
-			descr.Name = pe.rva_from_section_offset(import_section, current_string_pointer); //Library name RVA
+			descr.Name = pe.rva_from_section_offset(import_section,
+				compact ? compact_pos_for_strings + library_names[(*it).get_name()] : current_string_pointer); //Library name RVA
 
 			//If we should save IAT for current import descriptor
-			bool save_iats_for_this_descriptor = import_settings.save_iat_and_original_iat_rvas() && (*it).get_rva_to_iat() != 0;
+			bool save_iats_for_this_descriptor;
 			//If we should write original IAT
-			bool write_original_iat = (!save_iats_for_this_descriptor && import_settings.build_original_iat()) || import_settings.fill_missing_original_iats();
-
-			//If we should rewrite saved original IAT for current import descriptor (without changing its position)
-			bool rewrite_saved_original_iat = save_iats_for_this_descriptor && import_settings.rewrite_iat_and_original_iat_contents() && import_settings.build_original_iat();
-			//If we should rewrite saved IAT for current import descriptor (without changing its position)
-			bool rewrite_saved_iat = save_iats_for_this_descriptor && import_settings.rewrite_iat_and_original_iat_contents() && (*it).get_rva_to_iat() != 0;
+			bool write_original_iat;
+			//If we should rewrite saved IAT and original IAT for current import descriptor (without changing their positions)
+			bool rewrite_saved_iat, rewrite_saved_original_iat;
+			get_import_thunks_write_mode(*it, import_settings, save_iats_for_this_descriptor, write_original_iat, rewrite_saved_iat, rewrite_saved_original_iat);
 
 			//Helper values if we're rewriting existing IAT or orig.IAT
 			uint32_t original_first_thunk = 0;
 			uint32_t first_thunk = 0;
 
-			if (save_iats_for_this_descriptor)
+			if (import_settings.save_iat_and_original_iat_rvas() && (*it).get_rva_to_iat() != 0)
 			{
 				//If there's no original IAT and we're asked to rebuild missing original IATs
 				if (!(*it).get_rva_to_original_iat() && import_settings.fill_missing_original_iats())
@@ -504,17 +1168,6 @@ namespace pe_bliss
 
 				original_first_thunk = descr.OriginalFirstThunk;
 				first_thunk = descr.FirstThunk;
-
-				if (rewrite_saved_original_iat)
-				{
-					if ((*it).get_rva_to_original_iat())
-						write_original_iat = true;
-					else
-						rewrite_saved_original_iat = false;
-				}
-
-				if (rewrite_saved_iat)
-					save_iats_for_this_descriptor = false;
 			}
 			else
 			{
@@ -527,9 +1180,12 @@ namespace pe_bliss
 			memcpy(&raw_data[current_pos_for_descriptors], &descr, sizeof(descr));
 			current_pos_for_descriptors += sizeof(descr);
 
-			//Save library name
-			memcpy(&raw_data[current_string_pointer], (*it).get_name().c_str(), (*it).get_name().length() + 1 /* nullbyte */);
-			current_string_pointer += static_cast<uint32_t>((*it).get_name().length() + 1 /* nullbyte */);
+			//Save library name (library names are already written in compact mode)
+			if (!compact)
+			{
+				memcpy(&raw_data[current_string_pointer], (*it).get_name().data(), (*it).get_name().length() + 1 /* nullbyte */);
+				current_string_pointer += static_cast<uint32_t>((*it).get_name().length() + 1 /* nullbyte */);
+			}
 
 			//List all imported functions
 			const import_library::imported_list& funcs = (*it).get_imported_functions();
@@ -538,7 +1194,8 @@ namespace pe_bliss
 				if ((*f).has_name()) //If function is imported by name
 				{
 					//Get RVA of IMAGE_IMPORT_BY_NAME
-					typename PEClassType::BaseSize rva_of_named_import = pe.rva_from_section_offset(import_section, current_string_pointer);
+					typename PEClassType::BaseSize rva_of_named_import = pe.rva_from_section_offset(import_section,
+						compact ? compact_pos_for_strings + function_names[std::make_pair((*f).get_hint(), (*f).get_name())] : current_string_pointer);
 
 					if (!save_iats_for_this_descriptor)
 					{
@@ -553,7 +1210,7 @@ namespace pe_bliss
 								if (pe.section_data_length_from_rva(first_thunk, first_thunk, section_data_raw, true) <= sizeof(iat_value))
 									throw pe_exception("Insufficient space inside initial IAT", pe_exception::insufficient_space);
 
-								memcpy(pe.section_data_from_rva(first_thunk, true), &iat_value, sizeof(iat_value));
+								pe.patch_section_data(first_thunk, reinterpret_cast<const char*>(&iat_value), sizeof(iat_value), true);
 
 								first_thunk += sizeof(iat_value);
 							}
@@ -573,7 +1230,7 @@ namespace pe_bliss
 								if (pe.section_data_length_from_rva(first_thunk, first_thunk, section_data_raw, true) <= sizeof(rva_of_named_import))
 									throw pe_exception("Insufficient space inside initial IAT", pe_exception::insufficient_space);
 
-								memcpy(pe.section_data_from_rva(first_thunk, true), &rva_of_named_import, sizeof(rva_of_named_import));
+								pe.patch_section_data(first_thunk, reinterpret_cast<const char*>(&rva_of_named_import), sizeof(rva_of_named_import), true);
 
 								first_thunk += sizeof(rva_of_named_import);
 							}
@@ -592,7 +1249,7 @@ namespace pe_bliss
 							if (pe.section_data_length_from_rva(original_first_thunk, original_first_thunk, section_data_raw, true) <= sizeof(rva_of_named_import))
 								throw pe_exception("Insufficient space inside initial original IAT", pe_exception::insufficient_space);
 
-							memcpy(pe.section_data_from_rva(original_first_thunk, true), &rva_of_named_import, sizeof(rva_of_named_import));
+							pe.patch_section_data(original_first_thunk, reinterpret_cast<const char*>(&rva_of_named_import), sizeof(rva_of_named_import), true);
 
 							original_first_thunk += sizeof(rva_of_named_import);
 						}
@@ -604,11 +1261,14 @@ namespace pe_bliss
 						}
 					}
 
-					//Write IMAGE_IMPORT_BY_NAME (WORD hint + string function name)
-					uint16_t hint = (*f).get_hint();
-					memcpy(&raw_data[current_string_pointer], &hint, sizeof(hint));
-					memcpy(&raw_data[current_string_pointer + sizeof(uint16_t)], (*f).get_name().c_str(), (*f).get_name().length() + 1 /* nullbyte */);
-					current_string_pointer += static_cast<uint32_t>((*f).get_name().length() + 1 /* nullbyte */ + sizeof(uint16_t) /* hint */);
+					//Write IMAGE_IMPORT_BY_NAME (WORD hint + string function name), they are already written in compact mode
+					if (!compact)
+					{
+						uint16_t hint = (*f).get_hint();
+						memcpy(&raw_data[current_string_pointer], &hint, sizeof(hint));
+						memcpy(&raw_data[current_string_pointer + sizeof(uint16_t)], (*f).get_name().data(), (*f).get_name().length() + 1 /* nullbyte */);
+						current_string_pointer += static_cast<uint32_t>((*f).get_name().length() + 1 /* nullbyte */ + sizeof(uint16_t) /* hint */);
+					}
 				}
 				else //Function is imported by ordinal
 				{
@@ -628,13 +1288,14 @@ namespace pe_bliss
 								if (pe.section_data_length_from_rva(first_thunk, first_thunk, section_data_raw, true) <= sizeof(iat_value))
 									throw pe_exception("Insufficient space inside initial IAT", pe_exception::insufficient_space);
 
-								memcpy(pe.section_data_from_rva(first_thunk, true), &iat_value, sizeof(iat_value));
+								pe.patch_section_data(first_thunk, reinterpret_cast<const char*>(&iat_value), sizeof(iat_value), true);
 
 								first_thunk += sizeof(iat_value);
 							}
 							else
 							{
-								memcpy(&raw_data[current_pos_for_iat], &iat_value, sizeof(iat_value));
+								//New IAT gets the same value as original IAT, like for functions imported by name
+								memcpy(&raw_data[current_pos_for_iat], &thunk_value, sizeof(thunk_value));
 								current_pos_for_iat += sizeof(thunk_value);
 							}
 						}
@@ -646,13 +1307,14 @@ namespace pe_bliss
 								if (pe.section_data_length_from_rva(first_thunk, first_thunk, section_data_raw, true) <= sizeof(thunk_value))
 									throw pe_exception("Insufficient space inside initial IAT", pe_exception::insufficient_space);
 
-								memcpy(pe.section_data_from_rva(first_thunk, true), &thunk_value, sizeof(thunk_value));
+								pe.patch_section_data(first_thunk, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value), true);
 
 								first_thunk += sizeof(thunk_value);
 							}
 							else
 							{
 								memcpy(&raw_data[current_pos_for_iat], &thunk_value, sizeof(thunk_value));
+								current_pos_for_iat += sizeof(thunk_value);
 							}
 						}
 					}
@@ -665,7 +1327,7 @@ namespace pe_bliss
 							if (pe.section_data_length_from_rva(original_first_thunk, original_first_thunk, section_data_raw, true) <= sizeof(thunk_value))
 								throw pe_exception("Insufficient space inside initial original IAT", pe_exception::insufficient_space);
 
-							memcpy(pe.section_data_from_rva(original_first_thunk, true), &thunk_value, sizeof(thunk_value));
+							pe.patch_section_data(original_first_thunk, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value), true);
 
 							original_first_thunk += sizeof(thunk_value);
 						}
@@ -688,7 +1350,7 @@ namespace pe_bliss
 					if (pe.section_data_length_from_rva(first_thunk, first_thunk, section_data_raw, true) <= sizeof(thunk_value))
 						throw pe_exception("Insufficient space inside initial IAT", pe_exception::insufficient_space);
 
-					memcpy(pe.section_data_from_rva(first_thunk, true), &thunk_value, sizeof(thunk_value));
+					pe.patch_section_data(first_thunk, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value), true);
 
 					first_thunk += sizeof(thunk_value);
 				}
@@ -709,7 +1371,7 @@ namespace pe_bliss
 					if (pe.section_data_length_from_rva(original_first_thunk, original_first_thunk, section_data_raw, true) <= sizeof(thunk_value))
 						throw pe_exception("Insufficient space inside initial original IAT", pe_exception::insufficient_space);
 
-					memcpy(pe.section_data_from_rva(original_first_thunk, true), &thunk_value, sizeof(thunk_value));
+					pe.patch_section_data(original_first_thunk, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value), true);
 
 					original_first_thunk += sizeof(thunk_value);
 				}
@@ -730,13 +1392,247 @@ namespace pe_bliss
 
 		//Strip data a little, if we saved some place
 		//We're allocating more space than needed, if present original IAT and IAT are saved
-		raw_data.resize(current_pos_for_original_iat);
+		//Exactly needed space is allocated in compact mode, and data after import directory is kept
+		if (!compact)
+			raw_data.resize(current_pos_for_original_iat);
 
 		//Adjust section raw and virtual sizes
 		pe.recalculate_section_sizes(import_section, import_settings.auto_strip_last_section_enabled());
 
 		//Return information about rebuilt import directory
-		image_directory ret(pe.rva_from_section_offset(import_section, import_settings.get_offset_from_section_start() + needed_size_for_strings), needed_size - needed_size_for_strings);
+		image_directory ret = compact
+			? image_directory(pe.rva_from_section_offset(import_section, compact_pos_for_descriptors), compact_pos_for_strings - compact_pos_for_descriptors)
+			: image_directory(pe.rva_from_section_offset(import_section, import_settings.get_offset_from_section_start() + needed_size_for_strings), needed_size - needed_size_for_strings);
+
+		//If auto-rewrite of PE headers is required
+		if (import_settings.auto_set_to_pe_headers())
+		{
+			pe.set_directory_rva(image_directory_entry_import, ret.get_rva());
+			pe.set_directory_size(image_directory_entry_import, ret.get_size());
+
+			//If we are requested to zero IMAGE_DIRECTORY_ENTRY_IAT also
+			if (import_settings.zero_directory_entry_iat())
+			{
+				pe.set_directory_rva(image_directory_entry_iat, 0);
+				pe.set_directory_size(image_directory_entry_iat, 0);
+			}
+		}
+
+		return ret;
+	}
+
+	//Helper function to make section virtual size cover data written to its raw data
+	//If raw data was expanded, section sizes are recalculated, otherwise only virtual size is changed (if needed),
+	//so raw data patches are kept
+	void cover_import_section_data(pe_base& pe, section& s, uint32_t data_end, bool raw_data_expanded, bool auto_strip)
+	{
+		if (raw_data_expanded)
+		{
+			pe.recalculate_section_sizes(s, auto_strip);
+		}
+		else if (s.get_virtual_size() < data_end)
+		{
+			//Data of sections, except the last one, is placed inside of their aligned virtual size, so layout is not changed
+			if (&s == &pe.get_image_sections().back())
+				pe.set_section_virtual_size(s, data_end);
+			else
+				s.set_virtual_size(data_end);
+		}
+	}
+
+	//Helper function to check if import descriptor array can be extended in place
+	//Space after ending null descriptor must be unused (after section virtual size), zero-filled, be inside of section raw data
+	//and aligned virtual size, and must not intersect with new import data placed to data_section
+	bool import_descriptors_extendable(pe_base& pe, uint32_t descriptors_rva, uint32_t number_of_descriptors, uint32_t number_of_new_descriptors,
+		const section& data_section, uint32_t data_pos, uint32_t data_end, section*& descriptors_section, uint32_t& ending_descriptor_pos)
+	{
+		section_list& sections = pe.get_image_sections();
+		for (section_list::iterator it = sections.begin(); it != sections.end(); ++it)
+		{
+			//Section data is only read here, it is patched by caller
+			const section& s = *it;
+			if (descriptors_rva < s.get_virtual_address() || descriptors_rva - s.get_virtual_address() >= s.get_aligned_virtual_size(pe.get_section_alignment()))
+				continue;
+
+			const std::string& raw_data = s.get_raw_data();
+
+			uint64_t pos = static_cast<uint64_t>(descriptors_rva - s.get_virtual_address()) + number_of_descriptors * sizeof(image_import_descriptor);
+			uint64_t extension_start = pos + sizeof(image_import_descriptor);
+			uint64_t extension_end = pos + (1 + number_of_new_descriptors) * sizeof(image_import_descriptor);
+
+			if (extension_start < s.get_virtual_size()
+				|| extension_end > raw_data.length()
+				|| extension_end > s.get_aligned_virtual_size(pe.get_section_alignment()))
+				return false;
+
+			if (&s == &data_section && extension_start < data_end && data_pos < extension_end)
+				return false;
+
+			std::string::size_type first_not_zero = raw_data.find_first_not_of('\0', static_cast<std::string::size_type>(extension_start));
+			if (first_not_zero < extension_end)
+				return false;
+
+			descriptors_section = &*it;
+			ending_descriptor_pos = static_cast<uint32_t>(pos);
+			return true;
+		}
+
+		//Descriptors are placed in headers or outside of image
+		return false;
+	}
+
+	//Appends imported libraries to import directory without rebuilding it
+	template<typename PEClassType>
+	image_directory append_imports_base(pe_base& pe, const imported_functions_list& imports, section& import_section, const import_rebuilder_settings& import_settings)
+	{
+		//Check that import_section is attached to this PE image
+		if (!pe.section_attached(import_section))
+			throw pe_exception("Import section must be attached to PE file", pe_exception::section_is_not_attached);
+
+		//New IATs are always created for appended libraries
+		import_rebuilder_settings new_settings(import_settings);
+		new_settings.save_iat_and_original_iat_rvas(false);
+		new_settings.fill_missing_original_iats(false);
+
+		uint32_t size_of_iat, size_of_original_iat, size_of_strings;
+		import_name_offset_map library_names;
+		import_by_name_offset_map function_names;
+		get_compact_imports_sizes(imports, new_settings, sizeof(typename PEClassType::BaseSize), size_of_iat, size_of_original_iat, size_of_strings, library_names, function_names);
+
+		//Read existing import descriptors (they are copied as is, if descriptor array can't be extended)
+		std::vector<image_import_descriptor> descriptors;
+		uint32_t descriptors_rva = 0;
+		if (pe.has_imports())
+		{
+			descriptors_rva = pe.get_directory_rva(image_directory_entry_import);
+			while (true)
+			{
+				image_import_descriptor descr = pe.section_data_from_rva<image_import_descriptor>(static_cast<uint32_t>(descriptors_rva + descriptors.size() * sizeof(image_import_descriptor)), section_data_virtual, true);
+				if (!descr.Name)
+					break;
+
+				descriptors.push_back(descr);
+			}
+		}
+
+		uint32_t number_of_descriptors = static_cast<uint32_t>(descriptors.size());
+
+		uint32_t pos_for_descriptors, pos_for_iat, pos_for_strings;
+
+		//Layout of new data without descriptors is calculated first to check, if descriptor array can be extended in place
+		uint32_t data_end = get_compact_imports_layout(import_settings.get_offset_from_section_start(), 0, sizeof(typename PEClassType::BaseSize),
+			size_of_iat, size_of_original_iat, size_of_strings, pos_for_descriptors, pos_for_iat, pos_for_strings);
+
+		section* descriptors_section = 0;
+		uint32_t ending_descriptor_pos = 0;
+		bool extend_descriptors = number_of_descriptors != 0
+			&& import_descriptors_extendable(pe, descriptors_rva, number_of_descriptors, static_cast<uint32_t>(imports.size()),
+				import_section, pos_for_descriptors, data_end, descriptors_section, ending_descriptor_pos);
+
+		uint32_t size_of_descriptors = static_cast<uint32_t>((1 /* ending null descriptor */ + number_of_descriptors + imports.size()) * sizeof(image_import_descriptor));
+		if (!extend_descriptors)
+		{
+			//Descriptor array is copied to import_section
+			data_end = get_compact_imports_layout(import_settings.get_offset_from_section_start(), size_of_descriptors, sizeof(typename PEClassType::BaseSize),
+				size_of_iat, size_of_original_iat, size_of_strings, pos_for_descriptors, pos_for_iat, pos_for_strings);
+		}
+
+		//Check if import_section is last one. If it's not, check if there's enough place for import data
+		if (&import_section != &*(pe.get_image_sections().end() - 1) &&
+			(import_section.empty() || pe_utils::align_up(import_section.get_size_of_raw_data(), pe.get_file_alignment()) < data_end))
+			throw pe_exception("Insufficient space for import directory", pe_exception::insufficient_space);
+
+		//Data is patched, so only changed ranges are marked dirty, raw data is expanded only if it's too small
+		//(length is read through const reference, so section is not marked rewritten otherwise)
+		bool raw_data_expanded = static_cast<const section&>(import_section).get_raw_data().length() < data_end;
+		if (raw_data_expanded)
+			import_section.get_raw_data().resize(data_end);
+
+		//Write deduplicated library names and IMAGE_IMPORT_BY_NAME structures (WORD hint + string function name)
+		for (import_name_offset_map::const_iterator it = library_names.begin(); it != library_names.end(); ++it)
+			import_section.patch_raw_data(pos_for_strings + (*it).second, (*it).first.data(), static_cast<uint32_t>((*it).first.length() + 1 /* nullbyte */));
+
+		for (import_by_name_offset_map::const_iterator it = function_names.begin(); it != function_names.end(); ++it)
+		{
+			uint16_t hint = (*it).first.first;
+			import_section.patch_raw_data(pos_for_strings + (*it).second, reinterpret_cast<const char*>(&hint), sizeof(hint));
+			import_section.patch_raw_data(static_cast<uint32_t>(pos_for_strings + (*it).second + sizeof(uint16_t)), (*it).first.second.data(), static_cast<uint32_t>((*it).first.second.length() + 1 /* nullbyte */));
+		}
+
+		//Write thunk tables and build new descriptors
+		descriptors.reserve(number_of_descriptors + imports.size() + 1);
+
+		uint32_t current_pos_for_iat = pos_for_iat;
+		uint32_t current_pos_for_original_iat = pos_for_iat + size_of_iat;
+		for (imported_functions_list::const_iterator it = imports.begin(); it != imports.end(); ++it)
+		{
+			image_import_descriptor descr;
+			memset(&descr, 0, sizeof(descr));
+			descr.TimeDateStamp = (*it).get_timestamp();
+			descr.Name = pe.rva_from_section_offset(import_section, pos_for_strings + library_names[(*it).get_name()]);
+			descr.FirstThunk = pe.rva_from_section_offset(import_section, current_pos_for_iat);
+			if (import_settings.build_original_iat())
+				descr.OriginalFirstThunk = pe.rva_from_section_offset(import_section, current_pos_for_original_iat);
+
+			descriptors.push_back(descr);
+
+			//IAT and original IAT have the same contents (RVAs of IMAGE_IMPORT_BY_NAME or ordinals), ending null thunk is already zero
+			const import_library::imported_list& funcs = (*it).get_imported_functions();
+			for (import_library::imported_list::const_iterator f = funcs.begin(); f != funcs.end(); ++f)
+			{
+				typename PEClassType::BaseSize thunk_value;
+				if ((*f).has_name())
+					thunk_value = pe.rva_from_section_offset(import_section, pos_for_strings + function_names[std::make_pair((*f).get_hint(), (*f).get_name())]);
+				else
+					thunk_value = static_cast<typename PEClassType::BaseSize>((*f).get_ordinal()) | PEClassType::ImportSnapFlag;
+
+				import_section.patch_raw_data(current_pos_for_iat, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value));
+				current_pos_for_iat += sizeof(thunk_value);
+
+				if (import_settings.build_original_iat())
+				{
+					import_section.patch_raw_data(current_pos_for_original_iat, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value));
+					current_pos_for_original_iat += sizeof(thunk_value);
+				}
+			}
+
+			//Ending null thunks
+			typename PEClassType::BaseSize thunk_value = 0;
+			import_section.patch_raw_data(current_pos_for_iat, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value));
+			current_pos_for_iat += sizeof(thunk_value);
+
+			if (import_settings.build_original_iat())
+			{
+				import_section.patch_raw_data(current_pos_for_original_iat, reinterpret_cast<const char*>(&thunk_value), sizeof(thunk_value));
+				current_pos_for_original_iat += sizeof(thunk_value);
+			}
+		}
+
+		{
+			//Null ending descriptor
+			image_import_descriptor descr;
+			memset(&descr, 0, sizeof(descr));
+			descriptors.push_back(descr);
+		}
+
+		image_directory ret;
+		if (extend_descriptors)
+		{
+			//New descriptors replace ending null descriptor of existing array
+			uint32_t size_of_new_descriptors = static_cast<uint32_t>((imports.size() + 1) * sizeof(image_import_descriptor));
+			descriptors_section->patch_raw_data(ending_descriptor_pos, reinterpret_cast<const char*>(&descriptors[number_of_descriptors]), size_of_new_descriptors);
+			cover_import_section_data(pe, *descriptors_section, ending_descriptor_pos + size_of_new_descriptors, false, false);
+
+			ret = image_directory(descriptors_rva, size_of_descriptors);
+		}
+		else
+		{
+			import_section.patch_raw_data(pos_for_descriptors, reinterpret_cast<const char*>(&descriptors[0]), size_of_descriptors);
+			ret = image_directory(pe.rva_from_section_offset(import_section, pos_for_descriptors), size_of_descriptors);
+		}
+
+		//Adjust section raw and virtual sizes
+		cover_import_section_data(pe, import_section, data_end, raw_data_expanded, import_settings.auto_strip_last_section_enabled());
 
 		//If auto-rewrite of PE headers is required
 		if (import_settings.auto_set_to_pe_headers())
@@ -754,4 +1650,65 @@ namespace pe_bliss
 
 		return ret;
 	}
+
+	//Searches for section, which has enough slack to hold import directory rebuilt in compact mode
+	section* find_import_section_slack(pe_base& pe, const imported_functions_list& imports, import_rebuilder_settings& import_settings)
+	{
+		uint32_t thunk_size = pe.get_pe_type() == pe_type_32 ? sizeof(uint32_t) : sizeof(uint64_t);
+
+		//Calculate sizes of import directory parts with compact mode enabled
+		import_rebuilder_settings compact_settings(import_settings);
+		compact_settings.enable_compact_mode(true);
+
+		uint32_t size_of_iat, size_of_original_iat, size_of_strings;
+		import_name_offset_map library_names;
+		import_by_name_offset_map function_names;
+		get_compact_imports_sizes(imports, compact_settings, thunk_size, size_of_iat, size_of_original_iat, size_of_strings, library_names, function_names);
+
+		section* ret = 0;
+		uint32_t ret_offset = 0, ret_slack = 0;
+
+		section_list& sections = pe.get_image_sections();
+		for (section_list::iterator it = sections.begin(); it != sections.end(); ++it)
+		{
+			//Section data is only read here, so it stays shared and unchanged
+			const section& s = *it;
+			const std::string& raw_data = s.get_raw_data();
+
+			//Slack starts after section virtual size (data beyond raw data, which virtual size covers, is zero-initialized by loader
+			//and may be used by image) and ends with file-aligned raw data (section virtual size must not grow beyond next section)
+			uint32_t used_size = s.get_virtual_size();
+			if (!used_size || used_size > raw_data.length())
+				continue;
+
+			uint32_t slack_end = std::min<uint32_t>(pe_utils::align_up(s.get_size_of_raw_data(), pe.get_file_alignment()),
+				s.get_aligned_virtual_size(pe.get_section_alignment()));
+			if (slack_end <= used_size)
+				continue;
+
+			uint32_t pos_for_descriptors, pos_for_iat, pos_for_strings;
+			uint32_t end = get_compact_imports_layout(used_size, static_cast<uint32_t>((1 /* ending null descriptor */ + imports.size()) * sizeof(image_import_descriptor)),
+				thunk_size, size_of_iat, size_of_original_iat, size_of_strings,
+				pos_for_descriptors, pos_for_iat, pos_for_strings);
+			if (end > slack_end || (ret && ret_slack <= slack_end - used_size))
+				continue;
+
+			//Slack must not contain any data
+			std::string::size_type data_end = std::min<std::string::size_type>(raw_data.length(), slack_end);
+			if (raw_data.find_first_not_of('\0', used_size) < data_end)
+				continue;
+
+			ret = &*it;
+			ret_offset = used_size;
+			ret_slack = slack_end - used_size;
+		}
+
+		if (ret)
+		{
+			import_settings.enable_compact_mode(true);
+			import_settings.set_offset_from_section_start(ret_offset);
+		}
+
+		return ret;
+	}
 }
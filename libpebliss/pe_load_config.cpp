@@ -317,7 +317,7 @@ namespace pe_bliss
 
 	//Returns image config info
 	//If image does not have config info, throws an exception
-	const image_config_info get_image_config(const pe_base& pe)
+	image_config_info get_image_config(const pe_base& pe)
 	{
 		return pe.get_pe_type() == pe_type_32
 			? get_image_config_base<pe_types_class_32>(pe)
@@ -325,7 +325,7 @@ namespace pe_bliss
 	}
 
 	//Image config rebuilder
-	const image_directory rebuild_image_config(pe_base& pe, const image_config_info& info, section& image_config_section, uint32_t offset_from_section_start, bool write_se_handlers, bool write_lock_prefixes, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_image_config(pe_base& pe, const image_config_info& info, section& image_config_section, uint32_t offset_from_section_start, bool write_se_handlers, bool write_lock_prefixes, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		return pe.get_pe_type() == pe_type_32
 			? rebuild_image_config_base<pe_types_class_32>(pe, info, image_config_section, offset_from_section_start, write_se_handlers, write_lock_prefixes, save_to_pe_header, auto_strip_last_section)
@@ -335,7 +335,7 @@ namespace pe_bliss
 	//Returns image config info
 	//If image does not have config info, throws an exception
 	template<typename PEClassType>
-	const image_config_info get_image_config_base(const pe_base& pe)
+	image_config_info get_image_config_base(const pe_base& pe)
 	{
 		//Check if image has config directory
 		if (!pe.has_config())
@@ -384,7 +384,7 @@ namespace pe_bliss
 	//If write_se_handlers = true, SE Handlers list will be written just after image config directory structure
 	//If write_lock_prefixes = true, Lock Prefixes address list will be written just after image config directory structure
 	template<typename PEClassType>
-	const image_directory rebuild_image_config_base(pe_base& pe, const image_config_info& info, section& image_config_section, uint32_t offset_from_section_start, bool write_se_handlers, bool write_lock_prefixes, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_image_config_base(pe_base& pe, const image_config_info& info, section& image_config_section, uint32_t offset_from_section_start, bool write_se_handlers, bool write_lock_prefixes, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		//Check that image_config_section is attached to this PE image
 		if (!pe.section_attached(image_config_section))
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include "pe_module_set.h"
+
+namespace pe_bliss
+{
+	//IMPORT BINDING
+	//Default constructor
+	import_binding::import_binding()
+	{}
+
+	//Returns resolved symbol of imported function
+	const resolved_symbol& import_binding::get_symbol(std::size_t library_index, std::size_t function_index) const
+	{
+		if (library_index >= library_offsets_.size())
+			throw pe_exception("Imported library not found", pe_exception::import_not_found);
+
+		std::size_t first = library_offsets_[library_index];
+		std::size_t last = library_index + 1 == library_offsets_.size() ? symbols_.size() : library_offsets_[library_index + 1];
+		if (function_index >= last - first)
+			throw pe_exception("Imported function not found", pe_exception::import_not_found);
+
+		return symbols_[first + function_index];
+	}
+
+	//Returns list of unresolved imports
+	const unresolved_import_list& import_binding::get_unresolved() const
+	{
+		return unresolved_;
+	}
+
+	//Returns true if all imports were resolved
+	bool import_binding::all_resolved() const
+	{
+		return unresolved_.empty();
+	}
+
+	//Starts next library
+	void import_binding::add_library()
+	{
+		library_offsets_.push_back(static_cast<uint32_t>(symbols_.size()));
+	}
+
+	//Adds resolved symbol of next function of the last library
+	void import_binding::add_symbol(const resolved_symbol& symbol)
+	{
+		if (symbol.status != symbol_resolved)
+		{
+			unresolved_import unresolved = { static_cast<uint32_t>(library_offsets_.size() - 1),
+				static_cast<uint32_t>(symbols_.size() - library_offsets_.back()), symbol.status };
+			unresolved_.push_back(unresolved);
+		}
+
+		symbols_.push_back(symbol);
+	}
+
+	//Helper function to make normalized module name (lower-case, with extension) as it's done by loader
+	std::string normalize_module_name(std::string_view name)
+	{
+		std::string ret(name);
+		for (std::string::iterator it = ret.begin(); it != ret.end(); ++it)
+		{
+			if ((*it) >= 'A' && (*it) <= 'Z')
+				(*it) = static_cast<char>((*it) - 'A' + 'a');
+		}
+
+		if (ret.find('.') == std::string::npos)
+			ret += ".dll";
+
+		return ret;
+	}
+
+	//Helper function to create resolved symbol with error status
+	resolved_symbol make_unresolved_symbol(symbol_resolve_status status)
+	{
+		resolved_symbol ret = { status, 0, 0, 0 };
+		return ret;
+	}
+
+	//MODULE SET
+	//Module information constructor
+	module_set::module_entry::module_entry(std::pmr::memory_resource* resource)
+		:timestamp(0), exports(resource), ordinal_base(0)
+	{}
+
+	//Default constructor
+	module_set::module_set()
+		:prepared_(true)
+	{}
+
+	//Adds module with specified name, exports are read from image
+	std::size_t module_set::add_module(std::string_view name, const pe_base& pe)
+	{
+		return add_module(name, get_exported_functions(pe, &resource_, &names_), pe.get_time_date_stamp());
+	}
+
+	//Adds module with specified name, exports list and image timestamp
+	std::size_t module_set::add_module(std::string_view name, const exported_functions_list& exports, uint32_t timestamp)
+	{
+		module_entry entry(&resource_);
+		entry.name = normalize_module_name(name);
+		entry.timestamp = timestamp;
+
+		//Names are interned in own pool, so they are alive as long as module set is alive
+		entry.exports.reserve(exports.size());
+		for (exported_functions_list::const_iterator it = exports.begin(); it != exports.end(); ++it)
+		{
+			entry.exports.push_back(*it);
+			exported_function& func = entry.exports.back();
+			if ((*it).has_name())
+				func.set_name((*it).get_name(), names_);
+			if ((*it).is_forwarded())
+				func.set_forwarded_name((*it).get_forwarded_name(), names_);
+		}
+
+		//Index exported names and ordinals
+		entry.names.reserve(entry.exports.size());
+		if (!entry.exports.empty())
+		{
+			std::pair<uint16_t, uint16_t> limits = get_export_ordinal_limits(entry.exports);
+			entry.ordinal_base = limits.first;
+			entry.ordinals.resize(static_cast<std::size_t>(limits.second - limits.first) + 1);
+		}
+
+		for (uint32_t i = 0; i != entry.exports.size(); ++i)
+		{
+			const exported_function& func = entry.exports[i];
+			if (func.has_name())
+				entry.names.insert(std::make_pair(func.get_name(), i));
+
+			entry.ordinals[func.get_ordinal() - entry.ordinal_base] = i + 1;
+		}
+
+		entry.forward_targets.resize(entry.exports.size());
+
+		prepared_ = false;
+
+		std::unordered_map<std::string, std::size_t>::const_iterator it = module_indexes_.find(entry.name);
+		if (it != module_indexes_.end())
+		{
+			modules_[(*it).second] = std::move(entry);
+			return (*it).second;
+		}
+
+		module_indexes_.insert(std::make_pair(entry.name, modules_.size()));
+		modules_.push_back(std::move(entry));
+		return modules_.size() - 1;
+	}
+
+	//Returns index of module or npos, if module is not found
+	std::size_t module_set::find_module(std::string_view name) const
+	{
+		std::unordered_map<std::string, std::size_t>::const_iterator it = module_indexes_.find(normalize_module_name(name));
+		return it == module_indexes_.end() ? npos : (*it).second;
+	}
+
+	//Returns number of modules
+	std::size_t module_set::get_module_count() const
+	{
+		return modules_.size();
+	}
+
+	//Returns name of module
+	const std::string& module_set::get_module_name(std::size_t index) const
+	{
+		if (index >= modules_.size())
+			throw pe_exception("Module not found", pe_exception::module_not_found);
+
+		return modules_[index].name;
+	}
+
+	//Returns timestamp of module image
+	uint32_t module_set::get_module_timestamp(std::size_t index) const
+	{
+		if (index >= modules_.size())
+			throw pe_exception("Module not found", pe_exception::module_not_found);
+
+		return modules_[index].timestamp;
+	}
+
+	//Returns exports of module
+	const exported_functions_list& module_set::get_module_exports(std::size_t index) const
+	{
+		if (index >= modules_.size())
+			throw pe_exception("Module not found", pe_exception::module_not_found);
+
+		return modules_[index].exports;
+	}
+
+	//Returns index of export by name, or -1, if not found
+	uint32_t module_set::find_export(const module_entry& module, std::string_view name) const
+	{
+		std::unordered_map<std::string_view, uint32_t>::const_iterator it = module.names.find(name);
+		return it == module.names.end() ? static_cast<uint32_t>(-1) : (*it).second;
+	}
+
+	//Returns index of export by ordinal, or -1, if not found
+	uint32_t module_set::find_export(const module_entry& module, uint16_t ordinal) const
+	{
+		if (ordinal < module.ordinal_base || static_cast<std::size_t>(ordinal - module.ordinal_base) >= module.ordinals.size())
+			return static_cast<uint32_t>(-1);
+
+		return module.ordinals[ordinal - module.ordinal_base] - 1;
+	}
+
+	//Resolves all forwarders, if modules were changed
+	void module_set::prepare()
+	{
+		if (prepared_)
+			return;
+
+		std::vector<std::vector<uint8_t> > states(modules_.size());
+		for (std::size_t i = 0; i != modules_.size(); ++i)
+			states[i].resize(modules_[i].exports.size());
+
+		for (uint32_t i = 0; i != modules_.size(); ++i)
+		{
+			for (uint32_t j = 0; j != modules_[i].exports.size(); ++j)
+			{
+				if (modules_[i].exports[j].is_forwarded() && states[i][j] != 2)
+					resolve_forwarder(i, j, states);
+			}
+		}
+
+		prepared_ = true;
+	}
+
+	//Resolves forwarded export
+	resolved_symbol module_set::resolve_forwarder(uint32_t module_index, uint32_t export_index, std::vector<std::vector<uint8_t> >& states)
+	{
+		uint8_t& state = states[module_index][export_index];
+		resolved_symbol& target = modules_[module_index].forward_targets[export_index];
+
+		if (state == 2)
+			return target;
+
+		if (state == 1)
+			return make_unresolved_symbol(symbol_forwarder_cycle);
+
+		state = 1;
+
+		//Forwarder has form "MODULE.Name" or "MODULE.#Ordinal", module name may contain dots itself
+		std::string_view forward = modules_[module_index].exports[export_index].get_forwarded_name();
+		std::string_view::size_type dot = forward.rfind('.');
+
+		resolved_symbol ret;
+		std::size_t target_module = dot == std::string_view::npos ? npos : find_module(forward.substr(0, dot));
+		if (target_module == npos)
+		{
+			ret = make_unresolved_symbol(symbol_module_not_found);
+		}
+		else
+		{
+			std::string_view symbol = forward.substr(dot + 1);
+			uint32_t target_export = static_cast<uint32_t>(-1);
+			if (symbol.length() > 1 && symbol[0] == '#')
+			{
+				uint32_t ordinal = 0;
+				bool valid = true;
+				for (std::string_view::size_type i = 1; i != symbol.length() && valid; ++i)
+				{
+					valid = symbol[i] >= '0' && symbol[i] <= '9';
+					ordinal = ordinal * 10 + (symbol[i] - '0');
+					valid = valid && ordinal <= 0xffff;
+				}
+
+				if (valid)
+					target_export = find_export(modules_[target_module], static_cast<uint16_t>(ordinal));
+			}
+			else
+			{
+				target_export = find_export(modules_[target_module], symbol);
+			}
+
+			if (target_export == static_cast<uint32_t>(-1))
+				ret = make_unresolved_symbol(symbol_not_found);
+			else if (modules_[target_module].exports[target_export].is_forwarded())
+				ret = resolve_forwarder(static_cast<uint32_t>(target_module), target_export, states);
+			else
+				ret = get_export_symbol(static_cast<uint32_t>(target_module), target_export);
+		}
+
+		//Exports, which forward to looped chain, are reported as looped too, so result is always cached
+		state = 2;
+		target = ret;
+		return ret;
+	}
+
+	//Returns resolved symbol for export
+	resolved_symbol module_set::get_export_symbol(uint32_t module_index, uint32_t export_index) const
+	{
+		const exported_function& func = modules_[module_index].exports[export_index];
+		if (func.is_forwarded())
+			return modules_[module_index].forward_targets[export_index];
+
+		resolved_symbol ret = { symbol_resolved, module_index, func.get_rva(), func.get_ordinal() };
+		return ret;
+	}
+
+	//Resolves symbol exported by name, following forwarders
+	resolved_symbol module_set::resolve(std::string_view module_name, std::string_view name)
+	{
+		prepare();
+
+		std::size_t module_index = find_module(module_name);
+		if (module_index == npos)
+			return make_unresolved_symbol(symbol_module_not_found);
+
+		uint32_t export_index = find_export(modules_[module_index], name);
+		if (export_index == static_cast<uint32_t>(-1))
+			return make_unresolved_symbol(symbol_not_found);
+
+		return get_export_symbol(static_cast<uint32_t>(module_index), export_index);
+	}
+
+	//Resolves symbol exported by ordinal, following forwarders
+	resolved_symbol module_set::resolve(std::string_view module_name, uint16_t ordinal)
+	{
+		prepare();
+
+		std::size_t module_index = find_module(module_name);
+		if (module_index == npos)
+			return make_unresolved_symbol(symbol_module_not_found);
+
+		uint32_t export_index = find_export(modules_[module_index], ordinal);
+		if (export_index == static_cast<uint32_t>(-1))
+			return make_unresolved_symbol(symbol_not_found);
+
+		return get_export_symbol(static_cast<uint32_t>(module_index), export_index);
+	}
+
+	//Binds imports of image
+	import_binding module_set::bind_prepared_imports(const imported_functions_list& imports) const
+	{
+		import_binding ret;
+		for (imported_functions_list::const_iterator it = imports.begin(); it != imports.end(); ++it)
+		{
+			ret.add_library();
+
+			std::size_t module_index = find_module((*it).get_name());
+			const import_library::imported_list& funcs = (*it).get_imported_functions();
+			for (import_library::imported_list::const_iterator f = funcs.begin(); f != funcs.end(); ++f)
+			{
+				if (module_index == npos)
+				{
+					ret.add_symbol(make_unresolved_symbol(symbol_module_not_found));
+					continue;
+				}
+
+				uint32_t export_index = (*f).has_name()
+					? find_export(modules_[module_index], (*f).get_name())
+					: find_export(modules_[module_index], (*f).get_ordinal());
+
+				ret.add_symbol(export_index == static_cast<uint32_t>(-1)
+					? make_unresolved_symbol(symbol_not_found)
+					: get_export_symbol(static_cast<uint32_t>(module_index), export_index));
+			}
+		}
+
+		return ret;
+	}
+
+	//Binds imports of image, resolving each imported function
+	import_binding module_set::bind_imports(const imported_functions_list& imports)
+	{
+		prepare();
+		return bind_prepared_imports(imports);
+	}
+
+	//Binds imports of several images in parallel
+	std::vector<import_binding> module_set::bind_imports(const std::vector<const imported_functions_list*>& images, uint32_t max_threads)
+	{
+		//Forwarders are resolved before binding, so module set is not changed by workers
+		prepare();
+
+		std::vector<import_binding> ret(images.size());
+
+		uint32_t thread_count = max_threads ? max_threads : std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+		thread_count = static_cast<uint32_t>(std::min<std::size_t>(thread_count, images.size()));
+
+		if (thread_count <= 1)
+		{
+			for (std::size_t i = 0; i != images.size(); ++i)
+				ret[i] = bind_prepared_imports(*images[i]);
+
+			return ret;
+		}
+
+		//Each worker takes next unbound image, each image has its own result
+		std::atomic<std::size_t> next_image(0);
+		std::vector<std::future<void> > workers;
+		for (uint32_t i = 0; i != thread_count; ++i)
+		{
+			workers.push_back(std::async(std::launch::async, [this, &images, &ret, &next_image]()
+				{
+					for (std::size_t image = next_image++; image < images.size(); image = next_image++)
+						ret[image] = bind_prepared_imports(*images[image]);
+				}));
+		}
+
+		//Wait for all workers, rethrow first error, if any
+		for (std::size_t i = 0; i != workers.size(); ++i)
+			workers[i].wait();
+		for (std::size_t i = 0; i != workers.size(); ++i)
+			workers[i].get();
+
+		return ret;
+	}
+
+	//Helper function to check timestamp of bound module
+	void check_bound_import_timestamp(const module_set& modules, std::string_view module_name, uint32_t bound_timestamp, stale_bound_import_list& stale)
+	{
+		std::size_t index = modules.find_module(module_name);
+		if (index == module_set::npos)
+		{
+			stale_bound_import elem = { module_name, bound_timestamp, 0, false };
+			stale.push_back(elem);
+		}
+		else if (modules.get_module_timestamp(index) != bound_timestamp)
+		{
+			stale_bound_import elem = { module_name, bound_timestamp, modules.get_module_timestamp(index), true };
+			stale.push_back(elem);
+		}
+	}
+
+	//Checks bound import modules (and their forwarder references) timestamps against timestamps of modules
+	stale_bound_import_list module_set::check_bound_imports(const bound_import_module_list& bound_imports) const
+	{
+		stale_bound_import_list ret;
+		for (bound_import_module_list::const_iterator it = bound_imports.begin(); it != bound_imports.end(); ++it)
+		{
+			check_bound_import_timestamp(*this, (*it).get_module_name(), (*it).get_timestamp(), ret);
+
+			const bound_import::ref_list& refs = (*it).get_module_ref_list();
+			for (bound_import::ref_list::const_iterator ref = refs.begin(); ref != refs.end(); ++ref)
+				check_bound_import_timestamp(*this, (*ref).get_module_name(), (*ref).get_timestamp(), ret);
+		}
+
+		return ret;
+	}
+}
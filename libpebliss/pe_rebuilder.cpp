@@ -1,7 +1,13 @@
+#include <algorithm>
+#include <cstring>
 #include "pe_rebuilder.h"
 #include "pe_base.h"
 #include "pe_structures.h"
 #include "pe_exception.h"
+#ifndef PE_BLISS_WINDOWS
+#include <cerrno>
+#include <unistd.h>
+#endif
 
 namespace pe_bliss
 {
@@ -11,7 +17,8 @@ namespace pe_bliss
 	//If strip_dos_header is true, DOS headers partially will be used for PE headers
 	//If change_size_of_headers == true, SizeOfHeaders will be recalculated automatically
 	//If save_bound_import == true, existing bound import directory will be saved correctly (because some compilers and bind.exe put it to PE headers)
-	void rebuild_pe(pe_base& pe, image_dos_header& dos_header, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	//Returns file offset of data following the last section (file-aligned), where overlay is placed
+	uint32_t rebuild_pe(pe_base& pe, image_dos_header& dos_header, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
 	{
 		dos_header = pe.get_dos_header();
 
@@ -75,17 +82,269 @@ namespace pe_bliss
 			(*it).set_pointer_to_raw_data(static_cast<uint32_t>(ptr_to_section_data));
 			ptr_to_section_data += (*it).get_aligned_raw_size(pe.get_file_alignment());
 		}
+
+		//Last section is written with actual raw data length, which may exceed its SizeOfRawData
+		if (!sections.empty())
+		{
+			const section& last = sections.back();
+			ptr_to_section_data = std::max<size_t>(ptr_to_section_data,
+				pe_utils::align_up(static_cast<size_t>(last.get_pointer_to_raw_data()) + last.get_raw_data().length(), pe.get_file_alignment()));
+		}
+
+		return static_cast<uint32_t>(ptr_to_section_data);
 	}
 
-	//Rebuild PE image and write it to "out" ostream
+	//Default constructor
+	rebuilt_pe::rebuilt_pe()
+		:size_(0), end_of_sections_(0)
+	{}
+
+	//Copy constructor
+	rebuilt_pe::rebuilt_pe(const rebuilt_pe& other)
+		:size_(0), end_of_sections_(0)
+	{
+		*this = other;
+	}
+
+	//Assignment operator
+	rebuilt_pe& rebuilt_pe::operator=(const rebuilt_pe& other)
+	{
+		if (this != &other)
+		{
+			headers_ = other.headers_;
+			chunks_ = other.chunks_;
+			size_ = other.size_;
+			end_of_sections_ = other.end_of_sections_;
+
+			//Rebase chunks, which point to headers of other layout
+			const char* other_headers = other.headers_.empty() ? 0 : &other.headers_[0];
+			for (chunk_list::iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+			{
+				if (other_headers && (*it).data >= other_headers && (*it).data < other_headers + other.headers_.size())
+					(*it).data = &headers_[0] + ((*it).data - other_headers);
+			}
+		}
+
+		return *this;
+	}
+
+	//Move constructor
+	rebuilt_pe::rebuilt_pe(rebuilt_pe&& other) noexcept
+		:headers_(std::move(other.headers_)), chunks_(std::move(other.chunks_)), size_(other.size_), end_of_sections_(other.end_of_sections_)
+	{
+		other.size_ = 0;
+		other.end_of_sections_ = 0;
+	}
+
+	//Move assignment operator
+	rebuilt_pe& rebuilt_pe::operator=(rebuilt_pe&& other) noexcept
+	{
+		if (this != &other)
+		{
+			headers_ = std::move(other.headers_);
+			chunks_ = std::move(other.chunks_);
+			size_ = other.size_;
+			end_of_sections_ = other.end_of_sections_;
+			other.chunks_.clear();
+			other.size_ = 0;
+			other.end_of_sections_ = 0;
+		}
+
+		return *this;
+	}
+
+	//Returns exact size of rebuilt image
+	std::size_t rebuilt_pe::get_size() const
+	{
+		return size_;
+	}
+
+	//Returns list of data chunks
+	const rebuilt_pe::chunk_list& rebuilt_pe::get_chunks() const
+	{
+		return chunks_;
+	}
+
+	//Returns file offset of data following the last section
+	uint32_t rebuilt_pe::get_end_of_sections() const
+	{
+		return end_of_sections_;
+	}
+
+	//Writes rebuilt image to contiguous buffer
+	void rebuilt_pe::write_to(char* buffer, std::size_t buffer_size) const
+	{
+		if (buffer_size < size_)
+			throw pe_exception("Buffer is too small for rebuilt image", pe_exception::insufficient_space);
+
+		for (chunk_list::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+		{
+			if ((*it).data)
+				memcpy(buffer, (*it).data, (*it).size);
+			else
+				memset(buffer, 0, (*it).size);
+
+			buffer += (*it).size;
+		}
+	}
+
+	//Zero-filled memory block used to write padding chunks
+	static const char zero_block[0x1000] = {};
+
+	//Writes rebuilt image to ostream
+	void rebuilt_pe::write_to(std::ostream& out) const
+	{
+		for (chunk_list::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+		{
+			if ((*it).data)
+			{
+				out.write((*it).data, (*it).size);
+			}
+			else
+			{
+				for (std::size_t left = (*it).size; left; )
+				{
+					const std::size_t size = std::min(left, sizeof(zero_block));
+					out.write(zero_block, size);
+					left -= size;
+				}
+			}
+		}
+	}
+
+#ifndef PE_BLISS_WINDOWS
+	//Returns list of iovec structures to write rebuilt image with writev or pwritev
+	std::vector<iovec> rebuilt_pe::get_iovecs() const
+	{
+		std::vector<iovec> ret;
+		ret.reserve(chunks_.size());
+
+		for (chunk_list::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it)
+		{
+			iovec vec;
+			if ((*it).data)
+			{
+				vec.iov_base = const_cast<char*>((*it).data);
+				vec.iov_len = (*it).size;
+				ret.push_back(vec);
+			}
+			else
+			{
+				for (std::size_t left = (*it).size; left; )
+				{
+					vec.iov_base = const_cast<char*>(zero_block);
+					vec.iov_len = std::min(left, sizeof(zero_block));
+					ret.push_back(vec);
+					left -= vec.iov_len;
+				}
+			}
+		}
+
+		return ret;
+	}
+#endif
+
+	//Returns headers buffer
+	std::vector<char>& rebuilt_pe::get_headers()
+	{
+		return headers_;
+	}
+
+	//Appends headers buffer as data chunk
+	void rebuilt_pe::add_headers()
+	{
+		if (!headers_.empty())
+			add_data(&headers_[0], headers_.size());
+	}
+
+	//Appends data chunk
+	void rebuilt_pe::add_data(const char* data, std::size_t size)
+	{
+		if (size)
+		{
+			chunk c = { data, size, false, 0 };
+			chunks_.push_back(c);
+			size_ += size;
+		}
+	}
+
+	//Appends data chunk, which is stored unchanged in the file image was read from
+	void rebuilt_pe::add_data(const char* data, std::size_t size, uint32_t source_offset)
+	{
+		if (size)
+		{
+			chunk c = { data, size, true, source_offset };
+			chunks_.push_back(c);
+			size_ += size;
+		}
+	}
+
+	//Appends zero padding chunk up to specified file offset
+	void rebuilt_pe::add_padding(std::size_t offset)
+	{
+		if (offset > size_)
+		{
+			chunk c = { 0, offset - size_, false, 0 };
+			chunks_.push_back(c);
+			size_ = offset;
+		}
+	}
+
+	//Sets file offset of data following the last section
+	void rebuilt_pe::set_end_of_sections(uint32_t offset)
+	{
+		end_of_sections_ = offset;
+	}
+
+	//Copies overlay data of image from the source file to "out" ostream
+	void copy_overlay(std::istream& overlay_source, std::ostream& out, uint32_t offset, uint64_t size)
+	{
+		overlay_source.clear();
+		overlay_source.seekg(offset);
+		if (overlay_source.bad() || overlay_source.fail())
+			throw pe_exception("Cannot reach overlay data", pe_exception::error_reading_overlay);
+
+		//Copy overlay data by chunks
+		char buffer[0x10000];
+		while (size)
+		{
+			std::streamsize chunk = static_cast<std::streamsize>(std::min<uint64_t>(size, sizeof(buffer)));
+			overlay_source.read(buffer, chunk);
+			if (overlay_source.bad() || overlay_source.fail())
+				throw pe_exception("Error reading overlay data", pe_exception::error_reading_overlay);
+
+			out.write(buffer, chunk);
+			size -= chunk;
+		}
+	}
+
+	//Appends data to rebuilt headers buffer
+	void append_headers(std::vector<char>& headers, const void* data, std::size_t size)
+	{
+		headers.insert(headers.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+	}
+
+	//Returns file offset of security directory in rebuilt image, where overlay is placed at "overlay_offset"
+	//Security directory RVA is actually a file offset, it is moved together with overlay, if it is placed inside of it
+	uint32_t get_rebuilt_security_offset(const pe_base& pe, uint32_t overlay_offset)
+	{
+		uint32_t security_offset = pe.get_directory_rva(image_directory_entry_security);
+		if (pe.get_overlay_size() && pe.get_overlay_offset()
+			&& security_offset >= pe.get_overlay_offset()
+			&& security_offset - pe.get_overlay_offset() < pe.get_overlay_size())
+			return security_offset - pe.get_overlay_offset() + overlay_offset;
+
+		return security_offset;
+	}
+
+	//Rebuild PE image and return its layout
 	//If strip_dos_header is true, DOS headers partially will be used for PE headers
 	//If change_size_of_headers == true, SizeOfHeaders will be recalculated automatically
 	//If save_bound_import == true, existing bound import directory will be saved correctly (because some compilers and bind.exe put it to PE headers)
-	void rebuild_pe(pe_base& pe, std::ostream& out, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	//If image holds overlay data, it is placed after the last section
+	//If write_overlay is true, overlay is moved to the end of sections even if it is not held by image (it will be written by caller)
+	rebuilt_pe rebuild_pe_layout(pe_base& pe, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import, bool write_overlay)
 	{
-		if (out.bad())
-			throw pe_exception("Stream is bad", pe_exception::stream_is_bad);
-
 		if (save_bound_import && pe.has_bound_import())
 		{
 			if (pe.section_data_length_from_rva(pe.get_directory_rva(image_directory_entry_bound_import), pe.get_directory_rva(image_directory_entry_bound_import), section_data_raw, true)
@@ -93,10 +352,6 @@ namespace pe_bliss
 				throw pe_exception("Incorrect bound import directory", pe_exception::incorrect_bound_import_directory);
 		}
 
-		//Change ostream state
-		out.exceptions(std::ios::goodbit);
-		out.clear();
-
 		uint32_t original_bound_import_rva = pe.has_bound_import() ? pe.get_directory_rva(image_directory_entry_bound_import) : 0;
 		if (original_bound_import_rva && original_bound_import_rva > pe.get_size_of_headers())
 		{
@@ -106,14 +361,23 @@ namespace pe_bliss
 			save_bound_import = false;
 		}
 
+		const bool hold_overlay = !pe.get_overlay_data().empty();
+		write_overlay = write_overlay || hold_overlay;
+
+		rebuilt_pe ret;
+		std::vector<char>& headers = ret.get_headers();
+
 		{
 			image_dos_header dos_header;
 
 			//Rebuild PE image headers
-			rebuild_pe(pe, dos_header, strip_dos_header, change_size_of_headers, save_bound_import);
+			ret.set_end_of_sections(rebuild_pe(pe, dos_header, strip_dos_header, change_size_of_headers, save_bound_import));
+
+			//Headers size is known exactly (bound import is placed right after section headers)
+			headers.reserve(pe.get_size_of_headers());
 
 			//Write DOS header
-			out.write(reinterpret_cast<const char*>(&dos_header), strip_dos_header ? 8 * sizeof(uint16_t) : sizeof(image_dos_header));
+			append_headers(headers, &dos_header, strip_dos_header ? 8 * sizeof(uint16_t) : sizeof(image_dos_header));
 		}
 
 		//If we have stub overlay, write it too
@@ -121,21 +385,26 @@ namespace pe_bliss
 			const std::string& stub = pe.get_stub_overlay();
 			if (stub.size())
 			{
-				out.write(stub.data(), stub.size());
-				size_t aligned_size = pe_utils::align_up(stub.size(), sizeof(uint32_t));
+				append_headers(headers, stub.data(), stub.size());
 				//Align PE header, which is right after rich overlay
-				while (aligned_size > stub.size())
-				{
-					out.put('\0');
-					--aligned_size;
-				}
+				headers.resize(headers.size() + pe_utils::align_up(stub.size(), sizeof(uint32_t)) - stub.size(), 0);
 			}
 		}
 
 		//Write NT headers
-		out.write(static_cast<const pe_base&>(pe).get_nt_headers_ptr(), pe.get_sizeof_nt_header()
+		std::size_t nt_headers_pos = headers.size();
+		append_headers(headers, static_cast<const pe_base&>(pe).get_nt_headers_ptr(), pe.get_sizeof_nt_header()
 			- sizeof(image_data_directory) * (image_numberof_directory_entries - pe.get_number_of_rvas_and_sizes()));
 
+		//Move security directory together with overlay in rebuilt headers only,
+		//image keeps overlay offset and security directory of the file it was read from
+		if (write_overlay && pe.has_security())
+		{
+			uint32_t security_offset = get_rebuilt_security_offset(pe, ret.get_end_of_sections());
+			memcpy(&headers[nt_headers_pos + pe.get_sizeof_nt_header()
+				- sizeof(image_data_directory) * (image_numberof_directory_entries - image_directory_entry_security)], &security_offset, sizeof(security_offset));
+		}
+
 		//Write section headers
 		const section_list& sections = pe.get_image_sections();
 		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
@@ -144,34 +413,297 @@ namespace pe_bliss
 			{
 				image_section_header header((*it).get_raw_header());
 				header.SizeOfRawData = static_cast<uint32_t>((*it).get_raw_data().length()); //Set non-aligned actual data length for it
-				out.write(reinterpret_cast<const char*>(&header), sizeof(image_section_header));
+				append_headers(headers, &header, sizeof(image_section_header));
 			}
 			else
 			{
-				out.write(reinterpret_cast<const char*>(&(*it).get_raw_header()), sizeof(image_section_header));
+				append_headers(headers, &(*it).get_raw_header(), sizeof(image_section_header));
 			}
 		}
 
 		//Write bound import data if requested
 		if (save_bound_import && pe.has_bound_import())
 		{
-			out.write(pe.section_data_from_rva(original_bound_import_rva, section_data_raw, true),
+			append_headers(headers, pe.section_data_from_rva(original_bound_import_rva, section_data_raw, true),
 				pe.get_directory_size(image_directory_entry_bound_import));
 		}
 
-		//Write section data finally
+		ret.add_headers();
+
+		//Add section data finally
 		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
 		{
 			const section& s = *it;
 
-			std::streamoff wpos = out.tellp();
-
 			//Fill unused overlay data between sections with null bytes
-			for (unsigned int i = 0; i < s.get_pointer_to_raw_data() - wpos; i++)
-				out.put(0);
+			ret.add_padding(s.get_pointer_to_raw_data());
+
+			//Add raw section data
+			if (s.raw_data_unchanged())
+				ret.add_data(s.get_raw_data().data(), s.get_raw_data().length(), s.get_source_offset());
+			else
+				ret.add_data(s.get_raw_data().data(), s.get_raw_data().length());
+		}
+
+		//Add overlay data after the last section
+		if (write_overlay)
+		{
+			ret.add_padding(ret.get_end_of_sections());
+
+			if (hold_overlay)
+				ret.add_data(pe.get_overlay_data().data(), pe.get_overlay_data().size());
+		}
+
+		return ret;
+	}
+
+	//Rebuild PE image and return its layout
+	rebuilt_pe rebuild_pe_layout(pe_base& pe, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	{
+		return rebuild_pe_layout(pe, strip_dos_header, change_size_of_headers, save_bound_import, false);
+	}
+
+	//Rebuild PE image and write it to "out" ostream
+	//Overlay data held by image is written after the last section, otherwise it is copied from overlay_source (if not null)
+	void rebuild_pe_image(pe_base& pe, std::ostream& out, std::istream* overlay_source, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	{
+		if (out.bad())
+			throw pe_exception("Stream is bad", pe_exception::stream_is_bad);
+
+		//Overlay location in the source file
+		const uint32_t original_overlay_offset = pe.get_overlay_offset();
+		const bool copy_source_overlay = overlay_source && pe.has_overlay() && pe.get_overlay_data().empty();
+
+		rebuilt_pe image = rebuild_pe_layout(pe, strip_dos_header, change_size_of_headers, save_bound_import, copy_source_overlay);
+
+		//Change ostream state
+		out.exceptions(std::ios::goodbit);
+		out.clear();
+
+		image.write_to(out);
+
+		//Copy overlay data, which is not held by image, after the last section
+		if (copy_source_overlay)
+			copy_overlay(*overlay_source, out, original_overlay_offset, pe.get_overlay_size());
+	}
+
+	//Rebuild PE image and write it to "out" ostream
+	void rebuild_pe(pe_base& pe, std::ostream& out, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	{
+		rebuild_pe_image(pe, out, 0, strip_dos_header, change_size_of_headers, save_bound_import);
+	}
+
+	//Rebuild PE image and write it to "out" ostream, copying overlay from the source file
+	void rebuild_pe(pe_base& pe, std::ostream& out, std::istream& overlay_source, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	{
+		rebuild_pe_image(pe, out, &overlay_source, strip_dos_header, change_size_of_headers, save_bound_import);
+	}
+
+#ifndef PE_BLISS_WINDOWS
+	//Writes whole data block to file at specified offset
+	void write_file_data(int fd, const char* data, std::size_t size, off_t offset)
+	{
+		while (size)
+		{
+			const ssize_t written = pwrite(fd, data, size, offset);
+			if (written < 0 && errno == EINTR)
+				continue;
+
+			if (written <= 0)
+				throw pe_exception("Error writing file", pe_exception::error_writing_file);
+
+			data += written;
+			size -= written;
+			offset += written;
+		}
+	}
+
+	//Copies data block from source file to output file using userspace buffer
+	void copy_file_data_by_buffer(int source_fd, off_t source_offset, int out_fd, off_t offset, uint64_t size)
+	{
+		char buffer[0x10000];
+		while (size)
+		{
+			const ssize_t read = pread(source_fd, buffer, static_cast<std::size_t>(std::min<uint64_t>(size, sizeof(buffer))), source_offset);
+			if (read < 0 && errno == EINTR)
+				continue;
+
+			if (read <= 0)
+				throw pe_exception("Error reading file", pe_exception::error_reading_file);
+
+			write_file_data(out_fd, buffer, read, offset);
+			source_offset += read;
+			offset += read;
+			size -= read;
+		}
+	}
+
+	//Copies data block from source file to output file
+	//Data is copied inside the kernel if possible (filesystem may also share extents instead of copying)
+	void copy_file_data(int source_fd, off_t source_offset, int out_fd, off_t offset, uint64_t size)
+	{
+#ifdef __linux__
+		while (size)
+		{
+			const ssize_t copied = copy_file_range(source_fd, &source_offset, out_fd, &offset, static_cast<std::size_t>(std::min<uint64_t>(size, 0x40000000)), 0);
+			if (copied < 0 && errno == EINTR)
+				continue;
+
+			if (copied <= 0)
+			{
+				//Kernel or filesystem can't copy the rest of data (or source is shorter than expected, which is reported below)
+				break;
+			}
 
-			//Write raw section data
-			out.write(s.get_raw_data().data(), s.get_raw_data().length());
+			size -= copied;
 		}
+#endif
+
+		copy_file_data_by_buffer(source_fd, source_offset, out_fd, offset, size);
+	}
+
+	//Rebuild PE image and write it to "out_fd" file, copying unchanged data from the source file
+	void rebuild_pe(pe_base& pe, int out_fd, int source_fd, bool strip_dos_header, bool change_size_of_headers, bool save_bound_import)
+	{
+		//Overlay location in the source file
+		const uint32_t original_overlay_offset = pe.get_overlay_offset();
+		const bool copy_source_overlay = pe.has_overlay() && pe.get_overlay_data().empty();
+
+		rebuilt_pe image = rebuild_pe_layout(pe, strip_dos_header, change_size_of_headers, save_bound_import, copy_source_overlay);
+
+		off_t offset = 0;
+		const rebuilt_pe::chunk_list& chunks = image.get_chunks();
+		for (rebuilt_pe::chunk_list::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+		{
+			const rebuilt_pe::chunk& c = *it;
+			if (c.has_source)
+			{
+				copy_file_data(source_fd, c.source_offset, out_fd, offset, c.size);
+			}
+			else if (c.data)
+			{
+				write_file_data(out_fd, c.data, c.size, offset);
+			}
+			else
+			{
+				//Zero padding chunk
+				for (std::size_t done = 0; done < c.size; done += sizeof(zero_block))
+					write_file_data(out_fd, zero_block, std::min(sizeof(zero_block), c.size - done), offset + done);
+			}
+
+			offset += c.size;
+		}
+
+		//Copy overlay data, which is not held by image, after the last section
+		if (copy_source_overlay)
+		{
+			copy_file_data(source_fd, original_overlay_offset, out_fd, offset, pe.get_overlay_size());
+			offset += pe.get_overlay_size();
+		}
+
+		//Cut the rest of output file, if it was longer
+		if (ftruncate(out_fd, offset) != 0)
+			throw pe_exception("Error writing file", pe_exception::error_writing_file);
+	}
+
+	//Sorts and merges changed data ranges, ranges separated with less than max_gap bytes are merged, too
+	section::dirty_range_list merge_dirty_ranges(section::dirty_range_list ranges, uint32_t max_gap)
+	{
+		std::sort(ranges.begin(), ranges.end());
+
+		section::dirty_range_list ret;
+		for (section::dirty_range_list::const_iterator it = ranges.begin(); it != ranges.end(); ++it)
+		{
+			if (!ret.empty() && static_cast<uint64_t>(ret.back().first) + ret.back().second + max_gap >= (*it).first)
+				ret.back().second = std::max(ret.back().first + ret.back().second, (*it).first + (*it).second) - ret.back().first;
+			else
+				ret.push_back(*it);
+		}
+
+		return ret;
+	}
+
+	//Writes changes of image back to file image was read from
+	void commit_inplace(pe_base& pe, int fd)
+	{
+		//Maximum gap between changed bytes to write them with single call
+		static const uint32_t max_gap = 16;
+
+		const std::string& original_headers = pe.get_original_headers_data();
+		if (original_headers.length() < sizeof(image_dos_header) || original_headers.length() != pe.get_full_headers_data().length())
+			throw pe_exception("Image was not read from file", pe_exception::cannot_rebuild_image);
+
+		//Check headers placement
+		const uint32_t nt_headers_offset = reinterpret_cast<const image_dos_header*>(original_headers.data())->e_lfanew;
+		if (static_cast<uint64_t>(nt_headers_offset) + sizeof(uint32_t) + sizeof(image_file_header) > original_headers.length())
+			throw pe_exception("Image layout was changed", pe_exception::cannot_rebuild_image);
+
+		const image_file_header& original_file_header = *reinterpret_cast<const image_file_header*>(&original_headers[nt_headers_offset + sizeof(uint32_t)]);
+		const section_list& sections = pe.get_image_sections();
+		if (static_cast<uint32_t>(pe.get_dos_header().e_lfanew) != nt_headers_offset
+			|| pe.get_size_of_optional_header() != original_file_header.SizeOfOptionalHeader
+			|| pe.get_number_of_sections() != original_file_header.NumberOfSections
+			|| sections.size() != original_file_header.NumberOfSections
+			|| pe.get_stub_overlay().size() != (nt_headers_offset > sizeof(image_dos_header) ? nt_headers_offset - sizeof(image_dos_header) : 0))
+			throw pe_exception("Image layout was changed", pe_exception::cannot_rebuild_image);
+
+		const std::size_t nt_headers_size = pe.get_sizeof_nt_header()
+			- sizeof(image_data_directory) * (image_numberof_directory_entries - pe.get_number_of_rvas_and_sizes());
+		if (nt_headers_size > sizeof(uint32_t) + sizeof(image_file_header) + original_file_header.SizeOfOptionalHeader)
+			throw pe_exception("Image layout was changed", pe_exception::cannot_rebuild_image);
+
+		//Check sections placement
+		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
+		{
+			const section& s = *it;
+			if (!s.has_source()
+				|| pe_utils::align_down(s.get_pointer_to_raw_data(), pe.get_file_alignment()) != s.get_source_offset()
+				|| s.get_raw_data().length() != s.get_source_size())
+				throw pe_exception("Image layout was changed", pe_exception::cannot_rebuild_image);
+		}
+
+		//Place current headers over original headers data
+		//Original headers data holds header fields fixed by parser with fixed values, so they are not written, if they were not changed
+		std::string headers(pe.get_full_headers_data());
+		if (!pe.place_headers(headers, nt_headers_offset, original_file_header.SizeOfOptionalHeader))
+			throw pe_exception("Image layout was changed", pe_exception::cannot_rebuild_image);
+
+		//Write changed header bytes
+		{
+			section::dirty_range_list changed;
+			for (uint32_t i = 0; i != headers.length(); ++i)
+			{
+				if (headers[i] != original_headers[i])
+					changed.push_back(std::make_pair(i, 1u));
+			}
+
+			changed = merge_dirty_ranges(changed, max_gap);
+			for (section::dirty_range_list::const_iterator it = changed.begin(); it != changed.end(); ++it)
+				write_file_data(fd, headers.data() + (*it).first, (*it).second, (*it).first);
+		}
+
+		//Write changed section data
+		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
+		{
+			const section& s = *it;
+			const std::string& raw_data = s.get_raw_data();
+
+			if (s.raw_data_rewritten())
+			{
+				write_file_data(fd, raw_data.data(), raw_data.length(), s.get_source_offset());
+			}
+			else
+			{
+				const section::dirty_range_list changed = merge_dirty_ranges(s.get_dirty_ranges(), max_gap);
+				for (section::dirty_range_list::const_iterator range = changed.begin(); range != changed.end(); ++range)
+					write_file_data(fd, raw_data.data() + (*range).first, (*range).second, static_cast<off_t>(s.get_source_offset()) + (*range).first);
+			}
+		}
+
+		//File is up to date now
+		pe.set_original_headers_data(headers);
+		for (section_list::iterator it = pe.get_image_sections().begin(); it != pe.get_image_sections().end(); ++it)
+			(*it).set_source_offset((*it).get_source_offset());
 	}
+#endif
 }
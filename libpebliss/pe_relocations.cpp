@@ -1,4 +1,10 @@
 #include <string.h>
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <future>
+#include <thread>
 #include "pe_relocations.h"
 #include "pe_properties_generic.h"
 
@@ -81,6 +87,26 @@ namespace pe_bliss
 		:rva_(rva)
 	{}
 
+	//Constructor with allocator
+	relocation_table::relocation_table(const allocator_type& allocator)
+		:rva_(0), relocations_(allocator)
+	{}
+
+	//Constructor from RVA of relocation table with allocator
+	relocation_table::relocation_table(uint32_t rva, const allocator_type& allocator)
+		:rva_(rva), relocations_(allocator)
+	{}
+
+	//Allocator-extended copy constructor
+	relocation_table::relocation_table(const relocation_table& other, const allocator_type& allocator)
+		:rva_(other.rva_), relocations_(other.relocations_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	relocation_table::relocation_table(relocation_table&& other, const allocator_type& allocator)
+		:rva_(other.rva_), relocations_(std::move(other.relocations_), allocator)
+	{}
+
 	//Returns RVA of block
 	uint32_t relocation_table::get_rva() const
 	{
@@ -101,9 +127,9 @@ namespace pe_bliss
 
 	//Get relocation list of pe file, supports one-word sized relocations only
 	//If list_absolute_entries = true, IMAGE_REL_BASED_ABSOLUTE will be listed
-	const relocation_table_list get_relocations(const pe_base& pe, bool list_absolute_entries)
+	relocation_table_list get_relocations(const pe_base& pe, bool list_absolute_entries, std::pmr::memory_resource* resource)
 	{
-		relocation_table_list ret;
+		relocation_table_list ret(resource);
 
 		//If image does not have relocations
 		if (!pe.has_reloc())
@@ -129,13 +155,15 @@ namespace pe_bliss
 		while (reloc_table.SizeOfBlock && read_size < reloc_size)
 		{
 			//Create relocation table
-			relocation_table table;
-			//Save RVA
-			table.set_rva(reloc_table.VirtualAddress);
+			relocation_table table(reloc_table.VirtualAddress, ret.get_allocator());
 
 			if (!pe_utils::is_sum_safe(current_pos, reloc_table.SizeOfBlock))
 				throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
 
+			//Reserve space for all entries of block at once (if block fits into relocation directory)
+			if (reloc_table.SizeOfBlock > sizeof(image_base_relocation) && reloc_table.SizeOfBlock <= reloc_size - read_size)
+				table.get_relocations().reserve((reloc_table.SizeOfBlock - sizeof(image_base_relocation)) / sizeof(uint16_t));
+
 			//List all relocations
 			for (unsigned long i = sizeof(image_base_relocation); i < reloc_table.SizeOfBlock; i += sizeof(uint16_t))
 			{
@@ -145,7 +173,7 @@ namespace pe_bliss
 			}
 
 			//Save table
-			ret.push_back(table);
+			ret.push_back(std::move(table));
 
 			//Go to next relocation block
 			if (!pe_utils::is_sum_safe(current_pos, reloc_table.SizeOfBlock))
@@ -159,13 +187,523 @@ namespace pe_bliss
 		return ret;
 	}
 
+	//PACKED RELOCATIONS
+	//Default constructor
+	packed_relocation_page::iterator::iterator()
+		:item_(0)
+	{}
+
+	//Constructor from raw relocation word
+	packed_relocation_page::iterator::iterator(const uint16_t* item)
+		:item_(item)
+	{}
+
+	//Returns relocation entry decoded from current word
+	relocation_entry packed_relocation_page::iterator::operator*() const
+	{
+		return relocation_entry(*item_);
+	}
+
+	//Goes to next relocation word
+	packed_relocation_page::iterator& packed_relocation_page::iterator::operator++()
+	{
+		++item_;
+		return *this;
+	}
+
+	//Goes to next relocation word
+	packed_relocation_page::iterator packed_relocation_page::iterator::operator++(int)
+	{
+		iterator ret(*this);
+		++item_;
+		return ret;
+	}
+
+	//Compares iterators
+	bool packed_relocation_page::iterator::operator==(const iterator& other) const
+	{
+		return item_ == other.item_;
+	}
+
+	//Compares iterators
+	bool packed_relocation_page::iterator::operator!=(const iterator& other) const
+	{
+		return item_ != other.item_;
+	}
+
+	//Default constructor (empty page)
+	packed_relocation_page::packed_relocation_page()
+		:rva_(0), items_(0), count_(0)
+	{}
+
+	//Constructor from RVA of page and its raw relocation words
+	packed_relocation_page::packed_relocation_page(uint32_t rva, const uint16_t* items, std::size_t count)
+		:rva_(rva), items_(items), count_(count)
+	{}
+
+	//Returns RVA of page
+	uint32_t packed_relocation_page::get_rva() const
+	{
+		return rva_;
+	}
+
+	//Returns number of relocation words (including IMAGE_REL_BASED_ABSOLUTE ones)
+	std::size_t packed_relocation_page::size() const
+	{
+		return count_;
+	}
+
+	//Returns true if page has no relocation words
+	bool packed_relocation_page::empty() const
+	{
+		return count_ == 0;
+	}
+
+	//Returns relocation entry by index
+	relocation_entry packed_relocation_page::operator[](std::size_t index) const
+	{
+		return relocation_entry(items_[index]);
+	}
+
+	//Returns raw relocation words (type | offset)
+	const uint16_t* packed_relocation_page::get_items() const
+	{
+		return items_;
+	}
+
+	//Returns iterator to the first relocation entry
+	packed_relocation_page::iterator packed_relocation_page::begin() const
+	{
+		return iterator(items_);
+	}
+
+	//Returns iterator past the last relocation entry
+	packed_relocation_page::iterator packed_relocation_page::end() const
+	{
+		return iterator(items_ + count_);
+	}
+
+	//Default constructor
+	packed_relocations::packed_relocations()
+	{}
+
+	//Constructor with allocator
+	packed_relocations::packed_relocations(const allocator_type& allocator)
+		:items_(allocator), pages_(allocator)
+	{}
+
+	//Constructor from relocation tables
+	packed_relocations::packed_relocations(const relocation_table_list& tables, const allocator_type& allocator)
+		:items_(allocator), pages_(allocator)
+	{
+		std::size_t item_count = 0;
+		for (relocation_table_list::const_iterator it = tables.begin(); it != tables.end(); ++it)
+			item_count += (*it).get_relocations().size();
+
+		items_.reserve(item_count);
+		pages_.reserve(tables.size());
+
+		for (relocation_table_list::const_iterator it = tables.begin(); it != tables.end(); ++it)
+		{
+			page_info page = { (*it).get_rva(), static_cast<uint32_t>(items_.size()) };
+			pages_.push_back(page);
+
+			const relocation_table::relocation_list& relocs = (*it).get_relocations();
+			for (relocation_table::relocation_list::const_iterator rel = relocs.begin(); rel != relocs.end(); ++rel)
+				items_.push_back((*rel).get_item());
+		}
+	}
+
+	//Returns number of pages (relocation tables)
+	std::size_t packed_relocations::get_page_count() const
+	{
+		return pages_.size();
+	}
+
+	//Returns page by index
+	packed_relocation_page packed_relocations::get_page(std::size_t index) const
+	{
+		std::size_t first = pages_.at(index).first_item;
+		std::size_t last = index + 1 == pages_.size() ? items_.size() : pages_[index + 1].first_item;
+		return packed_relocation_page(pages_[index].rva, items_.data() + first, last - first);
+	}
+
+	//Returns total number of relocation words (including IMAGE_REL_BASED_ABSOLUTE ones)
+	std::size_t packed_relocations::get_item_count() const
+	{
+		return items_.size();
+	}
+
+	//Converts packed relocations to relocation tables
+	relocation_table_list packed_relocations::to_relocation_tables(bool list_absolute_entries, std::pmr::memory_resource* resource) const
+	{
+		relocation_table_list ret(resource);
+		ret.reserve(pages_.size());
+
+		for (std::size_t i = 0; i != pages_.size(); ++i)
+		{
+			packed_relocation_page page = get_page(i);
+
+			relocation_table table(page.get_rva(), ret.get_allocator());
+			relocation_table::relocation_list& relocs = table.get_relocations();
+			relocs.reserve(page.size());
+			for (std::size_t j = 0; j != page.size(); ++j)
+			{
+				relocation_entry entry(page.get_items()[j]);
+				if (list_absolute_entries || entry.get_type() != image_rel_based_absolute)
+					relocs.push_back(entry);
+			}
+
+			ret.push_back(std::move(table));
+		}
+
+		return ret;
+	}
+
+	//Adds page with raw relocation words
+	void packed_relocations::add_page(uint32_t rva, const uint16_t* items, std::size_t count)
+	{
+		page_info page = { rva, static_cast<uint32_t>(items_.size()) };
+		pages_.push_back(page);
+		add_items(items, count);
+	}
+
+	//Adds raw relocation words to the last page
+	void packed_relocations::add_items(const uint16_t* items, std::size_t count)
+	{
+		items_.insert(items_.end(), items, items + count);
+	}
+
+	//Reserves space for relocation words
+	void packed_relocations::reserve_items(std::size_t count)
+	{
+		items_.reserve(count);
+	}
+
+	//Get relocations of pe file in packed form
+	packed_relocations get_packed_relocations(const pe_base& pe, std::pmr::memory_resource* resource)
+	{
+		packed_relocations ret(resource);
+
+		//If image does not have relocations
+		if (!pe.has_reloc())
+			return ret;
+
+		uint32_t directory_rva = pe.get_directory_rva(image_directory_entry_basereloc);
+
+		//Check the length in bytes of the section containing relocation directory
+		uint32_t directory_data_length = pe.section_data_length_from_rva(directory_rva, directory_rva, section_data_virtual, true);
+		if (directory_data_length < sizeof(image_base_relocation))
+			throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+		unsigned long current_pos = directory_rva;
+		//First IMAGE_BASE_RELOCATION table
+		image_base_relocation reloc_table = pe.section_data_from_rva<image_base_relocation>(current_pos, section_data_virtual, true);
+
+		if (reloc_table.SizeOfBlock % 2)
+			throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+		unsigned long reloc_size = pe.get_directory_size(image_directory_entry_basereloc);
+		unsigned long read_size = 0;
+
+		//All words fit into relocation directory, which fits into its section (directory size may be incorrect)
+		ret.reserve_items(std::min<unsigned long>(reloc_size, directory_data_length) / sizeof(uint16_t));
+
+		//Words inside headers are read one by one, like get_relocations does it
+		std::size_t headers_length = pe.get_full_headers_data().length();
+
+		//reloc_table.VirtualAddress is not checked (not so important)
+		while (reloc_table.SizeOfBlock && read_size < reloc_size)
+		{
+			if (!pe_utils::is_sum_safe(current_pos, reloc_table.SizeOfBlock))
+				throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+			ret.add_page(reloc_table.VirtualAddress, 0, 0);
+
+			//Copy words of table, as many of them at once, as section data contains
+			for (unsigned long i = sizeof(image_base_relocation); i < reloc_table.SizeOfBlock;)
+			{
+				uint32_t rva = static_cast<uint32_t>(current_pos + i);
+				std::size_t count = 0;
+				if (static_cast<uint64_t>(rva) + sizeof(uint16_t) >= headers_length)
+				{
+					const section& s = pe.section_from_rva(rva);
+					//Words after raw data (zeros of virtual data) are read one by one below
+					const std::string& data = s.get_raw_data();
+					//Don't check for underflow here, comparsion is unsigned
+					if (data.size() >= rva - s.get_virtual_address() + sizeof(uint16_t))
+					{
+						count = std::min<std::size_t>((reloc_table.SizeOfBlock - i + 1) / sizeof(uint16_t),
+							(data.size() - (rva - s.get_virtual_address())) / sizeof(uint16_t));
+
+						ret.add_items(reinterpret_cast<const uint16_t*>(data.data() + (rva - s.get_virtual_address())), count);
+					}
+				}
+
+				if (!count)
+				{
+					//Single word (checks bounds and throws, if word is not inside image)
+					uint16_t item = pe.section_data_from_rva<uint16_t>(rva, section_data_virtual, true);
+					ret.add_items(&item, 1);
+					count = 1;
+				}
+
+				i += static_cast<unsigned long>(count * sizeof(uint16_t));
+			}
+
+			//Go to next relocation block
+			current_pos += reloc_table.SizeOfBlock;
+			read_size += reloc_table.SizeOfBlock;
+			reloc_table = pe.section_data_from_rva<image_base_relocation>(current_pos, section_data_virtual, true);
+		}
+
+		return ret;
+	}
+
+	//RELOCATION COVERAGE
+	//Number of words in block of rank index
+	const uint32_t rank_block_words = 8;
+
+	//Builds rank index
+	void relocation_coverage::rank_bitmap::build_ranks()
+	{
+		//The last element is total number of set bits
+		ranks.resize((words.size() + rank_block_words - 1) / rank_block_words + 1);
+		uint32_t count = 0;
+		for (std::size_t i = 0; i != words.size(); ++i)
+		{
+			if (i % rank_block_words == 0)
+				ranks[i / rank_block_words] = count;
+
+			count += std::popcount(words[i]);
+		}
+
+		ranks.back() = count;
+	}
+
+	//Returns number of set bits before bit
+	std::size_t relocation_coverage::rank_bitmap::rank(uint32_t bit) const
+	{
+		std::size_t word = bit / 64;
+		std::size_t ret = ranks[word / rank_block_words];
+		for (std::size_t i = word - word % rank_block_words; i != word; ++i)
+			ret += std::popcount(words[i]);
+
+		if (bit % 64)
+			ret += std::popcount(words[word] & ((1ull << (bit % 64)) - 1));
+
+		return ret;
+	}
+
+	//Returns bit value
+	bool relocation_coverage::rank_bitmap::test(uint32_t bit) const
+	{
+		return (words[bit / 64] >> (bit % 64)) & 1;
+	}
+
+	//Default constructor (empty image)
+	relocation_coverage::relocation_coverage()
+		:image_size_(0)
+	{
+		starts_.build_ranks();
+		covered_.build_ranks();
+	}
+
+	//Constructor from image
+	relocation_coverage::relocation_coverage(const pe_base& pe)
+		:relocation_coverage(get_packed_relocations(pe), pe.get_size_of_image())
+	{}
+
+	//Constructor from relocations and image size
+	relocation_coverage::relocation_coverage(const packed_relocations& relocs, uint32_t image_size)
+		:image_size_(image_size)
+	{
+		//One extra word, so rank of the image end is always inside bitmap
+		std::size_t word_count = image_size / 64 + 1;
+		starts_.words.resize(word_count);
+		covered_.words.resize(word_count);
+
+		for (std::size_t i = 0; i != relocs.get_page_count(); ++i)
+		{
+			packed_relocation_page page = relocs.get_page(i);
+			for (std::size_t j = 0; j < page.size(); ++j)
+			{
+				relocation_entry entry(page.get_items()[j]);
+				uint32_t size;
+				switch (entry.get_type())
+				{
+				case image_rel_based_absolute:
+					continue;
+
+				case image_rel_based_high:
+				case image_rel_based_low:
+					size = sizeof(uint16_t);
+					break;
+
+				case image_rel_based_highadj:
+					//Next word is parameter of relocation
+					size = sizeof(uint16_t);
+					++j;
+					break;
+
+				case image_rel_based_dir64:
+					size = sizeof(uint64_t);
+					break;
+
+				default:
+					size = sizeof(uint32_t);
+					break;
+				}
+
+				uint64_t rva = static_cast<uint64_t>(page.get_rva()) + entry.get_rva();
+				if (rva + size <= image_size)
+					add_relocation(static_cast<uint32_t>(rva), size);
+			}
+		}
+
+		starts_.build_ranks();
+		covered_.build_ranks();
+	}
+
+	//Marks relocated value
+	void relocation_coverage::add_relocation(uint32_t rva, uint32_t size)
+	{
+		starts_.words[rva / 64] |= 1ull << (rva % 64);
+		for (uint32_t i = rva; i != rva + size; ++i)
+			covered_.words[i / 64] |= 1ull << (i % 64);
+	}
+
+	//Returns number of set bits in range of bitmap
+	std::size_t relocation_coverage::count_bits(const rank_bitmap& bitmap, uint32_t rva, uint32_t size) const
+	{
+		if (rva >= image_size_)
+			return 0;
+
+		uint32_t end = size > image_size_ - rva ? image_size_ : rva + size;
+		return bitmap.rank(end) - bitmap.rank(rva);
+	}
+
+	//Returns size of covered RVA space
+	uint32_t relocation_coverage::get_image_size() const
+	{
+		return image_size_;
+	}
+
+	//Returns number of relocated values
+	std::size_t relocation_coverage::get_relocation_count() const
+	{
+		return starts_.ranks.back();
+	}
+
+	//Returns true if relocated value starts at RVA
+	bool relocation_coverage::is_relocation_start(uint32_t rva) const
+	{
+		return rva < image_size_ && starts_.test(rva);
+	}
+
+	//Returns true if byte at RVA belongs to relocated value
+	bool relocation_coverage::is_relocated(uint32_t rva) const
+	{
+		return rva < image_size_ && covered_.test(rva);
+	}
+
+	//Returns true if any byte of range belongs to relocated value
+	bool relocation_coverage::intersects(uint32_t rva, uint32_t size) const
+	{
+		return count_bits(covered_, rva, size) != 0;
+	}
+
+	//Returns number of relocated values starting inside range
+	std::size_t relocation_coverage::count_relocations(uint32_t rva, uint32_t size) const
+	{
+		return count_bits(starts_, rva, size);
+	}
+
+	//Returns position of the first bit with value "set" of covered bytes bitmap inside [rva, end_rva) or end_rva
+	uint32_t relocation_coverage::find_covered_bit(uint32_t rva, uint32_t end_rva, bool set) const
+	{
+		if (rva >= end_rva)
+			return end_rva;
+
+		//Bytes outside of image are not relocated
+		if (rva >= image_size_)
+			return set ? end_rva : rva;
+
+		uint32_t end = std::min(end_rva, image_size_);
+
+		//Whole words are scanned, bits before range are masked in the first one
+		for (uint32_t word_index = rva / 64; word_index <= (end - 1) / 64; ++word_index)
+		{
+			uint64_t word = set ? covered_.words[word_index] : ~covered_.words[word_index];
+			if (word_index == rva / 64)
+				word &= ~0ull << (rva % 64);
+
+			if (word)
+			{
+				uint32_t pos = word_index * 64 + static_cast<uint32_t>(std::countr_zero(word));
+				if (pos < end)
+					return pos;
+
+				break;
+			}
+		}
+
+		//If range ends after image end, the first byte after image is not relocated
+		return set ? end_rva : end;
+	}
+
+	//Returns RVA of the first relocated byte inside [rva, end_rva) or end_rva, if there's no such byte
+	uint32_t relocation_coverage::find_relocated(uint32_t rva, uint32_t end_rva) const
+	{
+		return find_covered_bit(rva, end_rva, true);
+	}
+
+	//Returns RVA of the first not relocated byte inside [rva, end_rva) or end_rva, if there's no such byte
+	uint32_t relocation_coverage::find_not_relocated(uint32_t rva, uint32_t end_rva) const
+	{
+		return find_covered_bit(rva, end_rva, false);
+	}
+
+	//Appends RVAs of relocated values starting inside range to "rvas"
+	void relocation_coverage::get_relocation_rvas(uint32_t rva, uint32_t size, std::vector<uint32_t>& rvas) const
+	{
+		if (rva >= image_size_)
+			return;
+
+		uint32_t end = size > image_size_ - rva ? image_size_ : rva + size;
+		if (end == rva)
+			return;
+
+		//Whole words are scanned, bits outside of range are masked in the first and the last ones
+		for (uint32_t word_index = rva / 64; word_index <= (end - 1) / 64; ++word_index)
+		{
+			uint64_t word = starts_.words[word_index];
+			if (word_index == rva / 64)
+				word &= ~0ull << (rva % 64);
+			if (word_index == (end - 1) / 64 && end % 64)
+				word &= (1ull << (end % 64)) - 1;
+
+			while (word)
+			{
+				rvas.push_back(word_index * 64 + std::countr_zero(word));
+				word &= word - 1;
+			}
+		}
+	}
+
+	//Appends RVAs of relocated values starting inside section "s" to "rvas"
+	void relocation_coverage::get_relocation_rvas(const section& s, uint32_t section_alignment, std::vector<uint32_t>& rvas) const
+	{
+		get_relocation_rvas(s.get_virtual_address(), s.get_aligned_virtual_size(section_alignment), rvas);
+	}
+
 	//Simple relocations rebuilder
 	//To keep PE file working, don't remove any of existing relocations in
 	//relocation_table_list returned by a call to get_relocations() function
 	//auto_strip_last_section - if true and relocations are placed in the last section, it will be automatically stripped
 	//offset_from_section_start - offset from the beginning of reloc_section, where relocations data will be situated
 	//If save_to_pe_header is true, PE header will be modified automatically
-	const image_directory rebuild_relocations(pe_base& pe, const relocation_table_list& relocs, section& reloc_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_relocations(pe_base& pe, const relocation_table_list& relocs, section& reloc_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		//Check that reloc_section is attached to this PE image
 		if (!pe.section_attached(reloc_section))
@@ -246,24 +784,329 @@ namespace pe_bliss
 		return ret;
 	}
 
-	//Recalculates image base with the help of relocation tables
-	void rebase_image(pe_base& pe, const relocation_table_list& tables, uint64_t new_base)
+	//INCREMENTAL RELOCATIONS EDITING
+	//Helper: relocation block of directory
+	struct relocation_block_ref
 	{
-		pe.get_pe_type() == pe_type_32
-			? rebase_image_base<pe_types_class_32>(pe, tables, new_base)
-			: rebase_image_base<pe_types_class_64>(pe, tables, new_base);
-	}
+		uint32_t rva; //RVA of block header
+		uint32_t size; //Size of block
+	};
 
-	//RELOCATIONS
-	//Recalculates image base with the help of relocation tables
-	//Recalculates VAs of DWORDS/QWORDS in image according to relocations
-	//Notice: if you move some critical structures like TLS, image relocations will not fix new
-	//positions of TLS VAs. Instead, some bytes that now doesn't belong to TLS will be fixed.
-	//It is recommended to rebase image in the very beginning and move all structures afterwards.
-	template<typename PEClassType>
-	void rebase_image_base(pe_base& pe, const relocation_table_list& tables, uint64_t new_base)
+	//Helper: walks relocation directory blocks like get_relocations does it, collects blocks of page
+	//Returns RVA of directory end (position after the last block)
+	uint32_t find_relocation_page_blocks(const pe_base& pe, uint32_t page_rva, std::vector<relocation_block_ref>& blocks)
 	{
-		//Get current image base value
+		uint32_t current_pos = pe.get_directory_rva(image_directory_entry_basereloc);
+
+		//Check the length in bytes of the section containing relocation directory
+		if (pe.section_data_length_from_rva(current_pos, current_pos, section_data_virtual, true) < sizeof(image_base_relocation))
+			throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+		image_base_relocation reloc_table = pe.section_data_from_rva<image_base_relocation>(current_pos, section_data_virtual, true);
+		if (reloc_table.SizeOfBlock % 2)
+			throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+		uint32_t reloc_size = pe.get_directory_size(image_directory_entry_basereloc);
+		uint32_t read_size = 0;
+		while (reloc_table.SizeOfBlock && read_size < reloc_size)
+		{
+			if (!pe_utils::is_sum_safe(current_pos, reloc_table.SizeOfBlock))
+				throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+			if (reloc_table.VirtualAddress == page_rva)
+			{
+				relocation_block_ref block = { current_pos, reloc_table.SizeOfBlock };
+				blocks.push_back(block);
+			}
+
+			current_pos += reloc_table.SizeOfBlock;
+			read_size += reloc_table.SizeOfBlock;
+			reloc_table = pe.section_data_from_rva<image_base_relocation>(current_pos, section_data_virtual, true);
+		}
+
+		return current_pos;
+	}
+
+	//Helper: reads relocation words of block
+	void read_relocation_block_words(const pe_base& pe, const relocation_block_ref& block, std::vector<uint16_t>& words)
+	{
+		words.clear();
+		for (uint32_t i = sizeof(image_base_relocation); i < block.size; i += sizeof(uint16_t))
+			words.push_back(pe.section_data_from_rva<uint16_t>(block.rva + i, section_data_virtual, true));
+	}
+
+	//Helper: returns index of relocation entry at page offset or words.size(), if there's no such entry
+	//Parameters of HIGHADJ relocations are skipped
+	std::size_t find_relocation_word(const std::vector<uint16_t>& words, uint16_t offset)
+	{
+		for (std::size_t i = 0; i < words.size(); ++i)
+		{
+			relocation_entry entry(words[i]);
+			if (entry.get_type() != image_rel_based_absolute && entry.get_rva() == offset)
+				return i;
+
+			if (entry.get_type() == image_rel_based_highadj)
+				++i;
+		}
+
+		return words.size();
+	}
+
+	//Helper: returns index of the first of "count" contiguous free (ABSOLUTE) entries or words.size(), if there're no such entries
+	//Parameters of HIGHADJ relocations are skipped
+	std::size_t find_free_relocation_words(const std::vector<uint16_t>& words, std::size_t count)
+	{
+		std::size_t free_count = 0;
+		for (std::size_t i = 0; i < words.size(); ++i)
+		{
+			relocation_entry entry(words[i]);
+			if (entry.get_type() == image_rel_based_absolute)
+			{
+				if (++free_count == count)
+					return i + 1 - count;
+			}
+			else
+			{
+				free_count = 0;
+				if (entry.get_type() == image_rel_based_highadj)
+					++i;
+			}
+		}
+
+		return words.size();
+	}
+
+	//Adds relocation to relocation directory of image, changing only the block of relocation page, if possible
+	//Helper: clears "count" relocation words of block starting from "index", replacing them with IMAGE_REL_BASED_ABSOLUTE entries
+	void clear_relocation_words(pe_base& pe, const relocation_block_ref& block, std::size_t index, uint32_t count)
+	{
+		uint16_t absolute_words[2] = { 0, 0 };
+		pe.patch_section_data(static_cast<uint32_t>(block.rva + sizeof(image_base_relocation) + index * sizeof(uint16_t)),
+			reinterpret_cast<const char*>(absolute_words), count * sizeof(uint16_t));
+	}
+
+	//Helper: returns true if section data from "start" to "end" (offsets from section start) may be overwritten by relocation directory
+	//Data must be zero-filled and must not be used by section: it is either inside of declared directory
+	//(which ends at "directory_end") or after section virtual size. Data after the end of section raw data is not checked
+	bool is_free_relocation_space(const section& s, uint64_t start, uint64_t end, uint64_t directory_end)
+	{
+		if (start >= end)
+			return true;
+
+		return (end <= directory_end || std::max(start, directory_end) >= s.get_virtual_size())
+			&& s.get_raw_data().find_first_not_of('\0', static_cast<std::string::size_type>(start)) >= end;
+	}
+
+	bool add_relocation(pe_base& pe, uint32_t rva, uint16_t type, uint16_t param)
+	{
+		if (!pe.has_reloc())
+			throw pe_exception("Image does not have relocation directory", pe_exception::directory_does_not_exist);
+
+		if (type == image_rel_based_absolute || type > 0xf)
+			throw pe_exception("Incorrect relocation type", pe_exception::incorrect_relocation_directory);
+
+		uint32_t page_rva = rva & ~0xfffu;
+		uint16_t offset = static_cast<uint16_t>(rva & 0xfff);
+
+		//New entries: relocation and HIGHADJ parameter
+		uint16_t new_words[2] = { relocation_entry(offset, type).get_item(), param };
+		uint32_t new_word_count = type == image_rel_based_highadj ? 2 : 1;
+
+		std::vector<relocation_block_ref> blocks;
+		uint32_t directory_end = find_relocation_page_blocks(pe, page_rva, blocks);
+
+		//Check if relocation at this offset exists already
+		//Relocation of other type is replaced in place, if it takes the same number of entries,
+		//otherwise it is cleared when new entries are written
+		std::vector<uint16_t> words;
+		std::size_t existing_block = blocks.size(), existing_index = 0;
+		uint32_t existing_count = 0;
+		for (std::size_t i = 0; i != blocks.size(); ++i)
+		{
+			read_relocation_block_words(pe, blocks[i], words);
+			std::size_t index = find_relocation_word(words, offset);
+			if (index != words.size())
+			{
+				existing_count = relocation_entry(words[index]).get_type() == image_rel_based_highadj && index + 1 < words.size() ? 2 : 1;
+				if (existing_count == new_word_count)
+				{
+					if (!std::equal(new_words, new_words + new_word_count, words.begin() + index))
+						pe.patch_section_data(static_cast<uint32_t>(blocks[i].rva + sizeof(image_base_relocation) + index * sizeof(uint16_t)),
+							reinterpret_cast<const char*>(new_words), new_word_count * sizeof(uint16_t));
+
+					return true;
+				}
+
+				existing_block = i;
+				existing_index = index;
+				break;
+			}
+		}
+
+		//Check if free entries can be reused (including entries of replaced relocation)
+		for (std::size_t i = 0; i != blocks.size(); ++i)
+		{
+			read_relocation_block_words(pe, blocks[i], words);
+			if (i == existing_block)
+				std::fill_n(words.begin() + existing_index, existing_count, static_cast<uint16_t>(0));
+
+			std::size_t index = find_free_relocation_words(words, new_word_count);
+			if (index != words.size())
+			{
+				if (existing_block != blocks.size())
+					clear_relocation_words(pe, blocks[existing_block], existing_index, existing_count);
+
+				pe.patch_section_data(static_cast<uint32_t>(blocks[i].rva + sizeof(image_base_relocation) + index * sizeof(uint16_t)),
+					reinterpret_cast<const char*>(new_words), new_word_count * sizeof(uint16_t));
+				return true;
+			}
+		}
+
+		uint32_t directory_rva = pe.get_directory_rva(image_directory_entry_basereloc);
+		section& reloc_section = pe.section_from_rva(directory_rva);
+
+		//Grow the first block of page (blocks are kept DWORD-aligned), or add new block to the end of directory
+		uint32_t needed_size = pe_utils::align_up(new_word_count * sizeof(uint16_t) + (blocks.empty() ? sizeof(image_base_relocation) : 0), sizeof(uint32_t));
+
+		//Space after directory must be free (see is_free_relocation_space), be inside of section raw data
+		//and aligned virtual size (with the following block header, which is read by get_relocations)
+		const std::string& raw_data = static_cast<const section&>(reloc_section).get_raw_data();
+		uint64_t extension_start = directory_end - reloc_section.get_virtual_address();
+		uint64_t extension_end = extension_start + needed_size;
+		uint64_t declared_end = static_cast<uint64_t>(directory_rva) + pe.get_directory_size(image_directory_entry_basereloc) - reloc_section.get_virtual_address();
+		if (extension_end <= raw_data.length()
+			&& extension_end + sizeof(image_base_relocation) <= reloc_section.get_aligned_virtual_size(pe.get_section_alignment())
+			&& is_free_relocation_space(reloc_section, extension_start, extension_end, declared_end))
+		{
+			if (existing_block != blocks.size())
+				clear_relocation_words(pe, blocks[existing_block], existing_index, existing_count);
+
+			std::string data(needed_size, '\0');
+			if (blocks.empty())
+			{
+				image_base_relocation header = { page_rva, needed_size };
+				memcpy(&data[0], &header, sizeof(header));
+				memcpy(&data[sizeof(header)], new_words, new_word_count * sizeof(uint16_t));
+				pe.patch_section_data(directory_end, data.data(), needed_size);
+			}
+			else
+			{
+				//Move the rest of directory and place new entries to the end of block
+				uint32_t block_end = blocks[0].rva + blocks[0].size;
+				std::string tail(pe.section_data_from_rva(block_end, section_data_raw, true), directory_end - block_end);
+				memcpy(&data[0], new_words, new_word_count * sizeof(uint16_t));
+				data += tail;
+				pe.patch_section_data(block_end, data.data(), static_cast<uint32_t>(data.length()));
+
+				uint32_t block_size = blocks[0].size + needed_size;
+				pe.patch_section_data(blocks[0].rva + offsetof(image_base_relocation, SizeOfBlock), reinterpret_cast<const char*>(&block_size), sizeof(block_size));
+			}
+
+			pe.set_directory_size(image_directory_entry_basereloc, std::max<uint32_t>(pe.get_directory_size(image_directory_entry_basereloc), directory_end + needed_size - directory_rva));
+
+			//Cover new data with section virtual size, aligned virtual size is not changed
+			if (reloc_section.get_virtual_size() < extension_end)
+			{
+				if (&reloc_section == &pe.get_image_sections().back())
+					pe.set_section_virtual_size(reloc_section, static_cast<uint32_t>(extension_end));
+				else
+					reloc_section.set_virtual_size(static_cast<uint32_t>(extension_end));
+			}
+
+			return true;
+		}
+
+		//No space, rebuild the whole directory at its place
+		//All absolute entries are listed, so entries of tables match words of blocks
+		relocation_table_list tables(get_relocations(pe, true));
+		relocation_table_list::iterator table = tables.end();
+		std::size_t page_block = 0;
+		for (relocation_table_list::iterator it = tables.begin(); it != tables.end(); ++it)
+		{
+			if ((*it).get_rva() != page_rva)
+				continue;
+
+			if (table == tables.end())
+				table = it;
+
+			if (page_block++ == existing_block)
+			{
+				for (uint32_t i = 0; i != existing_count; ++i)
+					(*it).get_relocations()[existing_index + i].set_item(0);
+			}
+		}
+
+		if (table == tables.end())
+			table = tables.insert(tables.end(), relocation_table(page_rva, tables.get_allocator()));
+
+		for (uint32_t i = 0; i != new_word_count; ++i)
+			(*table).add_relocation(relocation_entry(new_words[i]));
+
+		//Rebuilt directory must not overwrite section data following the directory: its grown part must be free
+		//and must fit into the section. Otherwise, if the section is the last one, the directory is rebuilt after all section data
+		uint32_t rebuild_start = pe_utils::align_up(directory_rva - reloc_section.get_virtual_address(), sizeof(uint32_t));
+		uint64_t rebuild_end = rebuild_start;
+		for (relocation_table_list::const_iterator it = tables.begin(); it != tables.end(); ++it)
+			rebuild_end += sizeof(image_base_relocation) + pe_utils::align_up(static_cast<uint32_t>((*it).get_relocations().size() * sizeof(uint16_t)), sizeof(uint32_t));
+
+		uint64_t directory_extent_end = std::max(extension_start, declared_end);
+		if (rebuild_end > raw_data.length()
+			|| rebuild_end > reloc_section.get_aligned_virtual_size(pe.get_section_alignment())
+			|| !is_free_relocation_space(reloc_section, directory_extent_end, rebuild_end, declared_end))
+		{
+			if (&reloc_section != &pe.get_image_sections().back())
+				throw pe_exception("Insufficient space for relocations directory", pe_exception::insufficient_space);
+
+			rebuild_start = static_cast<uint32_t>(std::max<uint64_t>(std::max<uint64_t>(raw_data.length(), reloc_section.get_virtual_size()), directory_extent_end));
+		}
+
+		rebuild_relocations(pe, tables, reloc_section, rebuild_start, true, false);
+		return false;
+	}
+
+	//Removes relocation from relocation directory of image
+	bool remove_relocation(pe_base& pe, uint32_t rva)
+	{
+		if (!pe.has_reloc())
+			return false;
+
+		std::vector<relocation_block_ref> blocks;
+		find_relocation_page_blocks(pe, rva & ~0xfffu, blocks);
+
+		std::vector<uint16_t> words;
+		for (std::vector<relocation_block_ref>::const_iterator it = blocks.begin(); it != blocks.end(); ++it)
+		{
+			read_relocation_block_words(pe, *it, words);
+			std::size_t index = find_relocation_word(words, static_cast<uint16_t>(rva & 0xfff));
+			if (index != words.size())
+			{
+				//HIGHADJ parameter is cleared too
+				clear_relocation_words(pe, *it, index, relocation_entry(words[index]).get_type() == image_rel_based_highadj && index + 1 < words.size() ? 2 : 1);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//Recalculates image base with the help of relocation tables
+	void rebase_image(pe_base& pe, const relocation_table_list& tables, uint64_t new_base)
+	{
+		pe.get_pe_type() == pe_type_32
+			? rebase_image_base<pe_types_class_32>(pe, tables, new_base)
+			: rebase_image_base<pe_types_class_64>(pe, tables, new_base);
+	}
+
+	//RELOCATIONS
+	//Recalculates image base with the help of relocation tables
+	//Recalculates VAs of DWORDS/QWORDS in image according to relocations
+	//Notice: if you move some critical structures like TLS, image relocations will not fix new
+	//positions of TLS VAs. Instead, some bytes that now doesn't belong to TLS will be fixed.
+	//It is recommended to rebase image in the very beginning and move all structures afterwards.
+	template<typename PEClassType>
+	void rebase_image_base(pe_base& pe, const relocation_table_list& tables, uint64_t new_base)
+	{
+		//Get current image base value
 		typename PEClassType::BaseSize image_base;
 		pe.get_image_base(image_base);
 
@@ -289,11 +1132,501 @@ namespace pe_bliss
 				uint32_t current_rva = base_rva + (*rel).get_rva();
 				typename PEClassType::BaseSize value = pe.section_data_from_rva<typename PEClassType::BaseSize>(current_rva, section_data_raw, true);
 				value += base_rel;
-				memcpy(pe.section_data_from_rva(current_rva, true), &value, sizeof(value));
+				pe.patch_section_data(current_rva, reinterpret_cast<const char*>(&value), sizeof(value), true);
+			}
+		}
+
+		//Finally, save new image base
+		pe.set_image_base_64(new_base);
+	}
+
+	//Helper: part of image (section or headers) patched by rebase_image_fast
+	struct rebase_region
+	{
+		uint32_t rva;
+		uint32_t virtual_size; //Aligned virtual size of section
+		char* data; //Raw data, zero if region is not relocated or has no raw data
+		uint32_t raw_size;
+	};
+
+	typedef std::vector<rebase_region> rebase_region_list;
+
+	//Helper: compares RVA with rebase regions start RVAs
+	struct rebase_region_sorter
+	{
+		bool operator()(uint32_t rva, const rebase_region& region) const
+		{
+			return rva < region.rva;
+		}
+	};
+
+	//Helper: returns index of region containing RVA or regions.size(), if there's no such region
+	std::size_t find_rebase_region(const rebase_region_list& regions, uint32_t rva)
+	{
+		rebase_region_list::const_iterator it = std::upper_bound(regions.begin(), regions.end(), rva, rebase_region_sorter());
+		if (it == regions.begin())
+			return regions.size();
+
+		--it;
+		return rva - (*it).rva < (*it).virtual_size ? static_cast<std::size_t>(it - regions.begin()) : regions.size();
+	}
+
+	//Helper: returns pointer to raw data of relocated value at RVA, which is not inside page of relocation table
+	char* get_rebase_value_pointer(const rebase_region_list& regions, uint32_t rva, uint32_t size)
+	{
+		std::size_t index = find_rebase_region(regions, rva);
+		if (index == regions.size())
+			throw pe_exception("No section found by presented address", pe_exception::no_section_found);
+
+		const rebase_region& region = regions[index];
+		//Don't check for underflow here, comparsion is unsigned
+		if (!region.data || region.raw_size < rva - region.rva + size)
+			throw pe_exception("RVA and requested data size does not exist inside section", pe_exception::rva_not_exists);
+
+		return region.data + (rva - region.rva);
+	}
+
+	//Helper: fills regions of image (headers and sections), which may be relocated
+	//Raw data of regions is not accessed for writing, region data pointers are zero
+	//Returns index of the first section region
+	std::size_t get_rebase_regions(const pe_base& pe, rebase_region_list& regions)
+	{
+		//Relocations may point to headers and sections (like for rebase_image), headers go first
+		const section_list& sections = pe.get_image_sections();
+		{
+			uint32_t headers_size = static_cast<uint32_t>(pe.get_full_headers_data().length());
+			if (!sections.empty())
+				headers_size = std::min(headers_size, sections.front().get_virtual_address());
+
+			if (headers_size)
+			{
+				rebase_region region = { 0, headers_size, 0, headers_size };
+				regions.push_back(region);
+			}
+		}
+
+		std::size_t first_section_region = regions.size();
+		for (section_list::const_iterator it = sections.begin(); it != sections.end(); ++it)
+		{
+			rebase_region region = { (*it).get_virtual_address(), (*it).get_aligned_virtual_size(pe.get_section_alignment()), 0, static_cast<uint32_t>((*it).get_raw_data().length()) };
+			regions.push_back(region);
+		}
+
+		return first_section_region;
+	}
+
+	//Helper: adds delta to "count" contiguous values
+	//Values are accessed with memcpy, so the loop is vectorized by compiler
+	template<typename T>
+	void add_rebase_delta(char* data, std::size_t count, T delta)
+	{
+		for (std::size_t i = 0; i != count; ++i, data += sizeof(T))
+		{
+			T value;
+			memcpy(&value, data, sizeof(value));
+			value += delta;
+			memcpy(data, &value, sizeof(value));
+		}
+	}
+
+	//Helper: applies HIGH, LOW or HIGHADJ relocation to 16-bit value
+	//param - low word of HIGHADJ relocation value (next entry of relocation table)
+	void apply_rebase_word(char* value_data, uint16_t type, uint16_t param, uint64_t delta)
+	{
+		uint16_t value;
+		memcpy(&value, value_data, sizeof(value));
+
+		if (type == image_rel_based_low)
+		{
+			//Low word of 32-bit value
+			value = static_cast<uint16_t>(value + static_cast<uint16_t>(delta));
+		}
+		else if (type == image_rel_based_high)
+		{
+			//High word of 32-bit value, low word is assumed to be zero
+			value = static_cast<uint16_t>(((static_cast<uint32_t>(value) << 16) + static_cast<uint32_t>(delta)) >> 16);
+		}
+		else
+		{
+			//High word of 32-bit value, low word is signed, and the result is rounded by adding 0x8000
+			uint32_t full_value = (static_cast<uint32_t>(value) << 16) + static_cast<int16_t>(param);
+			full_value += static_cast<uint32_t>(delta) + 0x8000;
+			value = static_cast<uint16_t>(full_value >> 16);
+		}
+
+		memcpy(value_data, &value, sizeof(value));
+	}
+
+	//Helper: applies relocations of single page
+	//Raw relocation words of page are used, so HIGHADJ parameter is always the next word
+	void rebase_relocation_page(const packed_relocation_page& relocs, const rebase_region_list& regions, uint64_t delta)
+	{
+		uint32_t page_rva = relocs.get_rva();
+
+		//Resolve page of table to raw data once
+		//Values, which are not inside raw data of page section, are looked up one by one
+		char* page = 0;
+		uint32_t page_size = 0;
+		std::size_t page_region = find_rebase_region(regions, page_rva);
+		if (page_region != regions.size() && regions[page_region].data)
+		{
+			const rebase_region& region = regions[page_region];
+			uint32_t page_offset = page_rva - region.rva;
+			uint32_t region_size = std::min(region.raw_size, region.virtual_size);
+			if (page_offset < region_size)
+			{
+				page = region.data + page_offset;
+				page_size = region_size - page_offset;
 			}
 		}
 
+		for (std::size_t i = 0; i < relocs.size(); ++i)
+		{
+			uint16_t type = relocs[i].get_type();
+			uint32_t offset = relocs[i].get_rva();
+
+			switch (type)
+			{
+			case image_rel_based_absolute:
+				break;
+
+			case image_rel_based_highlow:
+			case image_rel_based_dir64:
+				{
+					uint32_t size = type == image_rel_based_dir64 ? sizeof(uint64_t) : sizeof(uint32_t);
+
+					//Find run of contiguous relocations of the same type (pointer tables, vtables)
+					std::size_t count = 1;
+					while (i + count < relocs.size()
+						&& relocs[i + count].get_type() == type
+						&& relocs[i + count].get_rva() == offset + count * size)
+						++count;
+
+					if (offset + count * size <= page_size)
+					{
+						if (type == image_rel_based_dir64)
+							add_rebase_delta<uint64_t>(page + offset, count, delta);
+						else
+							add_rebase_delta<uint32_t>(page + offset, count, static_cast<uint32_t>(delta));
+					}
+					else
+					{
+						for (std::size_t j = 0; j != count; ++j)
+						{
+							uint32_t value_offset = static_cast<uint32_t>(offset + j * size);
+							char* value = value_offset + size <= page_size ? page + value_offset : get_rebase_value_pointer(regions, page_rva + value_offset, size);
+							if (type == image_rel_based_dir64)
+								add_rebase_delta<uint64_t>(value, 1, delta);
+							else
+								add_rebase_delta<uint32_t>(value, 1, static_cast<uint32_t>(delta));
+						}
+					}
+
+					i += count - 1;
+				}
+				break;
+
+			case image_rel_based_high:
+			case image_rel_based_low:
+			case image_rel_based_highadj:
+				{
+					char* value_data = offset + sizeof(uint16_t) <= page_size ? page + offset : get_rebase_value_pointer(regions, page_rva + offset, sizeof(uint16_t));
+
+					//Low word of HIGHADJ relocation value is the next word of page
+					uint16_t param = 0;
+					if (type == image_rel_based_highadj)
+					{
+						if (++i == relocs.size())
+							throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+						param = relocs.get_items()[i];
+					}
+
+					apply_rebase_word(value_data, type, param, delta);
+				}
+				break;
+
+			default:
+				throw pe_exception("Unsupported relocation type", pe_exception::cannot_rebase_relocations);
+			}
+		}
+	}
+
+	//High-throughput version of rebase_image for images with many relocations
+	void rebase_image_fast(pe_base& pe, const packed_relocations& relocs, uint64_t new_base, uint32_t max_threads)
+	{
+		rebase_region_list regions;
+		section_list& sections = pe.get_image_sections();
+		std::size_t first_section_region = get_rebase_regions(pe, regions);
+
+		//Mark regions, which may be changed by pages (page relocation value may cross its end)
+		//Only their raw data is accessed for writing, before any worker starts
+		std::vector<char> used_regions(regions.size());
+		for (std::size_t i = 0; i != relocs.get_page_count(); ++i)
+		{
+			packed_relocation_page page = relocs.get_page(i);
+			if (page.empty())
+				continue;
+
+			uint64_t page_end = static_cast<uint64_t>(page.get_rva()) + 0x1000 + sizeof(uint64_t);
+			std::size_t index = find_rebase_region(regions, page.get_rva());
+			for (; index < regions.size() && regions[index].rva < page_end; ++index)
+				used_regions[index] = 1;
+		}
+
+		for (std::size_t i = 0; i != regions.size(); ++i)
+		{
+			if (!used_regions[i])
+				continue;
+
+			rebase_region& region = regions[i];
+			if (i < first_section_region)
+			{
+				//Headers region
+				region.data = pe.section_data_from_rva(0, true);
+			}
+			else
+			{
+				std::string& raw_data = sections[i - first_section_region].get_raw_data();
+				region.raw_size = static_cast<uint32_t>(raw_data.length());
+				region.data = raw_data.empty() ? 0 : &raw_data[0];
+			}
+		}
+
+		uint64_t delta = new_base - pe.get_image_base_64();
+
+		//Small images are rebased in calling thread
+		const std::size_t min_pages_per_thread = 256;
+		uint32_t thread_count = max_threads ? max_threads : std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+		thread_count = static_cast<uint32_t>(std::min<std::size_t>(thread_count, relocs.get_page_count() / min_pages_per_thread));
+
+		if (thread_count <= 1)
+		{
+			for (std::size_t i = 0; i != relocs.get_page_count(); ++i)
+				rebase_relocation_page(relocs.get_page(i), regions, delta);
+		}
+		else
+		{
+			//Each worker takes next page
+			std::atomic<std::size_t> next_page(0);
+			std::vector<std::future<void> > workers;
+			for (uint32_t i = 0; i != thread_count; ++i)
+			{
+				workers.push_back(std::async(std::launch::async, [&relocs, &regions, &next_page, delta]()
+					{
+						for (std::size_t page = next_page++; page < relocs.get_page_count(); page = next_page++)
+							rebase_relocation_page(relocs.get_page(page), regions, delta);
+					}));
+			}
+
+			//Wait for all workers, rethrow first error, if any
+			for (std::size_t i = 0; i != workers.size(); ++i)
+				workers[i].wait();
+			for (std::size_t i = 0; i != workers.size(); ++i)
+				workers[i].get();
+		}
+
 		//Finally, save new image base
 		pe.set_image_base_64(new_base);
 	}
+
+	//PREPARED REBASE
+	//Default constructor (no relocations)
+	prepared_rebase::prepared_rebase()
+		:image_base_(0), relocation_count_(0), section_count_(0), max_rva_(0)
+	{}
+
+	//Prepares relocations of image
+	prepared_rebase::prepared_rebase(const pe_base& pe)
+		:prepared_rebase(pe, get_packed_relocations(pe))
+	{}
+
+	//Prepares relocations of image
+	prepared_rebase::prepared_rebase(const pe_base& pe, const packed_relocations& relocs)
+		:image_base_(pe.get_image_base_64()), relocation_count_(0), section_count_(pe.get_image_sections().size()), max_rva_(0)
+	{
+		rebase_region_list regions;
+		std::size_t first_section_region = get_rebase_regions(pe, regions);
+
+		//Resolve all relocations in order of tables, remember region of each slot
+		std::vector<rebase_slot> slots;
+		std::vector<uint32_t> slot_regions;
+		for (std::size_t i = 0; i != relocs.get_page_count(); ++i)
+		{
+			packed_relocation_page page = relocs.get_page(i);
+			for (std::size_t j = 0; j < page.size(); ++j)
+			{
+				relocation_entry entry(page[j]);
+				uint16_t type = entry.get_type();
+				uint16_t param = 0;
+				uint32_t size;
+				switch (type)
+				{
+				case image_rel_based_absolute:
+					continue;
+
+				case image_rel_based_highlow:
+					size = sizeof(uint32_t);
+					break;
+
+				case image_rel_based_dir64:
+					size = sizeof(uint64_t);
+					break;
+
+				case image_rel_based_high:
+				case image_rel_based_low:
+					size = sizeof(uint16_t);
+					break;
+
+				case image_rel_based_highadj:
+					//Low word of value is the next entry of table
+					if (++j == page.size())
+						throw pe_exception("Incorrect relocation directory", pe_exception::incorrect_relocation_directory);
+
+					param = page.get_items()[j];
+					size = sizeof(uint16_t);
+					break;
+
+				default:
+					throw pe_exception("Unsupported relocation type", pe_exception::cannot_rebase_relocations);
+				}
+
+				//Check that value is inside raw data of headers or section
+				uint32_t rva = page.get_rva() + entry.get_rva();
+				std::size_t region_index = find_rebase_region(regions, rva);
+				if (region_index == regions.size())
+					throw pe_exception("No section found by presented address", pe_exception::no_section_found);
+
+				const rebase_region& region = regions[region_index];
+				//Don't check for underflow here, comparsion is unsigned
+				if (region.raw_size < rva - region.rva + size)
+					throw pe_exception("RVA and requested data size does not exist inside section", pe_exception::rva_not_exists);
+
+				++relocation_count_;
+				max_rva_ = std::max(max_rva_, rva + size);
+
+				//Merge contiguous HIGHLOW and DIR64 values of the same region into runs
+				if ((type == image_rel_based_highlow || type == image_rel_based_dir64)
+					&& !slots.empty()
+					&& slot_regions.back() == region_index
+					&& slots.back().type == type
+					&& slots.back().param != 0xffff
+					&& slots.back().rva + slots.back().param * size == rva)
+				{
+					++slots.back().param;
+					continue;
+				}
+
+				rebase_slot slot = { rva, type, type == image_rel_based_highlow || type == image_rel_based_dir64 ? static_cast<uint16_t>(1) : param };
+				slots.push_back(slot);
+				slot_regions.push_back(static_cast<uint32_t>(region_index));
+			}
+		}
+
+		//Group slots by regions (stable counting sort, so slots of region stay in order of tables)
+		std::vector<uint32_t> region_slots(regions.size() + 1);
+		for (std::size_t i = 0; i != slot_regions.size(); ++i)
+			++region_slots[slot_regions[i] + 1];
+
+		for (std::size_t i = 0; i != regions.size(); ++i)
+		{
+			if (region_slots[i + 1])
+			{
+				rebase_target target = { i < first_section_region, static_cast<uint32_t>(i - (i < first_section_region ? 0 : first_section_region)), regions[i].rva, 0, region_slots[i] };
+				targets_.push_back(target);
+			}
+
+			region_slots[i + 1] += region_slots[i];
+		}
+
+		slots_.resize(slots.size());
+		for (std::size_t i = 0; i != slots.size(); ++i)
+			slots_[region_slots[slot_regions[i]]++] = slots[i];
+
+		//Calculate raw data sizes needed for regions
+		for (std::size_t i = 0; i != targets_.size(); ++i)
+		{
+			rebase_target& target = targets_[i];
+			std::size_t last_slot = i + 1 == targets_.size() ? slots_.size() : targets_[i + 1].first_slot;
+			for (std::size_t j = target.first_slot; j != last_slot; ++j)
+			{
+				const rebase_slot& slot = slots_[j];
+				uint32_t size = slot.type == image_rel_based_dir64 ? slot.param * sizeof(uint64_t)
+					: slot.type == image_rel_based_highlow ? slot.param * sizeof(uint32_t)
+					: sizeof(uint16_t);
+
+				target.needed_size = std::max(target.needed_size, slot.rva - target.rva + size);
+			}
+		}
+	}
+
+	//Returns image base of prepared image
+	uint64_t prepared_rebase::get_image_base() const
+	{
+		return image_base_;
+	}
+
+	//Returns number of relocated values
+	std::size_t prepared_rebase::get_relocation_count() const
+	{
+		return relocation_count_;
+	}
+
+	//Applies slots of region to its data
+	void prepared_rebase::apply_slots(char* data, uint32_t data_rva, std::size_t target_index, uint64_t delta) const
+	{
+		std::size_t last_slot = target_index + 1 == targets_.size() ? slots_.size() : targets_[target_index + 1].first_slot;
+		for (std::size_t i = targets_[target_index].first_slot; i != last_slot; ++i)
+		{
+			const rebase_slot& slot = slots_[i];
+			char* value = data + (slot.rva - data_rva);
+			if (slot.type == image_rel_based_dir64)
+				add_rebase_delta<uint64_t>(value, slot.param, delta);
+			else if (slot.type == image_rel_based_highlow)
+				add_rebase_delta<uint32_t>(value, slot.param, static_cast<uint32_t>(delta));
+			else
+				apply_rebase_word(value, slot.type, slot.param, delta);
+		}
+	}
+
+	//Rebases image to new base
+	void prepared_rebase::apply(pe_base& pe, uint64_t new_base) const
+	{
+		section_list& sections = pe.get_image_sections();
+
+		//Check layout of image before changing anything
+		if (sections.size() != section_count_)
+			throw pe_exception("Image sections layout differs from prepared one", pe_exception::cannot_rebase_relocations);
+
+		for (std::vector<rebase_target>::const_iterator it = targets_.begin(); it != targets_.end(); ++it)
+		{
+			const rebase_target& target = (*it);
+			if (target.headers
+				? pe.get_full_headers_data().length() < target.needed_size
+				: (sections[target.section_index].get_virtual_address() != target.rva
+					|| static_cast<const section&>(sections[target.section_index]).get_raw_data().length() < target.needed_size))
+				throw pe_exception("Image sections layout differs from prepared one", pe_exception::cannot_rebase_relocations);
+		}
+
+		uint64_t delta = new_base - pe.get_image_base_64();
+		for (std::size_t i = 0; i != targets_.size(); ++i)
+		{
+			const rebase_target& target = targets_[i];
+			char* data = target.headers ? pe.section_data_from_rva(0, true) : &sections[target.section_index].get_raw_data()[0];
+			apply_slots(data, target.rva, i, delta);
+		}
+
+		pe.set_image_base_64(new_base);
+	}
+
+	//Rebases image mapped to memory
+	void prepared_rebase::apply(char* image, std::size_t image_size, uint64_t current_base, uint64_t new_base) const
+	{
+		if (image_size < max_rva_)
+			throw pe_exception("Image buffer is too small for prepared relocations", pe_exception::cannot_rebase_relocations);
+
+		uint64_t delta = new_base - current_base;
+		for (std::size_t i = 0; i != targets_.size(); ++i)
+			apply_slots(image, 0, i, delta);
+	}
 }
@@ -17,6 +17,11 @@ namespace pe_bliss
 		:codepage_(codepage), data_(data)
 	{}
 
+	//Constructor from data
+	resource_data_entry::resource_data_entry(std::string&& data, uint32_t codepage)
+		:codepage_(codepage), data_(std::move(data))
+	{}
+
 	//Returns resource data codepage
 	uint32_t resource_data_entry::get_codepage() const
 	{
@@ -41,6 +46,12 @@ namespace pe_bliss
 		data_ = data;
 	}
 
+	//Sets resource data
+	void resource_data_entry::set_data(std::string&& data)
+	{
+		data_ = std::move(data);
+	}
+
 	//Default constructor
 	resource_directory_entry::includes::includes()
 		:data_(0)
@@ -51,40 +62,104 @@ namespace pe_bliss
 		:id_(0), includes_data_(false), named_(false)
 	{}
 
+	//Constructor with allocator
+	resource_directory_entry::resource_directory_entry(const allocator_type& allocator)
+		:allocator_(allocator), id_(0), includes_data_(false), named_(false)
+	{}
+
 	//Copy constructor
 	resource_directory_entry::resource_directory_entry(const resource_directory_entry& other)
 		:id_(other.id_), name_(other.name_), includes_data_(other.includes_data_), named_(other.named_)
 	{
-		//If union'ed pointer is not zero
-		if (other.ptr_.data_)
-		{
-			if (other.includes_data())
-				ptr_.data_ = new resource_data_entry(*other.ptr_.data_);
-			else
-				ptr_.dir_ = new resource_directory(*other.ptr_.dir_);
-		}
+		copy_included(other);
+	}
+
+	//Allocator-extended copy constructor
+	resource_directory_entry::resource_directory_entry(const resource_directory_entry& other, const allocator_type& allocator)
+		:allocator_(allocator), id_(other.id_), name_(other.name_), includes_data_(other.includes_data_), named_(other.named_)
+	{
+		copy_included(other);
 	}
 
 	//Copy assignment operator
 	resource_directory_entry& resource_directory_entry::operator=(const resource_directory_entry& other)
 	{
-		release();
+		if (this != &other)
+		{
+			release();
+
+			id_ = other.id_;
+			name_ = other.name_;
+			includes_data_ = other.includes_data_;
+			named_ = other.named_;
+
+			copy_included(other);
+		}
+
+		return *this;
+	}
+
+	//Move constructor
+	resource_directory_entry::resource_directory_entry(resource_directory_entry&& other) noexcept
+		:allocator_(other.allocator_), id_(other.id_), name_(std::move(other.name_)), ptr_(other.ptr_), includes_data_(other.includes_data_), named_(other.named_)
+	{
+		other.ptr_.data_ = 0;
+	}
+
+	//Allocator-extended move constructor
+	resource_directory_entry::resource_directory_entry(resource_directory_entry&& other, const allocator_type& allocator)
+		:allocator_(allocator), id_(other.id_), name_(std::move(other.name_)), includes_data_(other.includes_data_), named_(other.named_)
+	{
+		if (allocator_ == other.allocator_)
+		{
+			//Take union'ed pointer from other entry
+			ptr_ = other.ptr_;
+			other.ptr_.data_ = 0;
+		}
+		else
+		{
+			copy_included(other);
+		}
+	}
+
+	//Move assignment operator
+	resource_directory_entry& resource_directory_entry::operator=(resource_directory_entry&& other)
+	{
+		if (this != &other)
+		{
+			release();
+
+			id_ = other.id_;
+			name_ = std::move(other.name_);
+			includes_data_ = other.includes_data_;
+			named_ = other.named_;
+
+			if (allocator_ == other.allocator_)
+			{
+				//Take union'ed pointer from other entry
+				ptr_ = other.ptr_;
+				other.ptr_.data_ = 0;
+			}
+			else
+			{
+				copy_included(other);
+			}
+		}
 
-		id_ = other.id_;
-		name_ = other.name_;
-		includes_data_ = other.includes_data_;
-		named_ = other.named_;
+		return *this;
+	}
 
+	//Copies included data or directory of other entry
+	void resource_directory_entry::copy_included(const resource_directory_entry& other)
+	{
 		//If other union'ed pointer is not zero
 		if (other.ptr_.data_)
 		{
 			if (other.includes_data())
-				ptr_.data_ = new resource_data_entry(*other.ptr_.data_);
+				ptr_.data_ = allocator_.new_object<resource_data_entry>(*other.ptr_.data_);
 			else
-				ptr_.dir_ = new resource_directory(*other.ptr_.dir_);
+				ptr_.dir_ = allocator_.new_object<resource_directory>(*other.ptr_.dir_);
 		}
-
-		return *this;
 	}
 
 	//Destroys included data
@@ -94,9 +169,9 @@ namespace pe_bliss
 		if (ptr_.data_)
 		{
 			if (includes_data())
-				delete ptr_.data_;
+				allocator_.delete_object(ptr_.data_);
 			else
-				delete ptr_.dir_;
+				allocator_.delete_object(ptr_.dir_);
 
 			ptr_.data_ = 0;
 		}
@@ -190,7 +265,7 @@ namespace pe_bliss
 	void resource_directory_entry::add_data_entry(const resource_data_entry& entry)
 	{
 		release();
-		ptr_.data_ = new resource_data_entry(entry);
+		ptr_.data_ = allocator_.new_object<resource_data_entry>(entry);
 		includes_data_ = true;
 	}
 
@@ -198,7 +273,23 @@ namespace pe_bliss
 	void resource_directory_entry::add_resource_directory(const resource_directory& dir)
 	{
 		release();
-		ptr_.dir_ = new resource_directory(dir);
+		ptr_.dir_ = allocator_.new_object<resource_directory>(dir);
+		includes_data_ = false;
+	}
+
+	//Adds resource_data_entry
+	void resource_directory_entry::add_data_entry(resource_data_entry&& entry)
+	{
+		release();
+		ptr_.data_ = allocator_.new_object<resource_data_entry>(std::move(entry));
+		includes_data_ = true;
+	}
+
+	//Adds resource_directory
+	void resource_directory_entry::add_resource_directory(resource_directory&& dir)
+	{
+		release();
+		ptr_.dir_ = allocator_.new_object<resource_directory>(std::move(dir));
 		includes_data_ = false;
 	}
 
@@ -218,6 +309,42 @@ namespace pe_bliss
 		number_of_named_entries_(0), number_of_id_entries_(0) //Set to zero here, calculate on add
 	{}
 
+	//Constructor with allocator
+	resource_directory::resource_directory(const allocator_type& allocator)
+		:characteristics_(0),
+		timestamp_(0),
+		major_version_(0), minor_version_(0),
+		number_of_named_entries_(0), number_of_id_entries_(0),
+		entries_(allocator)
+	{}
+
+	//Constructor from data with allocator
+	resource_directory::resource_directory(const image_resource_directory& dir, const allocator_type& allocator)
+		:characteristics_(dir.Characteristics),
+		timestamp_(dir.TimeDateStamp),
+		major_version_(dir.MajorVersion), minor_version_(dir.MinorVersion),
+		number_of_named_entries_(0), number_of_id_entries_(0), //Set to zero here, calculate on add
+		entries_(allocator)
+	{}
+
+	//Allocator-extended copy constructor
+	resource_directory::resource_directory(const resource_directory& other, const allocator_type& allocator)
+		:characteristics_(other.characteristics_),
+		timestamp_(other.timestamp_),
+		major_version_(other.major_version_), minor_version_(other.minor_version_),
+		number_of_named_entries_(other.number_of_named_entries_), number_of_id_entries_(other.number_of_id_entries_),
+		entries_(other.entries_, allocator)
+	{}
+
+	//Allocator-extended move constructor
+	resource_directory::resource_directory(resource_directory&& other, const allocator_type& allocator)
+		:characteristics_(other.characteristics_),
+		timestamp_(other.timestamp_),
+		major_version_(other.major_version_), minor_version_(other.minor_version_),
+		number_of_named_entries_(other.number_of_named_entries_), number_of_id_entries_(other.number_of_id_entries_),
+		entries_(std::move(other.entries_), allocator)
+	{}
+
 	//Returns characteristics of directory
 	uint32_t resource_directory::get_characteristics() const
 	{
@@ -276,6 +403,17 @@ namespace pe_bliss
 			++number_of_id_entries_;
 	}
 
+	//Adds resource_directory_entry
+	void resource_directory::add_resource_directory_entry(resource_directory_entry&& entry)
+	{
+		if (entry.is_named())
+			++number_of_named_entries_;
+		else
+			++number_of_id_entries_;
+
+		entries_.push_back(std::move(entry));
+	}
+
 	//Clears resource_directory_entry array
 	void resource_directory::clear_resource_directory_entry_list()
 	{
@@ -321,10 +459,8 @@ namespace pe_bliss
 	}
 
 	//Processes resource directory
-	const resource_directory process_resource_directory(const pe_base& pe, uint32_t res_rva, uint32_t offset_to_directory, std::set<uint32_t>& processed)
+	resource_directory process_resource_directory(const pe_base& pe, uint32_t res_rva, uint32_t offset_to_directory, std::set<uint32_t>& processed, const resource_directory::allocator_type& allocator)
 	{
-		resource_directory ret;
-
 		//Check for resource loops
 		if (!processed.insert(offset_to_directory).second)
 			throw pe_exception("Incorrect resource directory", pe_exception::incorrect_resource_directory);
@@ -335,7 +471,7 @@ namespace pe_bliss
 		//Get root IMAGE_RESOURCE_DIRECTORY
 		image_resource_directory directory = pe.section_data_from_rva<image_resource_directory>(res_rva + offset_to_directory, section_data_virtual, true);
 
-		ret = resource_directory(directory);
+		resource_directory ret(directory, allocator);
 
 		//Check DWORDs for possible overflows
 		if (!pe_utils::is_sum_safe(directory.NumberOfIdEntries, directory.NumberOfNamedEntries)
@@ -353,7 +489,7 @@ namespace pe_bliss
 				res_rva + sizeof(image_resource_directory) + i * sizeof(image_resource_directory_entry) + offset_to_directory, section_data_virtual, true);
 
 			//Create directory entry structure
-			resource_directory_entry entry;
+			resource_directory_entry entry(allocator);
 
 			//If directory is named
 			if (dir_entry.NameIsString)
@@ -390,7 +526,7 @@ namespace pe_bliss
 			//If directory entry has another resource directory
 			if (dir_entry.DataIsDirectory)
 			{
-				entry.add_resource_directory(process_resource_directory(pe, res_rva, dir_entry.OffsetToDirectory, processed));
+				entry.add_resource_directory(process_resource_directory(pe, res_rva, dir_entry.OffsetToDirectory, processed, allocator));
 			}
 			else
 			{
@@ -409,7 +545,7 @@ namespace pe_bliss
 			}
 
 			//Save directory entry
-			ret.add_resource_directory_entry(entry);
+			ret.add_resource_directory_entry(std::move(entry));
 		}
 
 		//Return resource directory
@@ -570,7 +706,7 @@ namespace pe_bliss
 	//save_to_pe_headers - if true, new resource directory information will be saved to PE image headers
 	//auto_strip_last_section - if true and resources are placed in the last section, it will be automatically stripped
 	//number_of_id_entries and number_of_named_entries for resource directories are recalculated and not used
-	const image_directory rebuild_resources(pe_base& pe, resource_directory& info, section& resources_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_resources(pe_base& pe, resource_directory& info, section& resources_section, uint32_t offset_from_section_start, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		//Check that resources_section is attached to this PE image
 		if (!pe.section_attached(resources_section))
@@ -627,12 +763,10 @@ namespace pe_bliss
 	}
 
 	//Returns resources from PE file
-	const resource_directory get_resources(const pe_base& pe)
+	resource_directory get_resources(const pe_base& pe, std::pmr::memory_resource* resource)
 	{
-		resource_directory ret;
-
 		if (!pe.has_resources())
-			return ret;
+			return resource_directory(resource_directory::allocator_type(resource));
 
 		//Get resource directory RVA
 		uint32_t res_rva = pe.get_directory_rva(image_directory_entry_resource);
@@ -641,9 +775,7 @@ namespace pe_bliss
 		std::set<uint32_t> processed;
 
 		//Process all directories (recursion)
-		ret = process_resource_directory(pe, res_rva, 0, processed);
-
-		return ret;
+		return process_resource_directory(pe, res_rva, 0, processed, resource_directory::allocator_type(resource));
 	}
 
 	//Finds resource_directory_entry by ID
@@ -40,7 +40,7 @@ namespace pe_bliss
 	}
 
 	//Returns MSVC rich data
-	const rich_data_list get_rich_data(const pe_base& pe)
+	rich_data_list get_rich_data(const pe_base& pe)
 	{
 		//Returned value
 		rich_data_list ret;
@@ -1,6 +1,7 @@
 #include <string.h>
 #include "utils.h"
 #include "pe_section.h"
+#include "pe_exception.h"
 #include <algorithm>
 
 namespace pe_bliss
@@ -9,11 +10,40 @@ namespace pe_bliss
 
 	//Section structure default constructor
 	section::section()
-		:old_size_(static_cast<size_t>(-1))
+		:old_size_(static_cast<size_t>(-1)), virtual_data_(std::make_shared<virtual_data_cache>()),
+		source_offset_(0), source_size_(0), has_source_(false), raw_data_unchanged_(false)
 	{
 		memset(&header_, 0, sizeof(image_section_header));
 	}
 
+	//Copy constructor
+	section::section(const section& other)
+		:header_(other.header_), old_size_(other.old_size_), raw_data_(other.raw_data_),
+		virtual_data_(other.raw_data_.unshareable() ? std::make_shared<virtual_data_cache>() : other.virtual_data_),
+		source_offset_(other.source_offset_), source_size_(other.source_size_), has_source_(other.has_source_),
+		raw_data_unchanged_(other.raw_data_unchanged_), dirty_ranges_(other.dirty_ranges_)
+	{}
+
+	//Copy assignment operator
+	section& section::operator=(const section& other)
+	{
+		if (this != &other)
+		{
+			header_ = other.header_;
+			old_size_ = other.old_size_;
+			raw_data_ = other.raw_data_;
+			//Copied raw data is not shared, so zero-padded copies of it are not shared too
+			virtual_data_ = other.raw_data_.unshareable() ? std::make_shared<virtual_data_cache>() : other.virtual_data_;
+			source_offset_ = other.source_offset_;
+			source_size_ = other.source_size_;
+			has_source_ = other.has_source_;
+			raw_data_unchanged_ = other.raw_data_unchanged_;
+			dirty_ranges_ = other.dirty_ranges_;
+		}
+
+		return *this;
+	}
+
 	//Sets the name of section (8 characters maximum)
 	void section::set_name(const std::string& name)
 	{
@@ -22,7 +52,7 @@ namespace pe_bliss
 	}
 
 	//Returns section name
-	const std::string section::get_name() const
+	std::string section::get_name() const
 	{
 		char buf[9] = { 0 };
 		memcpy(buf, header_.Name, 8);
@@ -104,52 +134,196 @@ namespace pe_bliss
 		if (old_size_ != static_cast<size_t>(-1)) //If virtual memory is mapped, check raw data length (old_size_)
 			return old_size_ == 0;
 		else
-			return raw_data_.empty();
+			return raw_data_.get().empty();
 	}
 
 	//Returns raw section data from file image
 	std::string& section::get_raw_data()
 	{
+		reset_virtual_data();
 		unmap_virtual();
-		return raw_data_;
+		raw_data_unchanged_ = false;
+		return raw_data_.get_unshareable();
 	}
 
 	//Sets raw section data from file image
 	void section::set_raw_data(const std::string& data)
 	{
+		reset_virtual_data();
 		old_size_ = static_cast<size_t>(-1);
-		raw_data_ = data;
+		raw_data_.set(data);
+		raw_data_unchanged_ = false;
+	}
+
+	//Sets raw section data from file image
+	void section::set_raw_data(std::string&& data)
+	{
+		reset_virtual_data();
+		old_size_ = static_cast<size_t>(-1);
+		raw_data_.set(std::move(data));
+		raw_data_unchanged_ = false;
+	}
+
+	//Writes data to raw section data at offset
+	void section::patch_raw_data(uint32_t offset, const char* data, uint32_t size)
+	{
+		unmap_virtual();
+
+		if (!pe_utils::is_sum_safe(offset, size) || offset + size > raw_data_.get().length())
+			throw pe_exception("Section raw data is too small", pe_exception::insufficient_space);
+
+		if (!size)
+			return;
+
+		reset_virtual_data();
+		memcpy(&raw_data_.get_for_write()[offset], data, size);
+
+		//Extend the last range, if new one continues it
+		if (!dirty_ranges_.empty() && dirty_ranges_.back().first + dirty_ranges_.back().second == offset)
+			dirty_ranges_.back().second += size;
+		else
+			dirty_ranges_.push_back(std::make_pair(offset, size));
 	}
 
 	//Returns raw section data from file image
 	const std::string& section::get_raw_data() const
 	{
 		unmap_virtual();
-		return raw_data_;
+		return raw_data_.get();
 	}
 
 	//Returns mapped virtual section data
 	const std::string& section::get_virtual_data(uint32_t section_alignment) const
 	{
-		map_virtual(section_alignment);
-		return raw_data_;
+		//Raw data is returned as is, if it is already mapped (by non-const get_virtual_data) or it is long enough
+		uint32_t size = get_virtual_data_size(section_alignment);
+		if (old_size_ != static_cast<size_t>(-1) || size == raw_data_.get().length())
+			return raw_data_.get();
+
+		//Raw data may be changed through reference returned by non-const accessors, so it is mapped in place, without cache
+		if (raw_data_.unshareable())
+		{
+			map_virtual(section_alignment);
+			return raw_data_.get();
+		}
+
+		//Moved-from section has no cache
+		if (!virtual_data_)
+			virtual_data_ = std::make_shared<virtual_data_cache>();
+
+		std::lock_guard<std::mutex> lock(virtual_data_->lock);
+		for (std::vector<std::unique_ptr<const std::string> >::const_iterator it = virtual_data_->data.begin(); it != virtual_data_->data.end(); ++it)
+		{
+			if ((*it)->length() == size)
+				return **it;
+		}
+
+		//Create zero-padded copy of raw data
+		std::unique_ptr<std::string> data(new std::string(raw_data_.get()));
+		data->resize(size, 0);
+		virtual_data_->data.push_back(std::move(data));
+		return *virtual_data_->data.back();
 	}
 
 	//Returns mapped virtual section data
 	std::string& section::get_virtual_data(uint32_t section_alignment)
 	{
+		reset_virtual_data();
 		map_virtual(section_alignment);
-		return raw_data_;
+		raw_data_unchanged_ = false;
+		return raw_data_.get_unshareable();
+	}
+
+	//Returns true if section raw data was read from file
+	bool section::has_source() const
+	{
+		return has_source_;
+	}
+
+	//Returns true if section raw data was not changed since it was read from file
+	bool section::raw_data_unchanged() const
+	{
+		return raw_data_unchanged_ && dirty_ranges_.empty();
+	}
+
+	//Returns true if section raw data was accessed for writing as a whole since it was read from file
+	bool section::raw_data_rewritten() const
+	{
+		return !raw_data_unchanged_;
+	}
+
+	//Returns list of raw data ranges changed by patch_raw_data
+	const section::dirty_range_list& section::get_dirty_ranges() const
+	{
+		return dirty_ranges_;
+	}
+
+	//Returns offset of section raw data in the file image was read from
+	uint32_t section::get_source_offset() const
+	{
+		return source_offset_;
+	}
+
+	//Returns size of section raw data in the file image was read from
+	uint32_t section::get_source_size() const
+	{
+		return source_size_;
+	}
+
+	//Sets offset of section raw data in the file image was read from and marks raw data unchanged
+	void section::set_source_offset(uint32_t offset)
+	{
+		unmap_virtual();
+		source_offset_ = offset;
+		source_size_ = static_cast<uint32_t>(raw_data_.get().length());
+		has_source_ = true;
+		raw_data_unchanged_ = true;
+		dirty_ranges_.clear();
+	}
+
+	//Returns size of mapped virtual section data
+	uint32_t section::get_virtual_data_size(uint32_t section_alignment) const
+	{
+		//If data is mapped already, its size is the size of mapped data
+		if (old_size_ != static_cast<size_t>(-1))
+			return static_cast<uint32_t>(raw_data_.get().length());
+
+		return std::max<uint32_t>(get_aligned_virtual_size(section_alignment), static_cast<uint32_t>(raw_data_.get().length()));
+	}
+
+	//Copies data from offset of mapped virtual section data
+	bool section::read_virtual_data(uint32_t section_alignment, uint32_t offset, char* data, uint32_t size) const
+	{
+		if (!pe_utils::is_sum_safe(offset, size) || offset + size > get_virtual_data_size(section_alignment))
+			return false;
+
+		//Data after raw data is zero
+		const std::string& raw_data = raw_data_.get();
+		uint32_t raw_size = offset < raw_data.length() ? std::min<uint32_t>(size, static_cast<uint32_t>(raw_data.length()) - offset) : 0;
+		if (raw_size)
+			memcpy(data, raw_data.data() + offset, raw_size);
+
+		memset(data + raw_size, 0, size - raw_size);
+		return true;
+	}
+
+	//Drops zero-padded copies of raw data before it is changed
+	void section::reset_virtual_data()
+	{
+		//Copies may be used by section copies, which share old raw data, so new cache is created
+		if (!virtual_data_ || !virtual_data_->data.empty() || virtual_data_.use_count() > 1)
+			virtual_data_ = std::make_shared<virtual_data_cache>();
 	}
 
 	//Maps virtual section data
 	void section::map_virtual(uint32_t section_alignment) const
 	{
 		uint32_t aligned_virtual_size = get_aligned_virtual_size(section_alignment);
-		if (old_size_ == static_cast<size_t>(-1) && aligned_virtual_size && aligned_virtual_size > raw_data_.length())
+		if (old_size_ == static_cast<size_t>(-1) && aligned_virtual_size && aligned_virtual_size > raw_data_.get().length())
 		{
-			old_size_ = raw_data_.length();
-			raw_data_.resize(aligned_virtual_size, 0);
+			//Mapping changes data size, so shared data is copied here (only non-const get_virtual_data maps data)
+			old_size_ = raw_data_.get().length();
+			raw_data_.get_for_write().resize(aligned_virtual_size, 0);
 		}
 	}
 
@@ -158,7 +332,7 @@ namespace pe_bliss
 	{
 		if (old_size_ != static_cast<size_t>(-1))
 		{
-			raw_data_.resize(old_size_, 0);
+			raw_data_.get_for_write().resize(old_size_, 0);
 			old_size_ = static_cast<size_t>(-1);
 		}
 	}
@@ -127,8 +127,14 @@ namespace pe_bliss
 		raw_data_ = data;
 	}
 
+	//Sets raw TLS data
+	void tls_info::set_raw_data(std::string&& data)
+	{
+		raw_data_ = std::move(data);
+	}
+
 	//If image does not have TLS, throws an exception
-	const tls_info get_tls_info(const pe_base& pe)
+	tls_info get_tls_info(const pe_base& pe)
 	{
 		return pe.get_pe_type() == pe_type_32
 			? get_tls_info_base<pe_types_class_32>(pe)
@@ -136,7 +142,7 @@ namespace pe_bliss
 	}
 
 	//TLS Rebuilder
-	const image_directory rebuild_tls(pe_base& pe, const tls_info& info, section& tls_section, uint32_t offset_from_section_start, bool write_tls_callbacks, bool write_tls_data, tls_data_expand_type expand, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_tls(pe_base& pe, const tls_info& info, section& tls_section, uint32_t offset_from_section_start, bool write_tls_callbacks, bool write_tls_data, tls_data_expand_type expand, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		return pe.get_pe_type() == pe_type_32
 			? rebuild_tls_base<pe_types_class_32>(pe, info, tls_section, offset_from_section_start, write_tls_callbacks, write_tls_data, expand, save_to_pe_header, auto_strip_last_section)
@@ -146,7 +152,7 @@ namespace pe_bliss
 	//Get TLS info
 	//If image does not have TLS, throws an exception
 	template<typename PEClassType>
-	const tls_info get_tls_info_base(const pe_base& pe)
+	tls_info get_tls_info_base(const pe_base& pe)
 	{
 		tls_info ret;
 
@@ -226,7 +232,7 @@ namespace pe_bliss
 	//auto_strip_last_section - if true and TLS are placed in the last section, it will be automatically stripped
 	//Note/TODO: TLS Callbacks array is not DWORD-aligned (seems to work on WinXP - Win7)
 	template<typename PEClassType>
-	const image_directory rebuild_tls_base(pe_base& pe, const tls_info& info, section& tls_section, uint32_t offset_from_section_start, bool write_tls_callbacks, bool write_tls_data, tls_data_expand_type expand, bool save_to_pe_header, bool auto_strip_last_section)
+	image_directory rebuild_tls_base(pe_base& pe, const tls_info& info, section& tls_section, uint32_t offset_from_section_start, bool write_tls_callbacks, bool write_tls_data, tls_data_expand_type expand, bool save_to_pe_header, bool auto_strip_last_section)
 	{
 		//Check that tls_section is attached to this PE image
 		if (!pe.section_attached(tls_section))
@@ -312,7 +318,7 @@ namespace pe_bliss
 
 			//Write raw TLS data, if any
 			if (write_raw_data_size != 0)
-				memcpy(pe.section_data_from_rva(info.get_raw_data_start_rva(), true), info.get_raw_data().data(), write_raw_data_size);
+				pe.patch_section_data(info.get_raw_data_start_rva(), info.get_raw_data().data(), static_cast<uint32_t>(write_raw_data_size), true);
 		}
 
 		//If we are asked to rewrite TLS callbacks addresses
@@ -354,8 +360,9 @@ namespace pe_bliss
 			//Ending null element
 			callbacks_virtual_addresses.push_back(0);
 
-			//Write callbacks TLS data
-			memcpy(pe.section_data_from_rva(info.get_callbacks_rva(), true), &callbacks_virtual_addresses[0], needed_callback_size);
+			//Write callbacks TLS data (last zero element is not written, if it is virtual only)
+			pe.patch_section_data(info.get_callbacks_rva(), reinterpret_cast<const char*>(&callbacks_virtual_addresses[0]),
+				std::min<uint32_t>(static_cast<uint32_t>(needed_callback_size), pe.section_data_length_from_rva(info.get_callbacks_rva(), info.get_callbacks_rva(), section_data_raw, true)), true);
 		}
 
 		//Adjust section raw and virtual sizes
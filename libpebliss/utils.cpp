@@ -28,7 +28,7 @@ namespace pe_bliss
 	}
 
 #ifndef PE_BLISS_WINDOWS
-	const u16string pe_utils::to_ucs2(const std::wstring& str)
+	u16string pe_utils::to_ucs2(const std::wstring& str)
 	{
 		u16string ret;
 		if (str.empty())
@@ -54,7 +54,7 @@ namespace pe_bliss
 		return ret;
 	}
 
-	const std::wstring pe_utils::from_ucs2(const u16string& str)
+	std::wstring pe_utils::from_ucs2(const u16string& str)
 	{
 		std::wstring ret;
 		if (str.empty())
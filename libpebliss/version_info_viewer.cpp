@@ -20,55 +20,55 @@ namespace pe_bliss
 	//If there's no default language translation, the first one will be taken
 
 	//Returns company name
-	const std::wstring version_info_viewer::get_company_name(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_company_name(const std::wstring& translation) const
 	{
 		return get_property(L"CompanyName", translation);
 	}
 
 	//Returns file description
-	const std::wstring version_info_viewer::get_file_description(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_file_description(const std::wstring& translation) const
 	{
 		return get_property(L"FileDescription", translation);
 	}
 
 	//Returns file version
-	const std::wstring version_info_viewer::get_file_version(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_file_version(const std::wstring& translation) const
 	{
 		return get_property(L"FileVersion", translation);
 	}
 
 	//Returns internal file name
-	const std::wstring version_info_viewer::get_internal_name(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_internal_name(const std::wstring& translation) const
 	{
 		return get_property(L"InternalName", translation);
 	}
 
 	//Returns legal copyright
-	const std::wstring version_info_viewer::get_legal_copyright(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_legal_copyright(const std::wstring& translation) const
 	{
 		return get_property(L"LegalCopyright", translation);
 	}
 
 	//Returns original file name
-	const std::wstring version_info_viewer::get_original_filename(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_original_filename(const std::wstring& translation) const
 	{
 		return get_property(L"OriginalFilename", translation);
 	}
 
 	//Returns product name
-	const std::wstring version_info_viewer::get_product_name(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_product_name(const std::wstring& translation) const
 	{
 		return get_property(L"ProductName", translation);
 	}
 
 	//Returns product version
-	const std::wstring version_info_viewer::get_product_version(const std::wstring& translation) const
+	std::wstring version_info_viewer::get_product_version(const std::wstring& translation) const
 	{
 		return get_property(L"ProductVersion", translation);
 	}
 
 	//Returns list of translations in string representation
-	const version_info_viewer::translation_list version_info_viewer::get_translation_list() const
+	version_info_viewer::translation_list version_info_viewer::get_translation_list() const
 	{
 		translation_list ret;
 
@@ -92,7 +92,7 @@ namespace pe_bliss
 	//property_name - required property name
 	//If throw_if_absent = true, will throw exception if property does not exist
 	//If throw_if_absent = false, will return empty string if property does not exist
-	const std::wstring version_info_viewer::get_property(const std::wstring& property_name, const std::wstring& translation, bool throw_if_absent) const
+	std::wstring version_info_viewer::get_property(const std::wstring& property_name, const std::wstring& translation, bool throw_if_absent) const
 	{
 		std::wstring ret;
 
@@ -143,7 +143,7 @@ namespace pe_bliss
 	}
 
 	//Converts translation HEX-string to pair of language ID and codepage ID
-	const version_info_viewer::translation_pair version_info_viewer::translation_from_string(const std::wstring& translation)
+	version_info_viewer::translation_pair version_info_viewer::translation_from_string(const std::wstring& translation)
 	{
 		uint32_t translation_id = 0;
 